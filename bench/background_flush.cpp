@@ -0,0 +1,43 @@
+#include "common.hpp"
+
+#include <cstdlib>
+
+/**
+ * Insert into a HeapFile much larger than the buffer pool, with and without the background flusher, and report the
+ * insert throughput and how many misses had to write a dirty victim themselves.
+ *
+ * Usage: background_flush [num_tuples] [pool_pages]
+ */
+int main(int argc, char *argv[]) {
+  size_t num_tuples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 400000;
+  size_t pool_pages = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 256;
+
+  db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+  bufferPool.resize(pool_pages);
+  std::printf("pool: %zu pages, %zu tuples per run\n", pool_pages, num_tuples);
+  std::printf("%10s %12s %14s %16s %14s\n", "flusher", "ms", "Ktuples/s", "dirty evictions", "pages written");
+  for (double clean_ratio : {-1.0, 0.1, 0.25, 0.5}) {
+    const std::string name = "bench_background_flush.db";
+    std::remove(name.c_str());
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name, bench::defaultTupleDesc()));
+    db::DbFile &file = db::getDatabase().get(name);
+    if (clean_ratio >= 0) {
+      bufferPool.startFlusher({clean_ratio, 256, std::chrono::milliseconds(1)});
+    }
+    bufferPool.resetStats();
+    double ms = bench::timeMs([&] {
+      for (size_t i = 0; i < num_tuples; i++) {
+        file.insertTuple({{static_cast<int>(i), "benchmark", static_cast<double>(i)}});
+      }
+    });
+    bufferPool.stopFlusher();
+    size_t dirty_evictions = bufferPool.getDirtyEvictions();
+    size_t written = file.getMetrics().pages_written;
+
+    char label[16];
+    std::snprintf(label, sizeof(label), clean_ratio < 0 ? "off" : "%.0f%%", 100 * clean_ratio);
+    std::printf("%10s %12.2f %14.2f %16zu %14zu\n", label, ms, num_tuples / ms, dirty_evictions, written);
+    bench::dropFile(name);
+  }
+  return 0;
+}
@@ -0,0 +1,46 @@
+#include "common.hpp"
+
+#include <cstdlib>
+
+/**
+ * Scan a HeapFile repeatedly with different buffer pool sizes and report the hit rate and scan time.
+ *
+ * Usage: bufferpool_size [num_tuples] [passes]
+ */
+int main(int argc, char *argv[]) {
+  size_t num_tuples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+  size_t passes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 3;
+
+  const std::string name = "bench_bufferpool_size.db";
+  db::configureDatabase({16, false});
+  db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+  db::DbFile &file = bench::makeHeapFile(name, num_tuples);
+  std::printf("file: %zu tuples, %zu pages, %zu passes\n", num_tuples, file.getNumPages(), passes);
+  std::printf("%10s %6s %10s %12s %12s %10s\n", "pool", "huge", "hugetlb", "hit rate", "misses", "ms/pass");
+
+  for (size_t num_pages : {16, 64, 256, 1024, 4096, 16384}) {
+    for (bool huge_pages : {false, true}) {
+      bufferPool.resize(num_pages, huge_pages);
+      bufferPool.resetStats();
+      size_t count = 0;
+      double ms = bench::timeMs([&] {
+        for (size_t pass = 0; pass < passes; pass++) {
+          for (auto it = file.begin(); it != file.end(); ++it) {
+            count++;
+          }
+        }
+      });
+      size_t hits = bufferPool.getHits();
+      size_t misses = bufferPool.getMisses();
+      std::printf("%10zu %6s %10s %11.2f%% %12zu %10.2f\n", num_pages, huge_pages ? "yes" : "no",
+                  bufferPool.usesHugeTlb() ? "yes" : "no", 100.0 * hits / (hits + misses), misses, ms / passes);
+      if (count != num_tuples * passes) {
+        std::fprintf(stderr, "unexpected tuple count %zu\n", count);
+        return 1;
+      }
+    }
+  }
+
+  bench::dropFile(name);
+  return 0;
+}
@@ -0,0 +1,46 @@
+#include "common.hpp"
+
+#include <cstdlib>
+#include <vector>
+
+/**
+ * Load the same tuples into a fresh HeapFile with one HeapFile::insertTuple call per tuple and with a single
+ * HeapFile::bulkInsert, flushing the file at the end, and report the load rate of both.
+ *
+ * Usage: bulk_load [num_tuples] [pool_pages]
+ */
+int main(int argc, char *argv[]) {
+  size_t num_tuples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+  size_t pool_pages = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1024;
+
+  db::getDatabase().getBufferPool().resize(pool_pages);
+  std::vector<db::Tuple> tuples;
+  tuples.reserve(num_tuples);
+  for (size_t i = 0; i < num_tuples; i++) {
+    tuples.push_back({{static_cast<int>(i), "benchmark", static_cast<double>(i)}});
+  }
+
+  const std::string name = "bench_bulk_load.db";
+  std::printf("pool: %zu pages, %zu tuples\n", pool_pages, num_tuples);
+  std::printf("%10s %12s %12s %8s %12s\n", "path", "ms", "Ktuples/s", "pages", "pool misses");
+  for (bool bulk : {false, true}) {
+    std::remove(name.c_str());
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name, bench::defaultTupleDesc()));
+    auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+    db::getDatabase().getBufferPool().resetStats();
+    double ms = bench::timeMs([&] {
+      if (bulk) {
+        file.bulkInsert(tuples);
+      } else {
+        for (const auto &tuple : tuples) {
+          file.insertTuple(tuple);
+        }
+      }
+      db::getDatabase().getBufferPool().flushFile(name, true);
+    });
+    std::printf("%10s %12.2f %12.2f %8zu %12zu\n", bulk ? "bulk" : "per-tuple", ms, num_tuples / ms,
+                file.getNumPages(), db::getDatabase().getBufferPool().getMisses());
+    bench::dropFile(name);
+  }
+  return 0;
+}
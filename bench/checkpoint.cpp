@@ -0,0 +1,65 @@
+#include "common.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <tuple>
+#include <vector>
+
+/**
+ * Fill the buffer pool with dirty pages of one file and time a checkpoint: flushing every page on its own in an
+ * arbitrary order (what flushFile used to do) against the sorted, vectored bulk flush, with and without fdatasync.
+ *
+ * Usage: checkpoint [pool_pages] [rounds]
+ */
+int main(int argc, char *argv[]) {
+  size_t pool_pages = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16384;
+  size_t rounds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 3;
+
+  const std::string name = "bench_checkpoint.db";
+  std::remove(name.c_str());
+  db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+  bufferPool.resize(pool_pages);
+  db::getDatabase().add(std::make_unique<db::DbFile>(name, bench::defaultTupleDesc()));
+  db::DbFile &file = db::getDatabase().get(name);
+  std::vector<size_t> order(pool_pages);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), std::mt19937(660));
+
+  std::printf("pool: %zu dirty pages (%.1f MB), best of %zu rounds\n", pool_pages,
+              pool_pages * db::DEFAULT_PAGE_SIZE / 1e6, rounds);
+  std::printf("%20s %12s %10s %14s\n", "mode", "ms", "MB/s", "write calls");
+  for (auto [bulk, sync, label] : {std::tuple{false, false, "per page"}, std::tuple{false, true, "per page + sync"},
+                                   std::tuple{true, false, "bulk"}, std::tuple{true, true, "bulk + sync"}}) {
+    double best = 0;
+    size_t calls = 0;
+    for (size_t round = 0; round < rounds; round++) {
+      for (size_t page = 0; page < pool_pages; page++) {
+        bufferPool.getPage({name, page})[0] = static_cast<uint8_t>(round);
+        bufferPool.markDirty({name, page});
+      }
+      file.resetMetrics();
+      double ms = bench::timeMs([&] {
+        if (bulk) {
+          bufferPool.flushFile(name, sync);
+          return;
+        }
+        for (size_t page : order) {
+          bufferPool.flushPage({name, page});
+        }
+        if (sync) {
+          file.sync();
+        }
+      });
+      if (round == 0 || ms < best) {
+        best = ms;
+      }
+      calls = file.getMetrics().write_latency.count();
+    }
+    std::printf("%20s %12.2f %10.2f %14zu\n", label, best, pool_pages * db::DEFAULT_PAGE_SIZE / best / 1e3, calls);
+  }
+
+  bench::dropFile(name);
+  return 0;
+}
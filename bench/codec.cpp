@@ -0,0 +1,78 @@
+#include "common.hpp"
+
+#include <cstdlib>
+#include <db/Schema.hpp>
+#include <vector>
+
+/**
+ * Serialize and deserialize the tuples into a buffer of records, and return the best time per tuple of each, in
+ * nanoseconds.
+ */
+template <typename Serialize, typename Deserialize>
+static std::pair<double, double> run(const std::vector<db::Tuple> &tuples, size_t width, size_t repeat,
+                                     Serialize &&serialize, Deserialize &&deserialize) {
+  std::vector<uint8_t> buffer(tuples.size() * width);
+  double best_serialize = 1e18;
+  double best_deserialize = 1e18;
+  for (size_t r = 0; r < repeat; r++) {
+    double ms = bench::timeMs([&] {
+      for (size_t i = 0; i < tuples.size(); i++) {
+        serialize(buffer.data() + i * width, tuples[i]);
+      }
+    });
+    best_serialize = std::min(best_serialize, ms * 1e6 / tuples.size());
+    size_t check = 0;
+    ms = bench::timeMs([&] {
+      for (size_t i = 0; i < tuples.size(); i++) {
+        check += std::get<int>(deserialize(buffer.data() + i * width).get_field(0));
+      }
+    });
+    best_deserialize = std::min(best_deserialize, ms * 1e6 / tuples.size());
+    if (check != tuples.size() * (tuples.size() - 1) / 2) {
+      std::printf("deserialized the wrong tuples\n");
+      std::exit(1);
+    }
+  }
+  return {best_serialize, best_deserialize};
+}
+
+/**
+ * Serialize and deserialize tuples through a TupleDesc, which switches on the type of each field to its codec, and
+ * through the Schema of the same types, which is resolved at compile time, for the test schema, a narrow schema and
+ * a schema with a VARCHAR.
+ *
+ * Usage: codec [num_tuples] [repeat]
+ */
+int main(int argc, char *argv[]) {
+  size_t num_tuples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+  size_t repeat = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+
+  using Item = db::Schema<db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE>;
+  using Narrow = db::Schema<db::type_t::INT, db::type_t::INT, db::type_t::DOUBLE, db::type_t::INT>;
+  using Named = db::Schema<db::type_t::INT, db::type_t::VARCHAR, db::type_t::DOUBLE>;
+
+  std::printf("%zu tuples, best of %zu runs, ns per tuple\n", num_tuples, repeat);
+  std::printf("%10s %10s %12s %14s\n", "schema", "codec", "serialize", "deserialize");
+  auto report = [&](const char *schema, auto schema_type, const std::vector<std::string> &names, auto make) {
+    using S = decltype(schema_type);
+    db::TupleDesc td = S::desc(names);
+    std::vector<db::Tuple> tuples;
+    size_t width = 0;
+    for (size_t i = 0; i < num_tuples; i++) {
+      tuples.push_back(make(static_cast<int>(i)));
+      width = std::max(width, td.length(tuples.back()));
+    }
+    auto [s1, d1] = run(
+        tuples, width, repeat, [&](uint8_t *data, const db::Tuple &t) { td.serialize(data, t); },
+        [&](const uint8_t *data) { return td.deserialize(data); });
+    std::printf("%10s %10s %12.1f %14.1f\n", schema, "TupleDesc", s1, d1);
+    auto [s2, d2] = run(
+        tuples, width, repeat, [](uint8_t *data, const db::Tuple &t) { S::serialize(data, t); },
+        [](const uint8_t *data) { return S::deserialize(data); });
+    std::printf("%10s %10s %12.1f %14.1f\n", schema, "Schema", s2, d2);
+  };
+  report("item", Item{}, {"id", "name", "price"}, [](int i) { return db::Tuple({i, "benchmark", 1.0 * i}); });
+  report("narrow", Narrow{}, {"a", "b", "c", "d"}, [](int i) { return db::Tuple({i, i, 1.0 * i, i}); });
+  report("named", Named{}, {"id", "name", "price"}, [](int i) { return db::Tuple({i, "benchmark", 1.0 * i}); });
+  return 0;
+}
@@ -0,0 +1,110 @@
+#include "common.hpp"
+
+#include <cstdlib>
+#include <db/ColumnFile.hpp>
+#include <db/Query.hpp>
+
+/**
+ * A query over the input file, which writes its result to the output file.
+ */
+struct Query {
+  const char *name;
+  db::TupleDesc out_td;
+  std::function<void(const db::DbFile &, db::DbFile &)> run;
+};
+
+/**
+ * Store a wide table of ten fields in a HeapFile and in a ColumnFile, and run queries that use a few of its fields:
+ * a projection of two fields, a filter that keeps 1% of the tuples, a filter on a range of 0.1% of the ids, and a sum
+ * grouped by a field stored with RUN_LENGTH. Each query starts with the input out of the buffer pool; report the pages
+ * it reads from the input, the tuples of its result and the best time of the runs.
+ *
+ * Usage: column_store [num_tuples] [repeat]
+ */
+int main(int argc, char *argv[]) {
+  size_t num_tuples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+  size_t repeat = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 3;
+
+  db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+  db::TupleDesc td({db::type_t::INT, db::type_t::INT, db::type_t::INT, db::type_t::DOUBLE, db::type_t::DOUBLE,
+                    db::type_t::CHAR, db::type_t::CHAR, db::type_t::CHAR, db::type_t::CHAR, db::type_t::VARCHAR},
+                   {"id", "customer", "quantity", "price", "discount", "status", "name", "address", "city", "comment"});
+  std::vector<db::ColumnEncoding> encodings(td.size(), db::ColumnEncoding::PLAIN);
+  encodings[td.index_of("status")] = db::ColumnEncoding::RUN_LENGTH;
+  const char *statuses[] = {"delivered", "shipped", "pending"};
+
+  std::vector<db::Tuple> tuples;
+  for (size_t i = 0; i < num_tuples; i++) {
+    int customer = static_cast<int>(i * 7919 % 10000);
+    tuples.push_back({{static_cast<int>(i), customer, static_cast<int>(i % 100), 1.0 * i, 0.05,
+                       statuses[i * 3 / num_tuples], "customer " + std::to_string(customer), "address",
+                       "city " + std::to_string(customer % 50), std::string(20 + i % 40, 'c')}});
+  }
+  const std::string heap_name = "bench_column_heap.db";
+  const std::string column_name = "bench_column_store.db";
+  for (const std::string &name : {heap_name, column_name}) {
+    std::remove(name.c_str());
+    std::remove((name + ".fsm").c_str());
+  }
+  db::getDatabase().add(std::make_unique<db::HeapFile>(heap_name, td));
+  dynamic_cast<db::HeapFile &>(db::getDatabase().get(heap_name)).bulkInsert(tuples);
+  db::getDatabase().add(std::make_unique<db::ColumnFile>(column_name, td, encodings));
+  db::DbFile &columns = db::getDatabase().get(column_name);
+  double load_ms = bench::timeMs([&] {
+    for (const db::Tuple &t : tuples) {
+      columns.insertTuple(t);
+    }
+  });
+  tuples.clear();
+
+  const int ids = static_cast<int>(num_tuples / 1000);
+  std::vector<Query> queries{
+      {"projection", {{db::type_t::INT, db::type_t::DOUBLE}, {"id", "price"}},
+       [](const db::DbFile &in, db::DbFile &out) { db::projection(in, out, {"id", "price"}); }},
+      {"filter 1%", td,
+       [](const db::DbFile &in, db::DbFile &out) {
+         db::filter(in, out, {{"quantity", db::PredicateOp::LT, 1}});
+       }},
+      {"filter ids", td,
+       [ids](const db::DbFile &in, db::DbFile &out) { db::filter(in, out, {{"id", db::PredicateOp::LT, ids}}); }},
+      {"aggregate", {{db::type_t::CHAR, db::type_t::INT}, {"status", "total"}},
+       [](const db::DbFile &in, db::DbFile &out) {
+         db::aggregate(in, out, {"status", db::AggregateOp::SUM, "quantity"});
+       }},
+  };
+
+  std::printf("%zu tuples of %zu fields; column file loaded in %.0f ms\n", num_tuples, td.size(), load_ms);
+  std::printf("%8s %8s\n", "file", "pages");
+  for (const std::string &name : {heap_name, column_name}) {
+    std::printf("%8s %8zu\n", name == heap_name ? "heap" : "column", db::getDatabase().get(name).getNumPages());
+  }
+  std::printf("%12s %8s %10s %10s %10s\n", "query", "file", "pages read", "tuples", "ms");
+  for (const Query &query : queries) {
+    for (const std::string &name : {heap_name, column_name}) {
+      db::DbFile &in = db::getDatabase().get(name);
+      double best = 1e18;
+      size_t pages_read = 0;
+      size_t results = 0;
+      for (size_t run = 0; run < repeat; run++) {
+        const std::string out_name = "bench_column_out.db";
+        std::remove(out_name.c_str());
+        db::getDatabase().add(std::make_unique<db::HeapFile>(out_name, query.out_td));
+        db::DbFile &out = db::getDatabase().get(out_name);
+        bufferPool.flushFile(name);
+        bufferPool.discardFile(name);
+        in.resetMetrics();
+        best = std::min(best, bench::timeMs([&] { query.run(in, out); }));
+        pages_read = in.getMetrics().pages_read;
+        results = 0;
+        out.scan([&](const db::TupleView &) { results++; });
+        bench::dropFile(out_name);
+      }
+      std::printf("%12s %8s %10zu %10zu %10.2f\n", query.name, name == heap_name ? "heap" : "column", pages_read,
+                  results, best);
+    }
+  }
+
+  bench::dropFile(heap_name);
+  bench::dropFile(column_name);
+  return 0;
+}
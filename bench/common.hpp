@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <string>
+
+namespace bench {
+
+/**
+ * @brief The schema used by the benchmarks: the same (id, name, price) layout as the tests.
+ */
+inline db::TupleDesc defaultTupleDesc() {
+  return {{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"}};
+}
+
+/**
+ * @brief Create a fresh HeapFile with the given number of tuples and register it in the database.
+ * @return The registered file.
+ */
+inline db::DbFile &makeHeapFile(const std::string &name, size_t num_tuples) {
+  std::remove(name.c_str());
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, defaultTupleDesc()));
+  db::DbFile &file = db::getDatabase().get(name);
+  for (size_t i = 0; i < num_tuples; i++) {
+    file.insertTuple({{static_cast<int>(i), "benchmark", static_cast<double>(i)}});
+  }
+  db::getDatabase().getBufferPool().flushFile(name);
+  return file;
+}
+
+/**
+ * @brief Remove a file from the database and delete it from disk, along with the free-space map of a HeapFile.
+ */
+inline void dropFile(const std::string &name) {
+  db::getDatabase().remove(name);
+  std::remove(name.c_str());
+  std::remove((name + ".fsm").c_str());
+}
+
+/**
+ * @brief Run the function and return the elapsed wall clock time in milliseconds.
+ */
+template <typename F> double timeMs(F &&f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+} // namespace bench
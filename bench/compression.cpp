@@ -0,0 +1,79 @@
+#include "common.hpp"
+
+#include <cstdlib>
+#include <db/BTreeFile.hpp>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Drop a file from the OS page cache, so that the next scan reads it from the device where the file system allows it.
+ */
+static void dropCache(const std::string &name) {
+  int fd = ::open(name.c_str(), O_RDONLY);
+  if (fd != -1) {
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+  }
+}
+
+/**
+ * Scan the file cold, out of the buffer pool and the OS page cache, and return the elapsed time in milliseconds.
+ */
+static double coldScan(db::DbFile &file, size_t num_tuples) {
+  db::getDatabase().getBufferPool().discardFile(file.getName());
+  dropCache(file.getName());
+  size_t count = 0;
+  double ms = bench::timeMs([&] {
+    for (const auto &tuple : file) {
+      count += std::get<int>(tuple.get_field(0)) >= 0;
+    }
+  });
+  if (count != num_tuples) {
+    std::printf("scan returned %zu tuples\n", count);
+    std::exit(1);
+  }
+  return ms;
+}
+
+/**
+ * Store a HeapFile and a BTreeFile of the test schema uncompressed and compressed, and report the size on disk, the
+ * compression ratio and the throughput of cold scans in uncompressed megabytes per second.
+ *
+ * Usage: compression [num_tuples] [pool_pages]
+ */
+int main(int argc, char *argv[]) {
+  size_t num_tuples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+  size_t pool_pages = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1024;
+
+  db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+  bufferPool.resize(pool_pages);
+  const std::string heap_name = "bench_compression_heap.db";
+  bench::makeHeapFile(heap_name, num_tuples);
+  const std::string tree_name = "bench_compression_tree.db";
+  std::remove(tree_name.c_str());
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(tree_name, bench::defaultTupleDesc(), 0));
+  db::DbFile &tree = db::getDatabase().get(tree_name);
+  for (size_t i = 0; i < num_tuples; i++) {
+    tree.insertTuple({{static_cast<int>(i), "benchmark", static_cast<double>(i)}});
+  }
+  bufferPool.flushFile(tree_name);
+
+  std::printf("pool: %zu pages, %zu tuples\n", pool_pages, num_tuples);
+  std::printf("%6s %12s %8s %12s %8s %12s %10s\n", "file", "format", "pages", "disk MB", "ratio", "scan ms", "MB/s");
+  for (const std::string &name : {heap_name, tree_name}) {
+    db::DbFile &file = db::getDatabase().get(name);
+    for (bool compressed : {false, true}) {
+      file.setCompression(compressed);
+      size_t pages = file.getNumPages();
+      double ms = coldScan(file, num_tuples);
+      std::printf("%6s %12s %8zu %12.2f %8.2f %12.2f %10.2f\n", name == heap_name ? "heap" : "btree",
+                  compressed ? "compressed" : "plain", pages, file.getStoredSize() / 1e6,
+                  static_cast<double>(pages * db::DEFAULT_PAGE_SIZE) / file.getStoredSize(), ms,
+                  pages * db::DEFAULT_PAGE_SIZE / ms / 1e3);
+    }
+  }
+
+  bench::dropFile(heap_name);
+  bench::dropFile(tree_name);
+  return 0;
+}
@@ -0,0 +1,63 @@
+#include "common.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+/**
+ * Scan a HeapFile from several threads at once and report the aggregate throughput for different numbers of buffer
+ * pool shards. Every thread scans the whole file, so perfect scaling keeps ms/scan constant as threads are added.
+ *
+ * Usage: concurrent_scan [num_tuples] [pool_pages] [scans_per_thread]
+ */
+int main(int argc, char *argv[]) {
+  size_t num_tuples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+  size_t pool_pages = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 8192;
+  size_t scans = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 4;
+
+  const std::string name = "bench_concurrent_scan.db";
+  db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+  bufferPool.resize(pool_pages);
+  db::DbFile &file = bench::makeHeapFile(name, num_tuples);
+
+  size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+  std::printf("file: %zu tuples, %zu pages, pool: %zu pages, %zu scans per thread, %zu hardware threads\n", num_tuples,
+              file.getNumPages(), pool_pages, scans, max_threads);
+  std::printf("%8s %8s %12s %14s %12s\n", "shards", "threads", "ms", "Mtuples/s", "hit rate");
+  for (size_t num_shards : {1, 4, 16, 64}) {
+    bufferPool.setNumShards(num_shards);
+    for (size_t num_threads = 1; num_threads <= 2 * max_threads; num_threads *= 2) {
+      bufferPool.resetStats();
+      std::atomic<size_t> count = 0;
+      double ms = bench::timeMs([&] {
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < num_threads; t++) {
+          threads.emplace_back([&] {
+            size_t local = 0;
+            for (size_t scan = 0; scan < scans; scan++) {
+              for (auto it = file.begin(); it != file.end(); ++it) {
+                local++;
+              }
+            }
+            count += local;
+          });
+        }
+        for (auto &thread : threads) {
+          thread.join();
+        }
+      });
+      size_t hits = bufferPool.getHits();
+      size_t misses = bufferPool.getMisses();
+      std::printf("%8zu %8zu %12.2f %14.2f %11.2f%%\n", num_shards, num_threads, ms, count / ms / 1e3,
+                  100.0 * hits / (hits + misses));
+      if (count != num_tuples * scans * num_threads) {
+        std::fprintf(stderr, "unexpected tuple count %zu\n", count.load());
+        return 1;
+      }
+    }
+  }
+
+  bench::dropFile(name);
+  return 0;
+}
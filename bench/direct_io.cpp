@@ -0,0 +1,94 @@
+#include "common.hpp"
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <random>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * Return how many bytes of the file the OS page cache holds.
+ */
+static size_t cachedBytes(const std::string &name) {
+  int fd = ::open(name.c_str(), O_RDONLY);
+  off_t size = ::lseek(fd, 0, SEEK_END);
+  void *mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  size_t page_size = ::sysconf(_SC_PAGESIZE);
+  std::vector<unsigned char> resident((size + page_size - 1) / page_size);
+  ::mincore(mapping, size, resident.data());
+  size_t count = 0;
+  for (unsigned char r : resident) {
+    count += r & 1;
+  }
+  ::munmap(mapping, size);
+  ::close(fd);
+  return count * page_size;
+}
+
+/**
+ * Run random page accesses (one in ten a write) against a file several times larger than the buffer pool, so that the
+ * pool keeps evicting and reading pages back, with buffered and with direct I/O. Report the throughput, the read
+ * latency and how much of the file the kernel caches on top of the pool after the run.
+ *
+ * Usage: direct_io [file_pages] [pool_pages] [accesses]
+ */
+int main(int argc, char *argv[]) {
+  size_t file_pages = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 32768;
+  size_t pool_pages = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4096;
+  size_t accesses = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 65536;
+
+  db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+  bufferPool.resize(pool_pages);
+  const std::string name = "bench_direct_io.db";
+  std::remove(name.c_str());
+  db::getDatabase().add(std::make_unique<db::DbFile>(name, bench::defaultTupleDesc()));
+  db::DbFile &file = db::getDatabase().get(name);
+  std::vector<const db::Page *> run(1024);
+  db::Page page{};
+  for (size_t i = 0; i < file_pages; i += run.size()) {
+    std::fill(run.begin(), run.end(), &page);
+    run.resize(std::min(run.size(), file_pages - i));
+    file.writePages(run, i);
+  }
+  file.sync();
+
+  std::printf("file: %zu pages (%.1f MB), pool: %zu pages (%.1f MB), %zu accesses\n", file_pages,
+              file_pages * db::DEFAULT_PAGE_SIZE / 1e6, pool_pages, pool_pages * db::DEFAULT_PAGE_SIZE / 1e6, accesses);
+  std::printf("%10s %12s %12s %12s %12s %14s\n", "mode", "ms", "Kops/s", "p50 us", "p99 us", "kernel MB");
+  for (bool direct : {false, true}) {
+    try {
+      file.setDirectIo(direct);
+    } catch (const std::runtime_error &) {
+      std::printf("%10s %12s\n", "direct", "unsupported");
+      break;
+    }
+    bufferPool.discardFile(name);
+    int fd = ::open(name.c_str(), O_RDONLY);
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+
+    std::mt19937 rng(660);
+    std::uniform_int_distribution<size_t> random_page(0, file_pages - 1);
+    file.resetMetrics();
+    double ms = bench::timeMs([&] {
+      for (size_t i = 0; i < accesses; i++) {
+        bool write = i % 10 == 0;
+        db::PageGuard guard = bufferPool.pinPage({file.getId(), random_page(rng)},
+                                                 write ? db::PageIntent::WRITE : db::PageIntent::READ);
+        if (write) {
+          (*guard)[0]++;
+        }
+      }
+      bufferPool.flushFile(name);
+    });
+    db::IoMetrics metrics = file.getMetrics();
+    std::printf("%10s %12.2f %12.2f %12.1f %12.1f %14.1f\n", direct ? "direct" : "buffered", ms, accesses / ms,
+                metrics.read_latency.percentile(0.5).count() / 1e3,
+                metrics.read_latency.percentile(0.99).count() / 1e3, cachedBytes(name) / 1e6);
+  }
+
+  file.setDirectIo(false);
+  bench::dropFile(name);
+  return 0;
+}
@@ -0,0 +1,67 @@
+#include "common.hpp"
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * Return how many extents the file system uses for the file, or -1 if it cannot tell.
+ */
+static long countExtents(const std::string &name) {
+  int fd = ::open(name.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return -1;
+  }
+  // With no room for extents, FIEMAP only counts them
+  fiemap map{};
+  map.fm_length = FIEMAP_MAX_OFFSET;
+  long count = ::ioctl(fd, FS_IOC_FIEMAP, &map) == -1 ? -1 : static_cast<long>(map.fm_mapped_extents);
+  ::close(fd);
+  return count;
+}
+
+/**
+ * Bulk-insert tuples into two HeapFiles at once through a small buffer pool, so that the new pages of both files are
+ * written back together as they grow, with disk space allocated one page at a time and in extents of several sizes.
+ * Report the insert throughput and how fragmented the files end up on disk.
+ *
+ * Usage: extent_growth [num_tuples] [pool_pages]
+ */
+int main(int argc, char *argv[]) {
+  size_t num_tuples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 400000;
+  size_t pool_pages = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 256;
+
+  db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+  bufferPool.resize(pool_pages);
+  const std::string names[] = {"bench_extent_growth_0.db", "bench_extent_growth_1.db"};
+
+  std::printf("pool: %zu pages, %zu tuples\n", pool_pages, num_tuples);
+  std::printf("%10s %12s %12s %8s %12s %10s\n", "extent KB", "ms", "Ktuples/s", "pages", "alloc MB", "extents");
+  for (size_t extent : {size_t{0}, size_t{64} << 10, size_t{1} << 20, size_t{8} << 20}) {
+    std::vector<db::DbFile *> files;
+    for (const std::string &name : names) {
+      std::remove(name.c_str());
+      db::getDatabase().add(std::make_unique<db::HeapFile>(name, bench::defaultTupleDesc()));
+      files.push_back(&db::getDatabase().get(name));
+      files.back()->setExtentSize(extent);
+    }
+    double ms = bench::timeMs([&] {
+      for (size_t i = 0; i < num_tuples; i++) {
+        files[i % 2]->insertTuple({{static_cast<int>(i), "benchmark", static_cast<double>(i)}});
+      }
+      bufferPool.flushAll(true);
+    });
+    size_t pages = files[0]->getNumPages() + files[1]->getNumPages();
+    size_t allocated = files[0]->getAllocatedSize() + files[1]->getAllocatedSize();
+    std::printf("%10zu %12.2f %12.2f %8zu %12.2f %10ld\n", extent >> 10, ms, num_tuples / ms, pages, allocated / 1e6,
+                countExtents(names[0]) + countExtents(names[1]));
+    for (const std::string &name : names) {
+      bench::dropFile(name);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,59 @@
+#include "common.hpp"
+
+#include <cstdlib>
+#include <random>
+
+/**
+ * Churn a HeapFile: every round deletes a random share of the live tuples and inserts as many new ones, so the number
+ * of live tuples stays the same. Report the size of the file and the time of a full scan after each round, next to the
+ * number of pages the file would have if inserts only ever appended.
+ *
+ * Usage: heap_churn [num_tuples] [rounds] [churn_percent]
+ */
+int main(int argc, char *argv[]) {
+  size_t num_tuples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+  size_t rounds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10;
+  size_t churn = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 25;
+
+  const std::string name = "bench_heap_churn.db";
+  db::DbFile &file = bench::makeHeapFile(name, num_tuples);
+  size_t initial_pages = file.getNumPages();
+
+  std::mt19937 rng(660);
+  std::uniform_int_distribution<size_t> percent(0, 99);
+  std::printf("%zu live tuples, %zu%% churn per round\n", num_tuples, churn);
+  std::printf("%6s %10s %10s %14s %12s\n", "round", "pages", "MB", "append pages", "scan ms");
+  size_t inserted = 0;
+  for (size_t round = 0; round <= rounds; round++) {
+    if (round > 0) {
+      size_t deleted = 0;
+      for (auto it = file.begin(); it != file.end(); file.next(it)) {
+        if (percent(rng) < churn) {
+          file.deleteTuple(it);
+          deleted++;
+        }
+      }
+      for (size_t i = 0; i < deleted; i++) {
+        file.insertTuple({{static_cast<int>(i), "benchmark", static_cast<double>(i)}});
+      }
+      inserted += deleted;
+    }
+    size_t count = 0;
+    double ms = bench::timeMs([&] {
+      for (const auto &tuple : file) {
+        count += std::get<int>(tuple.get_field(0)) >= 0;
+      }
+    });
+    if (count != num_tuples) {
+      std::printf("scan returned %zu tuples\n", count);
+      return 1;
+    }
+    // A file that only appends grows by the pages of every tuple inserted
+    size_t append_pages = initial_pages + (inserted * initial_pages + num_tuples - 1) / num_tuples;
+    std::printf("%6zu %10zu %10.2f %14zu %12.2f\n", round, file.getNumPages(),
+                file.getNumPages() * db::DEFAULT_PAGE_SIZE / 1e6, append_pages, ms);
+  }
+
+  bench::dropFile(name);
+  return 0;
+}
@@ -0,0 +1,91 @@
+#include "common.hpp"
+
+#include <cstdlib>
+#include <db/HeapPage.hpp>
+#include <random>
+
+/**
+ * Time the slot bitmap of a HeapPage for a schema: filling a page one insertTuple at a time, with one wrapper and with a
+ * wrapper per insert (as HeapFile::insertTuple does) that is given the free-slot hint of the previous one or none, and
+ * walking the occupied slots of a half-occupied and of a sparse page with begin/next and with forEach. Report
+ * nanoseconds per page.
+ */
+static void run(const char *label, const db::TupleDesc &td, const db::Tuple &tuple, size_t repeat) {
+  db::Page page{};
+  size_t capacity = db::HeapPage(page, td).end();
+  volatile size_t sink = 0;
+
+  double insert_ms = bench::timeMs([&] {
+    for (size_t r = 0; r < repeat; r++) {
+      page.fill(0);
+      db::HeapPage hp(page, td);
+      while (hp.insertTuple(tuple)) {
+      }
+    }
+  });
+
+  // A wrapper per insert searches the occupied slots again unless it is given the hint of the previous one
+  double rewrap_ms[2];
+  for (bool keep_hint : {true, false}) {
+    rewrap_ms[!keep_hint] = bench::timeMs([&] {
+      for (size_t r = 0; r < repeat; r++) {
+        page.fill(0);
+        size_t hint = 0;
+        while (true) {
+          db::HeapPage hp(page, td, db::PageLayout::ROW, db::DEFAULT_PAGE_SIZE, keep_hint ? hint : 0);
+          if (!hp.insertTuple(tuple)) {
+            break;
+          }
+          hint = hp.freeHint();
+        }
+      }
+    });
+  }
+
+  // Walk pages with half and with one in sixteen of the slots occupied, at random
+  std::printf("%8s %8zu %14.1f %14.1f %14.1f", label, capacity, insert_ms * 1e6 / repeat, rewrap_ms[0] * 1e6 / repeat,
+              rewrap_ms[1] * 1e6 / repeat);
+  for (size_t keep : {8, 1}) {
+    std::mt19937 rng(660);
+    page.fill(0);
+    db::HeapPage hp(page, td);
+    while (hp.insertTuple(tuple)) {
+    }
+    for (size_t slot = 0; slot < capacity; slot++) {
+      if (rng() % 16 >= keep) {
+        hp.deleteTuple(slot);
+      }
+    }
+    double next_ms = bench::timeMs([&] {
+      for (size_t r = 0; r < repeat; r++) {
+        size_t count = 0;
+        for (size_t slot = hp.begin(); slot != hp.end(); hp.next(slot)) {
+          count += slot;
+        }
+        sink = sink + count;
+      }
+    });
+    double for_each_ms = bench::timeMs([&] {
+      for (size_t r = 0; r < repeat; r++) {
+        size_t count = 0;
+        hp.forEach([&](size_t slot) { count += slot; });
+        sink = sink + count;
+      }
+    });
+    std::printf(" %12.1f %12.1f", next_ms * 1e6 / repeat, for_each_ms * 1e6 / repeat);
+  }
+  std::printf("\n");
+}
+
+/**
+ * Usage: heap_page [pages]
+ */
+int main(int argc, char *argv[]) {
+  size_t repeat = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+
+  std::printf("%8s %8s %14s %14s %14s %12s %12s %12s %12s\n", "schema", "slots", "fill ns/page", "rewrap hint",
+              "rewrap no hint", "next 1/2", "forEach 1/2", "next 1/16", "forEach 1/16");
+  run("narrow", db::TupleDesc({db::type_t::INT}, {"id"}), {{1}}, repeat);
+  run("wide", bench::defaultTupleDesc(), {{1, "benchmark", 1.0}}, repeat);
+  return 0;
+}
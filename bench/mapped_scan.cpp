@@ -0,0 +1,63 @@
+#include "common.hpp"
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Drop a file from the OS page cache, so that the next scan reads it from the device where the file system allows it.
+ */
+static void dropCache(const std::string &name) {
+  int fd = ::open(name.c_str(), O_RDONLY);
+  if (fd != -1) {
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+  }
+}
+
+/**
+ * Scan a HeapFile larger than the buffer pool through the pool and through a read-only mapping, cold (dropped from the
+ * OS page cache) and warm, and report the scan throughput and how many pages were copied into the pool.
+ *
+ * Usage: mapped_scan [num_tuples] [pool_pages]
+ */
+int main(int argc, char *argv[]) {
+  size_t num_tuples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 400000;
+  size_t pool_pages = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1024;
+
+  db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+  bufferPool.resize(pool_pages);
+  const std::string name = "bench_mapped_scan.db";
+  db::DbFile &file = bench::makeHeapFile(name, num_tuples);
+  size_t pages = file.getNumPages();
+
+  std::printf("pool: %zu pages, file: %zu pages (%.1f MB)\n", pool_pages, pages, pages * db::DEFAULT_PAGE_SIZE / 1e6);
+  std::printf("%8s %6s %12s %10s %12s\n", "mode", "cache", "ms", "MB/s", "pool misses");
+  for (bool mapped : {false, true}) {
+    if (mapped) {
+      file.map();
+    }
+    for (bool cold : {true, false}) {
+      if (cold) {
+        dropCache(name);
+      }
+      bufferPool.resetStats();
+      size_t count = 0;
+      double ms = bench::timeMs([&] {
+        for (const auto &tuple : file) {
+          count += std::get<int>(tuple.get_field(0)) >= 0;
+        }
+      });
+      if (count != num_tuples) {
+        std::printf("scan returned %zu tuples\n", count);
+        return 1;
+      }
+      std::printf("%8s %6s %12.2f %10.2f %12zu\n", mapped ? "mapped" : "pool", cold ? "cold" : "warm", ms,
+                  pages * db::DEFAULT_PAGE_SIZE / ms / 1e3, bufferPool.getMisses());
+    }
+  }
+  file.unmap();
+
+  bench::dropFile(name);
+  return 0;
+}
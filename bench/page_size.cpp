@@ -0,0 +1,140 @@
+#include "common.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <db/BTreeFile.hpp>
+#include <db/HeapFile.hpp>
+#include <db/IndexPage.hpp>
+#include <db/LeafPage.hpp>
+#include <fcntl.h>
+#include <numeric>
+#include <random>
+#include <unistd.h>
+
+/**
+ * Find the tuple with the key in a BTreeFile by descending from the root. The separator keys are the first keys of
+ * their right subtrees.
+ * @return The number of pages visited.
+ */
+static size_t lookup(const db::BTreeFile &file, int key) {
+  db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+  db::PageId pid{file.getId(), 0};
+  size_t depth = 1;
+  while (true) {
+    db::PageGuard page = bufferPool.pinPage(pid);
+    db::IndexPage node(*page, file.getPageSize());
+    auto slot = std::upper_bound(node.keys, node.keys + node.header->size, key) - node.keys;
+    pid.page = node.children[slot];
+    depth++;
+    if (!node.header->index_children) {
+      break;
+    }
+  }
+  db::PageGuard page = bufferPool.pinPage(pid);
+  db::LeafPage leaf(*page, file.getTupleDesc(), 0, file.getPageSize());
+  size_t low = 0;
+  size_t high = leaf.header->size;
+  while (low < high) {
+    size_t mid = (low + high) / 2;
+    if (std::get<int>(leaf.getTuple(mid).get_field(0)) < key) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  if (low == leaf.header->size || std::get<int>(leaf.getTuple(low).get_field(0)) != key) {
+    std::printf("key %d not found\n", key);
+    std::exit(1);
+  }
+  return depth;
+}
+
+/**
+ * Time the storage layer at one page size: HeapFile inserts and cold scans, BTreeFile inserts (in shuffled key order)
+ * and random point lookups. The buffer pool holds the same number of bytes whatever the page size.
+ * @return false if the scan missed tuples.
+ */
+static bool run(size_t page_size, size_t num_tuples, size_t pool_mb, size_t lookups) {
+  db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+  bufferPool.resize(pool_mb * 1024 * 1024 / page_size);
+  const std::string heap_name = "bench_page_size_heap.db";
+  const std::string tree_name = "bench_page_size_tree.db";
+
+  std::remove(heap_name.c_str());
+  std::remove((heap_name + ".fsm").c_str());
+  db::getDatabase().add(std::make_unique<db::HeapFile>(heap_name, bench::defaultTupleDesc(), db::PageLayout::ROW,
+                                                       page_size));
+  db::DbFile &heap = db::getDatabase().get(heap_name);
+  double heap_insert_ms = bench::timeMs([&] {
+    for (size_t i = 0; i < num_tuples; i++) {
+      heap.insertTuple({{static_cast<int>(i), "benchmark", static_cast<double>(i)}});
+    }
+    bufferPool.flushFile(heap_name);
+  });
+  bufferPool.discardFile(heap_name);
+  int fd = ::open(heap_name.c_str(), O_RDONLY);
+  ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  ::close(fd);
+  heap.resetMetrics();
+  size_t count = 0;
+  double heap_scan_ms = bench::timeMs([&] {
+    for (const auto &tuple : heap) {
+      count += std::get<int>(tuple.get_field(0)) >= 0;
+    }
+  });
+  size_t heap_reads = heap.getMetrics().read_latency.count();
+
+  std::remove(tree_name.c_str());
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(tree_name, bench::defaultTupleDesc(), 0, page_size));
+  auto &tree = dynamic_cast<db::BTreeFile &>(db::getDatabase().get(tree_name));
+  std::vector<int> keys(num_tuples);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(660));
+  double tree_insert_ms = bench::timeMs([&] {
+    for (int key : keys) {
+      tree.insertTuple({{key, "benchmark", 1.0}});
+    }
+    bufferPool.flushFile(tree_name);
+  });
+  std::mt19937 rng(660);
+  std::uniform_int_distribution<int> random_key(0, static_cast<int>(num_tuples) - 1);
+  size_t depth = 0;
+  double lookup_ms = bench::timeMs([&] {
+    for (size_t i = 0; i < lookups; i++) {
+      depth = lookup(tree, random_key(rng));
+    }
+  });
+
+  std::printf("%8zu %12.2f %12.2f %12.2f %12zu %12.2f %12zu %8zu %12.2f\n", page_size, heap_insert_ms, heap_scan_ms,
+              heap.getNumPages() * page_size / heap_scan_ms / 1e3, heap_reads, tree_insert_ms, tree.getNumPages(),
+              depth, lookups / lookup_ms);
+  bench::dropFile(heap_name);
+  bench::dropFile(tree_name);
+  if (count != num_tuples) {
+    std::printf("scan returned %zu tuples\n", count);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Run the storage benchmark at every supported page size, from MIN_PAGE_SIZE to MAX_PAGE_SIZE, each with files created
+ * at that size.
+ *
+ * Usage: page_size [num_tuples] [pool_mb] [lookups]
+ */
+int main(int argc, char *argv[]) {
+  size_t num_tuples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+  size_t pool_mb = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4;
+  size_t lookups = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 100000;
+
+  std::printf("pool: %zu MB, %zu tuples, %zu lookups\n", pool_mb, num_tuples, lookups);
+  std::printf("%8s %12s %12s %12s %12s %12s %12s %8s %12s\n", "page", "heap ins ms", "scan ms", "scan MB/s",
+              "scan reads", "tree ins ms", "tree pages", "height", "Klookups/s");
+  for (size_t page_size = db::MIN_PAGE_SIZE; page_size <= db::MAX_PAGE_SIZE; page_size *= 2) {
+    if (!run(page_size, num_tuples, pool_mb, lookups)) {
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,113 @@
+#include "common.hpp"
+
+#include <array>
+#include <cstdlib>
+#include <db/Query.hpp>
+
+/**
+ * Run a filter that counts the matching tuples, check the count, and return the time per tuple in nanoseconds.
+ */
+template <typename F> static double perRow(size_t num_tuples, size_t expected, F &&filter) {
+  size_t matches = 0;
+  double ms = bench::timeMs([&] { matches = filter(); });
+  if (matches != expected) {
+    std::printf("filter matched %zu tuples instead of %zu\n", matches, expected);
+    std::exit(1);
+  }
+  return ms * 1e6 / num_tuples;
+}
+
+/**
+ * Store a wide table, an INT key followed by four CHAR fields, a DOUBLE and an INT quantity, in a HeapFile of row
+ * pages and in one of PAX pages, both warm in the buffer pool. Filter on the quantity, keeping 1% of the tuples,
+ * through DbFile::scan, through HeapFile::scanPages (reading the column of each PAX page, and each view of a row page),
+ * and through the filter operator. The two files are scanned in turn, so that both see the same state of the caches;
+ * the files and the pool still disturb each other, so a layout can be measured alone in its own process.
+ *
+ * Usage: pax [num_tuples] [repeat] [row|pax]
+ */
+int main(int argc, char *argv[]) {
+  size_t num_tuples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+  size_t repeat = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+
+  db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::CHAR, db::type_t::CHAR, db::type_t::CHAR,
+                    db::type_t::DOUBLE, db::type_t::INT},
+                   {"id", "name", "address", "city", "note", "price", "quantity"});
+  const int limit = 1;
+  const size_t expected = (num_tuples + 99) / 100;
+  std::vector<std::pair<db::PageLayout, std::string>> layouts{{db::PageLayout::ROW, "bench_row.db"},
+                                                               {db::PageLayout::PAX, "bench_pax.db"}};
+  if (argc > 3) {
+    // Keep the layout that is named
+    layouts.erase(layouts.begin() + (std::string(argv[3]) == "row"));
+  }
+
+  std::vector<db::Tuple> tuples;
+  for (size_t i = 0; i < num_tuples; i++) {
+    tuples.push_back({{static_cast<int>(i), "name", "address", "city", "note", 1.0 * i, static_cast<int>(i % 100)}});
+  }
+  // Room for both files and the output of the filter
+  bufferPool.resize(layouts.size() * num_tuples / 14 + 1024);
+  for (const auto &[layout, name] : layouts) {
+    std::remove(name.c_str());
+    std::remove((name + ".fsm").c_str());
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name, td, layout));
+    auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+    file.bulkInsert(tuples);
+    file.scan([](const db::TupleView &) {});
+  }
+
+  std::vector<std::array<double, 3>> best(layouts.size(), {1e18, 1e18, 1e18});
+  for (size_t run = 0; run < repeat; run++) {
+    for (size_t l = 0; l < layouts.size(); l++) {
+      auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(layouts[l].second));
+      best[l][0] = std::min(best[l][0], perRow(num_tuples, expected, [&] {
+        size_t matches = 0;
+        file.scan([&](const db::TupleView &t) { matches += t.get_int(6) < limit; });
+        return matches;
+      }));
+      best[l][1] = std::min(best[l][1], perRow(num_tuples, expected, [&] {
+        size_t matches = 0;
+        file.scanPages([&](const db::HeapPage &page) {
+          if (file.getLayout() == db::PageLayout::ROW) {
+            page.forEach([&](size_t slot) { matches += page.getView(slot).get_int(6) < limit; });
+            return;
+          }
+          std::span<const int> quantities = page.column<int>(6);
+          for (size_t slot = 0; slot < quantities.size(); slot++) {
+            matches += (quantities[slot] < limit) & !page.empty(slot);
+          }
+        });
+        return matches;
+      }));
+    }
+  }
+  // The output files of the filter operator change the state of the pool, so the operator runs after the scans
+  for (size_t run = 0; run < repeat; run++) {
+    for (size_t l = 0; l < layouts.size(); l++) {
+      db::DbFile &file = db::getDatabase().get(layouts[l].second);
+      const std::string out_name = "out_" + layouts[l].second;
+      std::remove(out_name.c_str());
+      db::getDatabase().add(std::make_unique<db::HeapFile>(out_name, td));
+      db::DbFile &out = db::getDatabase().get(out_name);
+      best[l][2] = std::min(best[l][2], perRow(num_tuples, expected, [&] {
+        db::filter(file, out, {{"quantity", db::PredicateOp::LT, limit}});
+        size_t matches = 0;
+        out.scan([&](const db::TupleView &) { matches++; });
+        return matches;
+      }));
+      bench::dropFile(out_name);
+    }
+  }
+
+  std::printf("%zu tuples of %zu bytes, best of %zu runs, ns per tuple\n", num_tuples, td.length(), repeat);
+  std::printf("%6s %8s %12s %12s %12s\n", "layout", "pages", "scan view", "scanPages", "filter op");
+  for (size_t l = 0; l < layouts.size(); l++) {
+    db::DbFile &file = db::getDatabase().get(layouts[l].second);
+    std::printf("%6s %8zu %12.2f %12.2f %12.2f\n", layouts[l].first == db::PageLayout::ROW ? "row" : "pax",
+                file.getNumPages(), best[l][0], best[l][1], best[l][2]);
+    bench::dropFile(layouts[l].second);
+  }
+  return 0;
+}
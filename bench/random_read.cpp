@@ -0,0 +1,83 @@
+#include "common.hpp"
+
+#include <cstdlib>
+#include <db/IoQueue.hpp>
+#include <fcntl.h>
+#include <random>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * Read random pages of a file through an IoQueue at different queue depths, with io_uring and with the thread pool
+ * fallback, and report the throughput and the latency percentiles. The file is dropped from the OS page cache before
+ * every run, so the reads go to the device where the file system allows it.
+ *
+ * Usage: random_read [file_pages] [reads]
+ */
+int main(int argc, char *argv[]) {
+  size_t file_pages = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16384;
+  size_t reads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 8192;
+
+  const std::string name = "bench_random_read.db";
+  std::remove(name.c_str());
+  db::DbFile file(name, bench::defaultTupleDesc());
+  db::Page page;
+  for (size_t i = 0; i < file_pages; i++) {
+    page.fill(static_cast<uint8_t>(i));
+    file.writePage(page, i);
+  }
+  file.sync();
+
+  std::printf("file: %zu pages (%.1f MB), %zu random reads per run\n", file_pages,
+              file_pages * db::DEFAULT_PAGE_SIZE / 1e6, reads);
+  std::printf("%10s %6s %12s %12s %10s %12s %12s\n", "backend", "depth", "ms", "Kreads/s", "MB/s", "p50 us",
+              "p99 us");
+  for (auto backend : {db::IoBackend::URING, db::IoBackend::THREADS}) {
+    for (size_t depth : {1, 2, 4, 8, 16, 32, 64}) {
+      std::unique_ptr<db::IoQueue> queue;
+      try {
+        queue = db::makeIoQueue(depth, backend);
+      } catch (const std::runtime_error &) {
+        std::printf("%10s %6zu %12s\n", "io_uring", depth, "unsupported");
+        break;
+      }
+      int fd = ::open(name.c_str(), O_RDONLY);
+      ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+      ::close(fd);
+
+      std::mt19937 rng(660);
+      std::uniform_int_distribution<size_t> random_page(0, file_pages - 1);
+      std::vector<db::Page> buffers(depth);
+      std::vector<db::IoRequest> requests(depth);
+      std::vector<size_t> free_slots(depth);
+      for (size_t i = 0; i < depth; i++) {
+        free_slots[i] = i;
+      }
+      file.resetMetrics();
+      double ms = bench::timeMs([&] {
+        for (size_t issued = 0, completed = 0; completed < reads;) {
+          // Keep the queue full, then wait for one read and reuse its slot
+          while (issued < reads && !free_slots.empty()) {
+            size_t slot = free_slots.back();
+            free_slots.pop_back();
+            requests[slot] = file.readRequest({&buffers[slot]}, random_page(rng));
+            requests[slot].tag = slot;
+            queue->prepare(requests[slot]);
+            issued++;
+          }
+          db::IoRequest &request = queue->wait();
+          file.complete(request);
+          free_slots.push_back(request.tag);
+          completed++;
+        }
+      });
+      db::IoMetrics metrics = file.getMetrics();
+      std::printf("%10s %6zu %12.2f %12.2f %10.2f %12.1f %12.1f\n", queue->name(), depth, ms, reads / ms,
+                  reads * db::DEFAULT_PAGE_SIZE / ms / 1e3, metrics.read_latency.percentile(0.5).count() / 1e3,
+                  metrics.read_latency.percentile(0.99).count() / 1e3);
+    }
+  }
+
+  std::remove(name.c_str());
+  return 0;
+}
@@ -0,0 +1,84 @@
+#include "common.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <db/BTreeFile.hpp>
+#include <fcntl.h>
+#include <numeric>
+#include <random>
+#include <unistd.h>
+
+/**
+ * Write the file back and drop it from the OS page cache, then register it again so that no frame of the buffer pool
+ * holds any of its pages.
+ */
+template <typename File> static db::DbFile &coldFile(const std::string &name, size_t key_index) {
+  db::getDatabase().remove(name);
+  int fd = ::open(name.c_str(), O_RDONLY);
+  if (fd != -1) {
+    ::fdatasync(fd);
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+  }
+  if constexpr (std::is_same_v<File, db::BTreeFile>) {
+    db::getDatabase().add(std::make_unique<db::BTreeFile>(name, bench::defaultTupleDesc(), key_index));
+  } else {
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name, bench::defaultTupleDesc()));
+  }
+  return db::getDatabase().get(name);
+}
+
+/**
+ * Scan a cold HeapFile and a cold BTreeFile (built from shuffled inserts, so its leaf chain jumps around the file) with
+ * different read-ahead distances and report the scan throughput and how many of the pages were read ahead.
+ *
+ * Usage: readahead_scan [num_tuples] [pool_pages]
+ */
+int main(int argc, char *argv[]) {
+  size_t num_tuples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 400000;
+  size_t pool_pages = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1024;
+
+  db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+  bufferPool.resize(pool_pages);
+  const std::string heap_name = "bench_readahead_heap.db";
+  const std::string tree_name = "bench_readahead_tree.db";
+  bench::makeHeapFile(heap_name, num_tuples);
+  std::remove(tree_name.c_str());
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(tree_name, bench::defaultTupleDesc(), 0));
+  std::vector<int> keys(num_tuples);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(660));
+  for (int key : keys) {
+    db::getDatabase().get(tree_name).insertTuple({{key, "benchmark", 1.0}});
+  }
+  bufferPool.flushFile(tree_name);
+
+  std::printf("pool: %zu pages, %zu tuples per file\n", pool_pages, num_tuples);
+  std::printf("%6s %10s %8s %12s %10s %12s\n", "file", "read-ahead", "pages", "ms", "MB/s", "prefetched");
+  for (bool tree : {false, true}) {
+    const std::string &name = tree ? tree_name : heap_name;
+    for (size_t distance : {0, 8, 32, 128}) {
+      db::DbFile &file = tree ? coldFile<db::BTreeFile>(name, 0) : coldFile<db::HeapFile>(name, 0);
+      bufferPool.setReadAhead(distance);
+      bufferPool.resetStats();
+      size_t count = 0;
+      double ms = bench::timeMs([&] {
+        for (auto it = file.begin(); it != file.end(); ++it) {
+          count++;
+        }
+      });
+      bufferPool.setReadAhead(0);
+      if (count != num_tuples) {
+        std::fprintf(stderr, "unexpected tuple count %zu\n", count);
+        return 1;
+      }
+      size_t pages = file.getNumPages();
+      std::printf("%6s %10zu %8zu %12.2f %10.2f %12zu\n", tree ? "btree" : "heap", distance, pages, ms,
+                  pages * db::DEFAULT_PAGE_SIZE / ms / 1e3, bufferPool.getPrefetches());
+    }
+  }
+
+  bench::dropFile(heap_name);
+  bench::dropFile(tree_name);
+  return 0;
+}
@@ -0,0 +1,70 @@
+#include "common.hpp"
+
+#include <cstdlib>
+#include <random>
+
+/**
+ * Compare the cost of buffer pool hits and misses between the replacement policies.
+ *
+ * Usage: replacement_policy [num_pages] [num_accesses]
+ */
+int main(int argc, char *argv[]) {
+  size_t num_pages = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1024;
+  size_t num_accesses = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10000000;
+
+  const std::string name = "bench_replacement_policy.db";
+  std::remove(name.c_str());
+  db::getDatabase().add(std::make_unique<db::DbFile>(name, db::TupleDesc()));
+  db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+
+  // Page ids are built up front so that the loop measures only the pool
+  std::mt19937 rng(660);
+  std::vector<db::PageId> hot;
+  for (size_t i = 0; i < num_pages; i++) {
+    hot.push_back({name, i});
+  }
+  std::vector<db::PageId> hit_trace;
+  std::vector<db::PageId> miss_trace;
+  std::uniform_int_distribution<size_t> hot_page(0, num_pages - 1);
+  std::uniform_int_distribution<size_t> any_page(0, 4 * num_pages - 1);
+  for (size_t i = 0; i < num_accesses; i++) {
+    hit_trace.push_back(hot[hot_page(rng)]);
+  }
+  for (size_t i = 0; i < num_accesses / 10; i++) {
+    miss_trace.push_back({name, any_page(rng)});
+  }
+
+  std::printf("pool: %zu pages, %zu hits, %zu mixed accesses\n", num_pages, hit_trace.size(), miss_trace.size());
+  std::printf("%8s %12s %14s %12s\n", "policy", "ns/hit", "ns/access", "hit rate");
+  for (auto [type, label] : {std::pair{db::ReplacementPolicyType::LRU, "LRU"},
+                             std::pair{db::ReplacementPolicyType::CLOCK, "CLOCK"}}) {
+    bufferPool.resize(num_pages);
+    bufferPool.setReplacementPolicy(type);
+    for (const db::PageId &pid : hot) {
+      bufferPool.getPage(pid);
+    }
+
+    uint64_t checksum = 0;
+    double hit_ms = bench::timeMs([&] {
+      for (const db::PageId &pid : hit_trace) {
+        checksum += bufferPool.getPage(pid)[0];
+      }
+    });
+
+    bufferPool.resetStats();
+    double mixed_ms = bench::timeMs([&] {
+      for (const db::PageId &pid : miss_trace) {
+        checksum += bufferPool.getPage(pid)[0];
+      }
+    });
+    double hit_rate = 100.0 * bufferPool.getHits() / miss_trace.size();
+    std::printf("%8s %12.2f %14.2f %11.2f%%\n", label, hit_ms * 1e6 / hit_trace.size(),
+                mixed_ms * 1e6 / miss_trace.size(), hit_rate);
+    if (checksum != 0) {
+      std::fprintf(stderr, "unexpected page contents\n");
+    }
+  }
+
+  bench::dropFile(name);
+  return 0;
+}
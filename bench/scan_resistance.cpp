@@ -0,0 +1,108 @@
+#include "common.hpp"
+
+#include <cstdlib>
+#include <db/BTreeFile.hpp>
+#include <db/IndexPage.hpp>
+#include <limits>
+#include <random>
+#include <unordered_set>
+
+/**
+ * Collect the page numbers of the root and internal pages of a B-tree.
+ */
+static std::unordered_set<size_t> indexPages(const std::string &name) {
+  db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+  std::unordered_set<size_t> pages{0};
+  std::vector<size_t> todo{0};
+  while (!todo.empty()) {
+    size_t page = todo.back();
+    todo.pop_back();
+    db::IndexPage node(bufferPool.getPage({name, page}));
+    if (!node.header->index_children) {
+      continue;
+    }
+    for (size_t i = 0; i <= node.header->size; i++) {
+      pages.insert(node.children[i]);
+      todo.push_back(node.children[i]);
+    }
+  }
+  return pages;
+}
+
+/**
+ * Interleave full HeapFile scans with random BTreeFile inserts and count how often the B-tree index pages have to be
+ * read back from disk under each replacement policy, with and without the sequential access hint.
+ *
+ * Usage: scan_resistance [pool_pages] [rounds] [inserts_per_round]
+ */
+int main(int argc, char *argv[]) {
+  size_t pool_pages = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256;
+  size_t rounds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20;
+  size_t inserts = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 200;
+
+  db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+  constexpr size_t tuples_per_page = 53;
+  size_t heap_tuples = 4 * pool_pages * tuples_per_page;
+  size_t tree_tuples = 2 * pool_pages * tuples_per_page;
+
+  std::printf("pool: %zu pages, heap: %zu tuples, tree: %zu tuples, %zu rounds of scan + %zu inserts\n", pool_pages,
+              heap_tuples, tree_tuples, rounds, inserts);
+  std::printf("%8s %6s %14s %14s %14s %12s\n", "policy", "hint", "index misses", "tree misses", "heap misses", "ms");
+  for (auto [type, label] : {std::pair{db::ReplacementPolicyType::LRU, "LRU"},
+                             std::pair{db::ReplacementPolicyType::CLOCK, "CLOCK"},
+                             std::pair{db::ReplacementPolicyType::TWO_Q, "2Q"}}) {
+    for (bool hinted : {false, true}) {
+      // Every run gets its own files
+      const std::string suffix = std::string(label) + (hinted ? "_hinted" : "") + ".db";
+      const std::string heap_name = "bench_scan_resistance_heap_" + suffix;
+      const std::string tree_name = "bench_scan_resistance_tree_" + suffix;
+      bufferPool.resize(pool_pages);
+      bufferPool.setReplacementPolicy(type);
+      db::DbFile &heap = bench::makeHeapFile(heap_name, heap_tuples);
+      std::remove(tree_name.c_str());
+      db::getDatabase().add(std::make_unique<db::BTreeFile>(tree_name, bench::defaultTupleDesc(), 0));
+      db::DbFile &tree = db::getDatabase().get(tree_name);
+      // The misses are classified from the read trace of the tree, so it must not be truncated
+      tree.setTraceLimit(std::numeric_limits<size_t>::max());
+      std::mt19937 rng(660);
+      std::uniform_int_distribution<int> key(0, 1 << 30);
+      for (size_t i = 0; i < tree_tuples; i++) {
+        tree.insertTuple({{key(rng), "benchmark", 1.0}});
+      }
+
+      size_t first_tree_read = tree.getReads().size();
+      size_t heap_reads = heap.getMetrics().pages_read;
+      size_t count = 0;
+      double ms = bench::timeMs([&] {
+        for (size_t round = 0; round < rounds; round++) {
+          if (hinted) {
+            for (auto it = heap.begin(); it != heap.end(); ++it) {
+              count++;
+            }
+          } else {
+            for (size_t page = 0; page < heap.getNumPages(); page++) {
+              count += bufferPool.getPage({heap_name, page})[0];
+            }
+          }
+          for (size_t i = 0; i < inserts; i++) {
+            tree.insertTuple({{key(rng), "benchmark", 1.0}});
+          }
+        }
+      });
+
+      const auto &tree_reads = tree.getReads();
+      size_t tree_misses = tree_reads.size() - first_tree_read;
+      auto index = indexPages(tree_name);
+      size_t index_misses = 0;
+      for (size_t i = first_tree_read; i < first_tree_read + tree_misses; i++) {
+        index_misses += index.contains(tree_reads[i]);
+      }
+      std::printf("%8s %6s %14zu %14zu %14zu %12.2f\n", label, hinted ? "yes" : "no", index_misses, tree_misses,
+                  heap.getMetrics().pages_read - heap_reads, ms);
+
+      bench::dropFile(heap_name);
+      bench::dropFile(tree_name);
+    }
+  }
+  return 0;
+}
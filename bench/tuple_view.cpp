@@ -0,0 +1,103 @@
+#include "common.hpp"
+
+#include <cstdlib>
+#include <db/BTreeFile.hpp>
+#include <db/Query.hpp>
+
+/**
+ * Run a scan of the file that counts the tuples matching a predicate on the id, and return the time per tuple in
+ * nanoseconds.
+ */
+template <typename F> static double perRow(size_t num_tuples, size_t expected, F &&scan) {
+  size_t matches = 0;
+  double ms = bench::timeMs([&] { matches = scan(); });
+  if (matches != expected) {
+    std::printf("scan matched %zu tuples instead of %zu\n", matches, expected);
+    std::exit(1);
+  }
+  return ms * 1e6 / num_tuples;
+}
+
+/**
+ * Scan a HeapFile and a BTreeFile of the test schema, warm in the buffer pool, with a filter on the id that keeps 1%
+ * of the tuples. Compare materializing a Tuple per row through the iterators, reading a TupleView per row through the
+ * iterators, and DbFile::scan, which pins each page once; then the filter operator, which also writes the matches to
+ * a HeapFile, against the same loop over Tuples.
+ *
+ * Usage: tuple_view [num_tuples] [repeat]
+ */
+int main(int argc, char *argv[]) {
+  size_t num_tuples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500000;
+  size_t repeat = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+
+  db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+  bufferPool.resize(32768);
+  const int limit = static_cast<int>(num_tuples / 100);
+  const std::string heap_name = "bench_view_heap.db";
+  bench::makeHeapFile(heap_name, num_tuples);
+  const std::string tree_name = "bench_view_tree.db";
+  std::remove(tree_name.c_str());
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(tree_name, bench::defaultTupleDesc(), 0));
+  db::DbFile &tree = db::getDatabase().get(tree_name);
+  for (size_t i = 0; i < num_tuples; i++) {
+    tree.insertTuple({{static_cast<int>(i), "benchmark", static_cast<double>(i)}});
+  }
+  const std::string out_name = "bench_view_out.db";
+
+  std::printf("%zu tuples, best of %zu runs, ns per tuple\n", num_tuples, repeat);
+  std::printf("%6s %12s %12s %12s %14s %14s\n", "file", "Tuple", "iter view", "scan view", "filter Tuple",
+              "filter view");
+  for (const std::string &name : {heap_name, tree_name}) {
+    db::DbFile &file = db::getDatabase().get(name);
+    double best[5] = {1e18, 1e18, 1e18, 1e18, 1e18};
+    for (size_t run = 0; run < repeat; run++) {
+      best[0] = std::min(best[0], perRow(num_tuples, limit, [&] {
+        size_t matches = 0;
+        for (const db::Tuple &t : file) {
+          matches += std::get<int>(t.get_field(0)) < limit;
+        }
+        return matches;
+      }));
+      best[1] = std::min(best[1], perRow(num_tuples, limit, [&] {
+        size_t matches = 0;
+        db::PageGuard page;
+        for (db::Iterator it = file.begin(); it != file.end(); file.next(it)) {
+          matches += it.view(page).get_int(0) < limit;
+        }
+        return matches;
+      }));
+      best[2] = std::min(best[2], perRow(num_tuples, limit, [&] {
+        size_t matches = 0;
+        file.scan([&](const db::TupleView &t) { matches += t.get_int(0) < limit; });
+        return matches;
+      }));
+      for (bool view : {false, true}) {
+        std::remove(out_name.c_str());
+        db::getDatabase().add(std::make_unique<db::HeapFile>(out_name, bench::defaultTupleDesc()));
+        db::DbFile &out = db::getDatabase().get(out_name);
+        double ns = perRow(num_tuples, limit, [&] {
+          if (view) {
+            db::filter(file, out, {{"id", db::PredicateOp::LT, limit}});
+          } else {
+            for (const db::Tuple &t : file) {
+              if (std::get<int>(t.get_field(0)) < limit) {
+                out.insertTuple(t);
+              }
+            }
+          }
+          size_t matches = 0;
+          out.scan([&](const db::TupleView &) { matches++; });
+          return matches;
+        });
+        best[3 + view] = std::min(best[3 + view], ns);
+        bench::dropFile(out_name);
+      }
+    }
+    std::printf("%6s %12.1f %12.1f %12.1f %14.1f %14.1f\n", name == heap_name ? "heap" : "btree", best[0], best[1],
+                best[2], best[3], best[4]);
+  }
+
+  bench::dropFile(heap_name);
+  bench::dropFile(tree_name);
+  return 0;
+}
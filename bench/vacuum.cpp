@@ -0,0 +1,72 @@
+#include "common.hpp"
+
+#include <cstdlib>
+#include <random>
+
+/**
+ * Scan the file cold, out of the buffer pool, and return the elapsed time in milliseconds.
+ */
+static double scan(db::DbFile &file, size_t num_tuples) {
+  db::getDatabase().getBufferPool().flushFile(file.getName());
+  db::getDatabase().getBufferPool().discardFile(file.getName());
+  size_t count = 0;
+  double ms = bench::timeMs([&] {
+    for (const auto &tuple : file) {
+      count += std::get<int>(tuple.get_field(0)) >= 0;
+    }
+  });
+  if (count != num_tuples) {
+    std::printf("scan returned %zu tuples\n", count);
+    std::exit(1);
+  }
+  return ms;
+}
+
+/**
+ * Delete most tuples of a HeapFile at random, then compact it in steps of a bounded number of pages. Report the size of
+ * the file and the time of a full scan before and after, and the time of the longest step.
+ *
+ * Usage: vacuum [num_tuples] [delete_percent] [step_pages]
+ */
+int main(int argc, char *argv[]) {
+  size_t num_tuples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500000;
+  size_t delete_percent = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 90;
+  size_t step_pages = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 256;
+
+  const std::string name = "bench_vacuum.db";
+  auto &file = dynamic_cast<db::HeapFile &>(bench::makeHeapFile(name, num_tuples));
+  std::mt19937 rng(660);
+  std::uniform_int_distribution<size_t> percent(0, 99);
+  size_t live = num_tuples;
+  for (auto it = file.begin(); it != file.end(); file.next(it)) {
+    if (percent(rng) < delete_percent) {
+      file.deleteTuple(it);
+      live--;
+    }
+  }
+
+  std::printf("%zu tuples, %zu%% deleted, %zu pages per step\n", num_tuples, delete_percent, step_pages);
+  std::printf("%8s %10s %10s %12s\n", "", "pages", "MB", "scan ms");
+  std::printf("%8s %10zu %10.2f %12.2f\n", "before", file.getNumPages(), file.getStoredSize() / 1e6, scan(file, live));
+  size_t steps = 0;
+  size_t reclaimed = 0;
+  double longest = 0;
+  double total = bench::timeMs([&] {
+    while (true) {
+      size_t pages = 0;
+      longest = std::max(longest, bench::timeMs([&] { pages = file.compact(step_pages); }));
+      if (pages == 0) {
+        break;
+      }
+      reclaimed += pages;
+      steps++;
+    }
+    db::getDatabase().getBufferPool().flushFile(name);
+  });
+  std::printf("%8s %10zu %10.2f %12.2f\n", "after", file.getNumPages(), file.getStoredSize() / 1e6, scan(file, live));
+  std::printf("compaction: %zu pages reclaimed in %zu steps, %.2f ms total, longest step %.2f ms\n", reclaimed, steps,
+              total, longest);
+
+  bench::dropFile(name);
+  return 0;
+}
@@ -0,0 +1,94 @@
+#include "common.hpp"
+
+#include <cstdlib>
+#include <db/BTreeFile.hpp>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Drop a file from the OS page cache, so that the next scan reads it from the device where the file system allows it.
+ */
+static void dropCache(const std::string &name) {
+  int fd = ::open(name.c_str(), O_RDONLY);
+  if (fd != -1) {
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+  }
+}
+
+/**
+ * A name of 4 to 20 bytes, 12 on average, like most of the strings of our tables.
+ */
+static std::string label(size_t i) {
+  static const std::string letters = "abcdefghijklmnopqrstuvwxyz";
+  size_t length = 4 + i * 7919 % 17;
+  return letters.substr(i % 6, length);
+}
+
+/**
+ * Scan the file, cold out of the buffer pool and the OS page cache or warm in the pool, and return the elapsed time in
+ * milliseconds.
+ */
+static double scan(db::DbFile &file, size_t num_tuples, bool cold) {
+  if (cold) {
+    db::getDatabase().getBufferPool().discardFile(file.getName());
+    dropCache(file.getName());
+  }
+  size_t bytes = 0;
+  size_t count = 0;
+  double ms = bench::timeMs([&] {
+    for (const auto &tuple : file) {
+      bytes += std::get<std::string>(tuple.get_field(1)).size();
+      count++;
+    }
+  });
+  if (count != num_tuples || bytes == 0) {
+    std::printf("scan returned %zu tuples\n", count);
+    std::exit(1);
+  }
+  return ms;
+}
+
+/**
+ * Store the test schema with its name as a fixed CHAR and as a VARCHAR, in a HeapFile and in a BTreeFile, and report
+ * the size of the files and the throughput of cold and warm scans.
+ *
+ * Usage: varchar [num_tuples] [pool_pages]
+ */
+int main(int argc, char *argv[]) {
+  size_t num_tuples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500000;
+  size_t pool_pages = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 16384;
+
+  db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+  bufferPool.resize(pool_pages);
+  std::printf("pool: %zu pages, %zu tuples\n", pool_pages, num_tuples);
+  std::printf("%6s %8s %8s %10s %12s %12s %12s\n", "file", "name", "pages", "disk MB", "load ms", "cold Kt/s",
+              "warm Kt/s");
+  for (bool tree : {false, true}) {
+    for (db::type_t type : {db::type_t::CHAR, db::type_t::VARCHAR}) {
+      const std::string name = "bench_varchar.db";
+      std::remove(name.c_str());
+      std::remove((name + ".fsm").c_str());
+      db::TupleDesc td({db::type_t::INT, type, db::type_t::DOUBLE}, {"id", "name", "price"});
+      if (tree) {
+        db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+      } else {
+        db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+      }
+      db::DbFile &file = db::getDatabase().get(name);
+      double load = bench::timeMs([&] {
+        for (size_t i = 0; i < num_tuples; i++) {
+          file.insertTuple({{static_cast<int>(i), label(i), static_cast<double>(i)}});
+        }
+        bufferPool.flushFile(name);
+      });
+      double cold = scan(file, num_tuples, true);
+      double warm = scan(file, num_tuples, false);
+      std::printf("%6s %8s %8zu %10.2f %12.2f %12.2f %12.2f\n", tree ? "btree" : "heap",
+                  type == db::type_t::CHAR ? "char" : "varchar", file.getNumPages(), file.getStoredSize() / 1e6, load,
+                  num_tuples / cold, num_tuples / warm);
+      bench::dropFile(name);
+    }
+  }
+  return 0;
+}
@@ -1,12 +1,14 @@
 #pragma once
 
 #include <db/DbFile.hpp>
+#include <mutex>
 
 namespace db {
 
 class BTreeFile : public DbFile {
   static constexpr size_t root_id = 0;
   size_t key_index;
+  std::mutex insert_latch;
 
 public:
 
@@ -14,8 +16,9 @@ public:
    * @brief Initialize a BTreeFile
    *
    * @param key_index the index of the key in the tuple
+   * @param page_size the size of the pages of a new file (see DbFile::DbFile)
    */
-  BTreeFile(const std::string &name, const TupleDesc &td, size_t key_index);
+  BTreeFile(const std::string &name, const TupleDesc &td, size_t key_index, size_t page_size = DEFAULT_PAGE_SIZE);
 
   /**
    * @brief Insert a tuple into the file
@@ -24,6 +27,8 @@ public:
    * until no more split is needed. If the root node is split, create a create two new nodes with the contents of the root
    * and set the root to be the parent of the two new nodes.
    * @param t the tuple to insert
+   * @note Concurrent inserts are serialized, since a split may propagate up to the root.
+   * @throws std::logic_error if the file is mapped read-only.
    */
   void insertTuple(const Tuple &t) override;
 
@@ -37,11 +42,27 @@ public:
    */
   Tuple getTuple(const Iterator &it) const override;
 
+  /**
+   * @brief Get a view of a tuple, which reads its fields from the pinned leaf.
+   * @param it The iterator that identifies the tuple.
+   * @param page The guard that keeps the leaf pinned; it is replaced.
+   */
+  TupleView getView(const Iterator &it, PageGuard &page) const override;
+
+  /**
+   * @brief Call a function with a view of every tuple of the file, in key order.
+   * @details Pin each leaf once, from the leftmost leaf along the chain of next leaves, which are read ahead like in a
+   * scan with iterators.
+   */
+  void scan(const std::function<void(const TupleView &)> &f) const override;
+
   /**
    * @brief Advance the iterator to the next tuple.
    * @details Advance the iterator to the next tuple by moving to the next slot of the page.
    * If the iterator is at the end of the page, move to the next page.
    * @param it The iterator to be advanced.
+   * @note Entering a leaf reports it to BufferPool::readAheadChain, which reads the next leaves ahead of the scan
+   * (unless the file is mapped).
    */
   void next(Iterator &it) const override;
 
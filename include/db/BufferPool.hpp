@@ -1,13 +1,104 @@
 #pragma once
 
+#include <db/FrameArena.hpp>
+#include <db/IoQueue.hpp>
+#include <db/Metrics.hpp>
+#include <db/ReplacementPolicy.hpp>
 #include <db/types.hpp>
-#include <list>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 namespace db {
     constexpr size_t DEFAULT_NUM_PAGES = 50;
+    // The number of requests a BufferPool keeps in flight when it reads or writes many pages at once
+    constexpr size_t IO_QUEUE_DEPTH = 32;
+
+    class BufferPool;
+
+    class DbFile;
+
+    /**
+     * @brief What the holder of a PageGuard intends to do with the page.
+     */
+    enum class PageIntent {
+        READ, WRITE
+    };
+
+    /**
+     * @brief Settings of the background writer of a BufferPool.
+     */
+    struct FlusherConfig {
+        // The share of the frames of every shard that the flusher keeps free or clean
+        double clean_ratio = 0.25;
+        // The maximum number of pages written in one pass
+        size_t max_batch = 256;
+        // How long the flusher sleeps between passes unless a shard runs short of clean frames
+        std::chrono::milliseconds interval{10};
+    };
+
+/**
+ * @brief A handle that keeps a page pinned in the BufferPool for as long as it is alive.
+ * @details A pinned page is never evicted, so the holder can keep using the page while fetching others.
+ * A guard acquired with PageIntent::WRITE (or upgraded with PageGuard::markDirty) marks the page dirty when it is
+ * released.
+ * @note A PageGuard must not outlive the BufferPool that created it.
+ */
+    class PageGuard {
+        BufferPool *pool = nullptr;
+        size_t shard = 0;
+        size_t pos = 0;
+        Page *page = nullptr;
+        bool dirty = false;
+
+        friend class BufferPool;
+
+        // Mapped files hand out guards that do not belong to a pool
+        friend class DbFile;
+
+        PageGuard(BufferPool *pool, size_t shard, size_t pos, Page *page, bool dirty);
+
+    public:
+        PageGuard() = default;
+
+        /**
+         * @brief: Unpins the page.
+         */
+        ~PageGuard();
+
+        PageGuard(const PageGuard &) = delete;
+
+        PageGuard &operator=(const PageGuard &) = delete;
+
+        PageGuard(PageGuard &&other) noexcept;
+
+        PageGuard &operator=(PageGuard &&other) noexcept;
+
+        Page &operator*() const { return *page; }
+
+        Page *operator->() const { return page; }
+
+        explicit operator bool() const { return page != nullptr; }
+
+        /**
+         * @brief: Marks the page dirty when the guard is released.
+         */
+        void markDirty();
+
+        /**
+         * @brief: Unpins the page before the guard goes out of scope.
+         */
+        void release();
+    };
 
 /**
  * @brief Represents a buffer pool for database pages.
@@ -15,22 +106,199 @@ namespace db {
  * It provides functions to get a page, mark a page as dirty, and check the status of pages.
  * The class also supports flushing pages to disk and discarding pages from the buffer pool.
  * @note A BufferPool owns the Page objects that are stored in it.
+ * @note The number of frames is chosen at construction and can be changed online with BufferPool::resize.
+ * @note The frames are as large as the largest page size of the files added to the Database (DEFAULT_PAGE_SIZE at
+ * first), so a pool of files with small pages takes no more memory than their pages.
+ * @note The choice of the page to evict is delegated to a ReplacementPolicy (CLOCK by default).
+ * @note Pages pinned through a PageGuard are never evicted.
+ * @note The pool is partitioned into shards by PageId hash. Every shard owns a contiguous range of frames and has its
+ * own latch, page table, replacement policy, free list and dirty set, so threads accessing pages of different shards
+ * do not contend. Pages are read from disk, and dirty victims written back, without holding the latch; a thread that
+ * faults a page that is already being read waits for that read instead of issuing another one.
+ * @note Only BufferPool::pinPage is safe to use from several threads: a page returned by BufferPool::getPage may be
+ * evicted by another thread at any time. The contents of a page are not latched by the pool.
+ * @note BufferPool::resize, BufferPool::setReplacementPolicy, BufferPool::setNumShards, BufferPool::startFlusher,
+ * BufferPool::stopFlusher and BufferPool::setReadAhead must not run concurrently with any other call.
+ * @note An optional background flusher (BufferPool::startFlusher) writes dirty pages ahead of eviction, so that a
+ * miss rarely has to write its victim first. While it runs, pages must only be modified through a PageGuard: pinned
+ * pages are never written in the background, but a page modified through BufferPool::getPage may be written while
+ * it changes.
+ * @note With read-ahead enabled (BufferPool::setReadAhead), a background worker reads the next pages of sequential
+ * scans into the pool before they are requested. A scan is recognized from an access with AccessHint::SEQUENTIAL or
+ * from two consecutive pages of a file; files whose pages are not laid out in scan order (such as the leaves of a
+ * B-tree) can describe their chain with BufferPool::readAheadChain. Pages read ahead are evicted before they are
+ * used only if there is no other choice.
+ * @note The pool counts its accesses, evictions and I/O (BufferPool::getMetrics); the same counters are kept per file
+ * (DbFile::getMetrics).
+ * @note Reads and writes of many pages at once (read-ahead, flushes and background write-back) go through an IoQueue
+ * (io_uring where the kernel supports it), with runs of adjacent pages merged into one request and up to
+ * IO_QUEUE_DEPTH requests in flight.
  */
     class BufferPool {
         // TODO pa0: add private members
-        std::array<Page, DEFAULT_NUM_PAGES> pages;
-        std::array<PageId, DEFAULT_NUM_PAGES> pos_to_pid;
-        std::unordered_map<const PageId, size_t> pid_to_pos;
-        std::unordered_set<size_t> dirty;
-        std::vector<size_t> available;
-        std::list<size_t> lru_list;
-        std::unordered_map<size_t, std::list<size_t>::iterator> pos_to_lru;
+        struct Shard {
+            mutable std::mutex latch;
+            // Signalled when a page read or a background write of the shard completes
+            std::condition_variable io_done;
+            // The shard owns the frames [first, first + pos_to_pid.size()) of the arena; positions are shard-local
+            size_t first = 0;
+            std::vector<PageId> pos_to_pid;
+            std::vector<DbFile *> pos_to_file;
+            std::unordered_map<const PageId, size_t> pid_to_pos;
+            std::unordered_set<size_t> dirty;
+            std::vector<size_t> available;
+            std::unique_ptr<ReplacementPolicy> policy;
+            std::vector<uint32_t> pins;
+            std::vector<uint8_t> loading;
+            // Set for pages read ahead that were not requested yet
+            std::vector<uint8_t> prefetched;
+            // The number of pages the flusher is writing; they stay pinned until the write completes
+            size_t writebacks = 0;
+            size_t hits = 0;
+            size_t misses = 0;
+            size_t evictions = 0;
+            size_t dirty_evictions = 0;
+            size_t prefetches = 0;
+
+            Shard(size_t first, size_t num_frames, ReplacementPolicyType policy);
+        };
+
+        FrameArena pages;
+        // Whether the frame arena was requested with huge pages
+        bool huge_pages;
+        std::vector<std::unique_ptr<Shard>> shards;
+        ReplacementPolicyType policy_type;
+        // The reads and writes issued by the pool; the access counters are kept per shard
+        IoCounters io;
+
+        // The background threads hold it shared while they work on the shards, the calls that restructure the
+        // shards hold it exclusively
+        std::shared_mutex restructure_latch;
+
+        std::mutex flusher_latch;
+        std::condition_variable flusher_wake;
+        bool flusher_stop = false;
+        FlusherConfig flusher_config;
+        std::thread flusher;
+
+        // A dirty frame being written back; it stays pinned and counted in the writebacks of its shard until the
+        // write completes
+        struct PendingWrite {
+            DbFile *file;
+            size_t page;
+            size_t shard;
+            size_t pos;
+            const Page *data;
+        };
+
+        // A frame claimed for a page that is being read ahead; it stays pinned and loading until the read completes
+        struct PendingRead {
+            size_t shard;
+            size_t pos;
+            size_t page;
+        };
+
+        // Created on first use; the batches of the flusher, the read-ahead worker and the flush calls take turns
+        std::unique_ptr<IoQueue> io_queue;
+        std::mutex io_queue_latch;
+
+        struct ReadAheadStream {
+            std::mutex latch;
+            file_id_t file = 0;
+            bool chain = false;
+            // Page number streams: the last page accessed and the last page requested
+            size_t last = 0;
+            size_t ahead = 0;
+            // Chain streams: the requested pages the scan has not reached yet in chain order, the last page of the
+            // chain that was requested, and the number of pages requested but not read yet
+            std::deque<size_t> window;
+            size_t tail = 0;
+            size_t pending = 0;
+            // Changes whenever the stream restarts, so that the worker drops the requests of the previous stream
+            size_t generation = 0;
+        };
+
+        struct ReadAheadRequest {
+            DbFile *file;
+            size_t first;
+            size_t count;
+            // Set for chain requests, which continue from the tail of the stream
+            ReadAheadStream *stream = nullptr;
+            size_t generation = 0;
+            std::function<std::optional<size_t>(const Page &)> next{};
+        };
+
+        size_t readahead_pages = 0;
+        // Streams are found by file id; files that collide share a stream and restart each other
+        std::array<ReadAheadStream, 64> streams;
+        std::mutex readahead_latch;
+        std::condition_variable readahead_wake;
+        std::deque<ReadAheadRequest> readahead_queue;
+        // The file of the request the worker is processing
+        const DbFile *readahead_current = nullptr;
+        std::condition_variable readahead_done;
+        bool readahead_stop = false;
+        std::thread readahead_worker;
+
+        friend class PageGuard;
+
+        size_t shardOf(const PageId &pid) const;
+
+        void createShards(size_t num_shards);
+
+        void rebuild(size_t num_pages, bool huge_pages, size_t frame_size);
+
+        std::optional<size_t> fetch(Shard &shard, const PageId &pid, AccessHint hint, bool pin,
+                                    DbFile *prefetch_file = nullptr);
+
+        std::optional<std::pair<size_t, bool>> claim(Shard &shard, std::unique_lock<std::mutex> &lock, const PageId &pid,
+                                                     AccessHint hint, bool pin, DbFile *prefetch_file);
+
+        void loaded(Shard &shard, size_t pos, bool pin, bool success);
+
+        IoQueue &ioQueue();
+
+        void issue(std::vector<IoRequest> &requests, const std::function<void(size_t)> &done);
+
+        void evict(Shard &shard, size_t pos);
+
+        void flush(Shard &shard, size_t pos);
+
+        void unpin(size_t shard, size_t pos, bool dirty);
+
+        size_t dirtyLimit(const Shard &shard) const;
+
+        void runFlusher();
+
+        void writeBack();
+
+        std::vector<std::unique_lock<std::mutex>> lockIdleShards();
+
+        void takeDirty(size_t shard, const std::function<bool(size_t)> &select, std::vector<PendingWrite> &batch);
+
+        void writePending(std::vector<PendingWrite> &batch);
+
+        void readPending(DbFile &file, const std::vector<PendingRead> &batch);
+
+        void detectSequential(const PageId &pid, AccessHint hint);
+
+        void enqueueReadAhead(ReadAheadRequest request);
+
+        void runReadAhead();
+
+        void readAhead(const ReadAheadRequest &request);
 
     public:
         /**
-         * @brief: Constructs a BufferPool object with the default number of pages.
+         * @brief: Constructs a BufferPool object with the specified number of pages.
+         * @param num_pages: The number of frames in the pool.
+         * @param huge_pages: Whether the frame arena should be backed by huge pages.
+         * @param policy: The replacement policy used to select the pages to evict.
+         * @param num_shards: The number of shards the frames are partitioned into.
+         * @throws std::logic_error if num_pages is zero or smaller than num_shards, or if num_shards is zero.
          */
-        explicit BufferPool();
+        explicit BufferPool(size_t num_pages = DEFAULT_NUM_PAGES, bool huge_pages = false,
+                            ReplacementPolicyType policy = ReplacementPolicyType::CLOCK, size_t num_shards = 1);
 
         /**
          * @brief: Destructs a BufferPool object after flushing all dirty pages to disk.
@@ -48,10 +316,32 @@ namespace db {
         /**
          * @brief: Returns the page with the specified page id.
          * @param pid: The page id of the page to return.
+         * @param hint: How the page is being accessed; scans pass AccessHint::SEQUENTIAL.
          * @return: The page with the specified page id.
-         * @note This method should make this page the most recently used page.
+         * @note This method records the access with the replacement policy.
+         * @note The returned page is not pinned: any later call that reads a page may evict it. Callers that keep
+         * using a page while fetching others should use BufferPool::pinPage.
+         * @throws std::runtime_error if the page is not resident and every frame is pinned.
          */
-        Page &getPage(const PageId &pid);
+        Page &getPage(const PageId &pid, AccessHint hint = AccessHint::NORMAL);
+
+        /**
+         * @brief: Returns a guard that keeps the page with the specified page id pinned.
+         * @param pid: The page id of the page to pin.
+         * @param intent: PageIntent::WRITE marks the page dirty when the guard is released.
+         * @param hint: How the page is being accessed.
+         * @return: The guard of the page.
+         * @throws std::runtime_error if the page is not resident and every frame is pinned.
+         */
+        PageGuard pinPage(const PageId &pid, PageIntent intent = PageIntent::READ,
+                          AccessHint hint = AccessHint::NORMAL);
+
+        /**
+         * @brief: Returns whether the page with the specified page id is pinned.
+         * @param pid: The page id of the page to check.
+         * @return: True if at least one PageGuard holds the page, false otherwise.
+         */
+        bool isPinned(const PageId &pid) const;
 
         /**
          * @brief: Marks the page with the specified page id as dirty.
@@ -77,7 +367,8 @@ namespace db {
          * @brief: Discards the page with the specified page id from the buffer pool.
          * @param pid: The page id of the page to discard.
          * @note This method does NOT flush the page to disk.
-         * @note This method also updates the LRU and dirty pages to exclude tracking this page.
+         * @note This method also updates the replacement policy and dirty pages to exclude tracking this page.
+         * @throws std::logic_error if the page is pinned.
          */
         void discardPage(const PageId &pid);
 
@@ -85,14 +376,179 @@ namespace db {
          * @brief: Flushes the page with the specified page id to disk.
          * @param pid: The page id of the page to flush.
          * @note This method should remove the page from dirty pages.
+         * @note Background writes in progress in the shard of the page complete first, so they cannot overwrite the
+         * page on disk with an older version.
          */
         void flushPage(const PageId &pid);
 
         /**
          * @brief: Flushes all dirty pages in the specified file to disk.
+         * @details The pages are written in page order, and runs of adjacent pages are written with a single vectored
+         * write.
+         * @param file: The name of the associated file.
+         * @param sync: Whether to wait until the data of the file is on stable storage (fdatasync).
+         */
+        void flushFile(const std::string &file, bool sync = false);
+
+        /**
+         * @brief: Flushes all dirty pages to disk, in file and page order and with vectored writes like flushFile.
+         * @param sync: Whether to wait until the data of every file written is on stable storage (fdatasync).
+         */
+        void flushAll(bool sync = false);
+
+        /**
+         * @brief: Discards all pages of the specified file from the buffer pool.
          * @param file: The name of the associated file.
-         * @note This method should call BufferPool::flushPage(pid).
+         * @note This method does NOT flush the pages to disk.
+         * @throws std::logic_error if a page of the file is pinned.
+         */
+        void discardFile(const std::string &file);
+
+        /**
+         * @brief: Returns the number of frames in the buffer pool.
+         */
+        size_t size() const;
+
+        /**
+         * @brief: Changes the number of frames in the buffer pool.
+         * @details Resident pages are moved to a newly allocated frame arena. When shrinking, pages selected by the
+         * replacement policy are evicted (and flushed if dirty) until the remaining pages fit.
+         * @param num_pages: The new number of frames.
+         * @param huge_pages: Whether the new frame arena should be backed by huge pages.
+         * @throws std::logic_error if num_pages is zero or smaller than the number of shards.
+         * @note References returned by BufferPool::getPage before the call are invalidated.
+         * @throws std::logic_error if a page is pinned.
+         */
+        void resize(size_t num_pages, bool huge_pages = false);
+
+        /**
+         * @brief: Returns the size of the frames in bytes, the largest page size they can hold.
+         */
+        size_t getFrameSize() const;
+
+        /**
+         * @brief: Makes the frames large enough to hold pages of the specified size.
+         * @details If the frames are smaller, the resident pages are moved to a new frame arena with frames of the page
+         * size, like BufferPool::resize does; otherwise nothing changes.
+         * @param page_size: The page size of a file whose pages go through the pool.
+         * @throws std::logic_error if the frames must grow while a page is pinned.
+         * @note Database::add calls this for every file it adds. References returned by BufferPool::getPage before
+         * the frames grow are invalidated.
+         */
+        void fitPageSize(size_t page_size);
+
+        /**
+         * @brief: Returns the number of shards the frames are partitioned into.
+         */
+        size_t getNumShards() const;
+
+        /**
+         * @brief: Repartitions the frames into the specified number of shards.
+         * @details All dirty pages are flushed and the pool is emptied, since pages generally map to other shards.
+         * @param num_shards: The new number of shards.
+         * @throws std::logic_error if num_shards is zero or larger than the number of frames, or if a page is pinned.
+         */
+        void setNumShards(size_t num_shards);
+
+        /**
+         * @brief: Returns whether the frame arena is backed by explicitly reserved huge pages.
+         */
+        bool usesHugeTlb() const;
+
+        /**
+         * @brief: Replaces the replacement policy.
+         * @details The new policy starts tracking all resident pages; the access history of the old policy is lost.
+         * @param type: The type of the new policy.
+         */
+        void setReplacementPolicy(ReplacementPolicyType type);
+
+        /**
+         * @brief: Returns a snapshot of the accesses, evictions and I/O of the pool since the last reset.
+         * @note The latencies are those of the reads and writes issued by the pool, including the background ones.
+         */
+        IoMetrics getMetrics() const;
+
+        /**
+         * @brief: Returns the number of BufferPool::getPage calls that found the page in the pool.
+         */
+        size_t getHits() const;
+
+        /**
+         * @brief: Returns the number of BufferPool::getPage calls that had to read the page from disk.
+         */
+        size_t getMisses() const;
+
+        /**
+         * @brief: Returns the number of misses that had to write a dirty page before reading the requested one.
+         */
+        size_t getDirtyEvictions() const;
+
+        /**
+         * @brief: Starts the background flusher, or restarts it with a new configuration.
+         * @details The flusher wakes up periodically, and whenever a miss leaves a shard with fewer clean frames than
+         * configured. It copies dirty unpinned pages, sorts them by file and page number, and writes runs of adjacent
+         * pages with a single vectored write.
+         * @param config: The settings of the flusher.
+         * @throws std::logic_error if the clean ratio is not between 0 and 1 or the batch size is zero.
+         */
+        void startFlusher(const FlusherConfig &config = {});
+
+        /**
+         * @brief: Stops the background flusher and waits for its current pass to complete.
+         */
+        void stopFlusher();
+
+        /**
+         * @brief: Returns whether the background flusher is running.
+         */
+        bool isFlusherRunning() const;
+
+        /**
+         * @brief: Sets how many pages are read ahead of sequential scans, and starts or stops the read-ahead worker.
+         * @param num_pages: The number of pages kept requested ahead of a scan; 0 disables read-ahead.
+         * @note A new request is issued whenever the scan gets within half of this distance of the last page
+         * requested, so that the pages arrive before they are needed.
+         */
+        void setReadAhead(size_t num_pages);
+
+        /**
+         * @brief: Returns the number of pages read ahead of sequential scans, 0 if read-ahead is disabled.
+         */
+        size_t getReadAhead() const;
+
+        /**
+         * @brief: Asks the read-ahead worker to read pages into the pool.
+         * @param pid: The page id of the first page.
+         * @param count: The number of consecutive pages to read.
+         * @note Pages past the end of the file are not read. This does nothing if read-ahead is disabled.
+         */
+        void prefetch(const PageId &pid, size_t count = 1);
+
+        /**
+         * @brief: Reports that a scan reached a page of a chain of pages, and keeps the next pages of the chain
+         * requested ahead of it.
+         * @param pid: The page id of the page the scan reached.
+         * @param next: Returns the page number of the page that follows a page in the chain, or nothing at the end.
+         * @note This does nothing if read-ahead is disabled.
+         */
+        void readAheadChain(const PageId &pid, std::function<std::optional<size_t>(const Page &)> next);
+
+        /**
+         * @brief: Drops the pending read-ahead requests of a file and waits for the one in progress.
+         * @param file: The file.
+         * @note Database::remove calls this before it releases the file.
+         */
+        void cancelReadAhead(const DbFile &file);
+
+        /**
+         * @brief: Returns the number of pages read ahead of the scans.
+         */
+        size_t getPrefetches() const;
+
+        /**
+         * @brief: Resets the metrics of the pool.
+         * @note The metrics of the files are reset separately, with DbFile::resetMetrics.
          */
-        void flushFile(const std::string &file);
+        void resetStats();
     };
 } // namespace db
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <db/DbFile.hpp>
+#include <atomic>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+
+namespace db {
+/**
+ * @brief How the values of a column are stored in its pages.
+ * @details PLAIN stores one value per row. RUN_LENGTH stores each run of equal consecutive values once, with the
+ * number of rows it covers, so a column that is sorted or has few distinct values takes few pages.
+ */
+enum class ColumnEncoding { PLAIN, RUN_LENGTH };
+
+/**
+ * @brief A DbFile that stores each field of its tuples in its own sequence of pages, for analytic queries.
+ * @details Tuples are appended in order and numbered by row. Each page holds the values of one column for consecutive
+ * rows, after a header that names the column, its encoding, its first row and its number of rows, so the pages of the
+ * columns are interleaved in the file and the map of each column is rebuilt from the headers when the file is opened.
+ * A scan of a few fields (ColumnFile::scanColumns) only reads the pages of those columns.
+ * @note Values are stored with the FieldCodec of their type; a VARCHAR is stored as its length and its bytes.
+ * @note Tuples are only appended: deleteTuple is not supported, nor is getView, since the fields of a tuple are on
+ * different pages. A scan reassembles the fields it reads into a record, of which it passes a view.
+ * @note The encodings are chosen when the file is created; the file must be opened with the same encodings afterwards.
+ * @note Iterators point to a page of the first column and to a row of that page.
+ * @note Scans and reads can run during inserts: an insert waits for the reads in progress, and a read sees the
+ * tuples inserted before it started.
+ * @note The read-ahead of the BufferPool follows the page numbers of a file, which interleave the columns, so it reads
+ * pages of columns a scan may not use.
+ */
+class ColumnFile : public DbFile {
+  // A page of a column, and the row of its first value
+  struct Segment {
+    size_t page;
+    size_t first_row;
+  };
+
+  // Reads the values of a column at increasing rows, pinning each page it needs until it moves on or is released
+  struct Cursor;
+
+  const std::vector<ColumnEncoding> encodings;
+
+  // Readers hold it shared while they use the map of the columns and read the pages, inserts exclusively
+  mutable std::shared_mutex latch;
+  std::vector<std::vector<Segment>> columns;
+  std::atomic<size_t> numRows = 0;
+  // An empty page, which the first column to need a page takes; a new file starts with one
+  std::optional<size_t> spare;
+  // The buffer a value is encoded into before it is appended; inserts hold the latch exclusively
+  std::vector<uint8_t> encoded;
+
+  // Appends a value to the last page of a column, or to a new page if it does not fit
+  void append(size_t field, const field_t &value);
+
+  // Calls f with the rows of rows in order, or with every row if rows is null, reading the specified fields; the latch
+  // must be held. Only one page is pinned at a time
+  void visit(const std::vector<size_t> &fields, const size_t *rows, size_t count,
+             const std::function<void(const TupleView &)> &f) const;
+
+  // Returns the row of an iterator; the latch must be held
+  size_t rowOf(const Iterator &it) const;
+
+public:
+  /**
+   * @param encodings The encoding of each field; every field is PLAIN if it is empty.
+   * @param page_size The size of the pages of a new file (see DbFile::DbFile).
+   * @throws std::runtime_error if the file cannot be opened, or if a page belongs to no field or uses another encoding
+   * than its field.
+   * @throws std::logic_error if there is not one encoding per field, or if the page size is not valid.
+   */
+  ColumnFile(const std::string &name, const TupleDesc &td, const std::vector<ColumnEncoding> &encodings = {},
+             size_t page_size = DEFAULT_PAGE_SIZE);
+
+  /**
+   * @brief Append a tuple to the file.
+   * @details Append each field to the last page of its column, or start a new page for the column when it does not
+   * fit. With RUN_LENGTH, a value equal to the last one of the column extends its run.
+   * @param t The tuple to be appended.
+   * @throws std::runtime_error if the tuple is not compatible with the TupleDesc, longer than the maxRecordSize of the
+   * page size, or if a field does not fit in a page.
+   * @throws std::logic_error if the file is mapped read-only.
+   * @note Concurrent inserts are serialized.
+   */
+  void insertTuple(const Tuple &t) override;
+
+  /**
+   * @brief Get a tuple from the database file.
+   * @details Read each field from the page of its column that holds the row.
+   * @param it The iterator that identifies the tuple to be read.
+   * @return The tuple read from the pages.
+   */
+  Tuple getTuple(const Iterator &it) const override;
+
+  /**
+   * @brief Call a function with a view of every tuple of the file, in order, reading every column.
+   */
+  void scan(const std::function<void(const TupleView &)> &f) const override;
+
+  /**
+   * @brief Call a function with a view of every tuple of the file, in order, reading only the specified columns.
+   * @details The columns are read a batch of rows at a time, one column after the other, each page pinned with
+   * AccessHint::SEQUENTIAL once per batch. The fields that are read are copied into a record, whose other fields are
+   * zeros and empty strings.
+   */
+  void scanColumns(const std::vector<size_t> &fields, const std::function<void(const TupleView &)> &f) const override;
+
+  /**
+   * @brief Call a function with a view of the tuples at the specified rows, reading only the specified columns.
+   * @details Only the pages of the columns that hold the rows are read, so that the other fields of a few selected
+   * tuples are fetched without a scan of their columns.
+   * @param rows The rows to read, in increasing order, below getNumRows().
+   * @note Rows are numbered from 0 in the order of the scans.
+   */
+  void scanColumns(const std::vector<size_t> &fields, std::span<const size_t> rows,
+                   const std::function<void(const TupleView &)> &f) const override;
+
+  /**
+   * @brief Returns true: the fields of a row are found from the map of their columns.
+   */
+  bool supportsRowFetch() const override;
+
+  /**
+   * @brief Returns the number of tuples in the file.
+   */
+  size_t getNumRows() const;
+
+  /**
+   * @brief Returns the encoding of a field.
+   */
+  ColumnEncoding getEncoding(size_t field) const;
+
+  /**
+   * @brief Returns the number of pages of a column.
+   */
+  size_t getColumnPages(size_t field) const;
+
+  /**
+   * @brief Advance the iterator to the next tuple.
+   * @details The rows of each page of the first column are known from the map of the column, so no page is read.
+   */
+  void next(Iterator &it) const override;
+
+  /**
+   * @brief Get the iterator to the first tuple.
+   */
+  Iterator begin() const override;
+
+  /**
+   * @brief Get the iterator to the end of the file.
+   */
+  Iterator end() const override;
+};
+} // namespace db
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace db {
+/**
+ * @brief Compresses a block with a fast byte-oriented LZ77 scheme.
+ * @details The output is a sequence of literal runs, each followed by a back reference (a 16-bit distance and a
+ * length of at least 4 bytes) into the data already produced; the last run has no back reference. Matches are found
+ * through a hash table of 4-byte prefixes, so long runs such as zero-padded CHAR fields shrink to a few bytes.
+ * @param src: The block to compress, at most 64 KB.
+ * @param size: The size of the block.
+ * @param dst: The buffer that receives the compressed block.
+ * @param capacity: The size of the buffer.
+ * @return: The size of the compressed block, 0 if it does not fit in the buffer.
+ */
+    size_t compress(const uint8_t *src, size_t size, uint8_t *dst, size_t capacity);
+
+/**
+ * @brief Decompresses a block produced by db::compress.
+ * @param src: The compressed block.
+ * @param size: The size of the compressed block.
+ * @param dst: The buffer that receives the block.
+ * @param capacity: The size of the block, which must be filled exactly.
+ * @throws std::runtime_error if the compressed block is corrupt or does not decompress to exactly capacity bytes.
+ */
+    void decompress(const uint8_t *src, size_t size, uint8_t *dst, size_t capacity);
+} // namespace db
@@ -3,6 +3,7 @@
 #include <db/BufferPool.hpp>
 #include <db/DbFile.hpp>
 #include <memory>
+#include <stdexcept>
 
 /**
  * @brief A database is a collection of files and a BufferPool.
@@ -10,15 +11,32 @@
  * It provides functions to add new database files, get the internal id of a file, and retrieve database files.
  * The class also supports removing all files from the catalog.
  * @note A Database owns the DbFile objects that are added to it.
+ * @note Every file gets a numeric id when it is added. Ids are not reused, so a page id of a removed file can never be
+ * mistaken for a page of another file.
  */
 namespace db {
+    /**
+     * @brief How the Database is constructed.
+     */
+    struct DatabaseConfig {
+        // The number of frames of the BufferPool
+        size_t num_pages = DEFAULT_NUM_PAGES;
+        // Whether the frame arena of the BufferPool should be backed by huge pages
+        bool huge_pages = false;
+    };
+
     class Database {
         // TODO pa0: add private members
         std::unordered_map<std::string, std::unique_ptr<DbFile>> files;
+        // Indexed by file id; id 0 is never assigned and removed files leave a null entry
+        std::vector<DbFile *> ids{nullptr};
 
         BufferPool bufferPool;
 
-        Database() = default;
+        /**
+         * @throws std::logic_error if the configuration is not valid for a BufferPool.
+         */
+        explicit Database(const DatabaseConfig &config);
 
     public:
         friend Database &getDatabase();
@@ -41,7 +59,10 @@ namespace db {
          * @brief Adds a new file to the Database.
          * @param file The file to add.
          * @throws std::logic_error if the file name already exists.
-         * @note This method takes ownership of the DbFile.
+         * @throws std::runtime_error if all file ids are used up.
+         * @throws std::logic_error if the pages of the file are larger than the frames of the BufferPool, which must
+         * then grow (BufferPool::fitPageSize), while a page is pinned.
+         * @note This method takes ownership of the DbFile and assigns its id.
          */
         void add(std::unique_ptr<DbFile> file);
 
@@ -51,6 +72,7 @@ namespace db {
          * @return The removed file.
          * @throws std::logic_error if the name does not exist.
          * @note This method should call BufferPool::flushFile(name)
+         * @note This method cancels the read-ahead of the file and discards its pages from the BufferPool.
          * @note This method moves the DbFile ownership to the caller.
          */
         std::unique_ptr<DbFile> remove(const std::string &name);
@@ -62,11 +84,41 @@ namespace db {
          * @throws std::logic_error if the name does not exist.
          */
         DbFile &get(const std::string &name) const;
+
+        /**
+         * @brief Returns the DbFile with the specified id.
+         * @param id The id of the file.
+         * @return The DbFile object.
+         * @throws std::logic_error if the id does not belong to a file in the database.
+         */
+        DbFile &get(file_id_t id) const {
+            if (id >= ids.size() || ids[id] == nullptr) {
+                throw std::logic_error("File does not exist");
+            }
+            return *ids[id];
+        }
+
+        /**
+         * @brief Returns the id of the file with the specified name.
+         * @param name The name of the file.
+         * @return The id of the file.
+         * @throws std::logic_error if the name does not exist.
+         */
+        file_id_t getId(const std::string &name) const;
     };
 
 /**
  * @brief Returns the singleton instance of the Database.
+ * @details The Database is constructed on the first call, with the configuration passed to configureDatabase, if any.
  * @return The Database object.
  */
     Database &getDatabase();
+
+/**
+ * @brief Sets how the singleton Database is constructed, such as the size of its BufferPool.
+ * @param config The configuration of the Database.
+ * @throws std::logic_error if the Database was already constructed by getDatabase.
+ * @note The BufferPool can still be resized online afterwards with BufferPool::resize.
+ */
+    void configureDatabase(const DatabaseConfig &config);
 } // namespace db
@@ -1,39 +1,179 @@
 #pragma once
 
+#include <db/BufferPool.hpp>
+#include <db/IoQueue.hpp>
 #include <db/Iterator.hpp>
+#include <db/Metrics.hpp>
 #include <db/types.hpp>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
 #include <vector>
 
 namespace db {
+    // The number of page ids a DbFile keeps in each of its read and write traces by default
+    constexpr size_t DEFAULT_TRACE_LIMIT = 1 << 16;
+    // The number of pages a mapped file asks the kernel to read ahead of a scan at once
+    constexpr size_t MAPPED_READAHEAD = 64;
+    // The alignment of the buffers, offsets and sizes of direct I/O (the logical block size of common devices)
+    constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+    static_assert(MIN_PAGE_SIZE % DIRECT_IO_ALIGNMENT == 0, "Pages must be whole blocks for direct I/O");
+    // Compressed pages are stored in slots of a multiple of this size, so that a page that grows a little is
+    // rewritten in place
+    constexpr size_t COMPRESSED_SLOT_SIZE = 128;
+    // The number of bytes a DbFile allocates on disk at once as it grows, by default
+    constexpr size_t DEFAULT_EXTENT_SIZE = 1 << 20;
+    static_assert(DEFAULT_EXTENT_SIZE % MAX_PAGE_SIZE == 0, "Extents must be whole pages");
 
 /**
  * @brief Represents a database file.
  * @details It provides functions to read and write pages to the file, as well as to insert and delete tuples.
  * The class also provides functions to iterate over the tuples in the file.
  * @note A `DbFile` object owns the `TupleDesc` object that describes the schema of the tuples in the file.
+ * @note Every file counts its buffer pool accesses and its I/O (DbFile::getMetrics). The page ids it reads and writes
+ * are also traced in order, up to a bounded number of entries (DbFile::setTraceLimit).
+ * @note A file that is only scanned can be mapped read-only (DbFile::map). Its pages are then read straight from the
+ * mapping instead of being copied into BufferPool frames, and it cannot be modified until it is unmapped.
+ * @note A file can bypass the OS page cache with direct I/O (DbFile::setDirectIo), so that the pages cached by the
+ * BufferPool are not also cached by the kernel. Buffers that are not aligned to DIRECT_IO_ALIGNMENT go through an
+ * aligned bounce buffer, except in requests for an IoQueue; BufferPool frames are always aligned.
+ * @note A file can be stored compressed (DbFile::setCompression). Each page is compressed when it is written and
+ * decompressed when it is read, so the BufferPool still holds uncompressed pages. Compressed pages have a variable
+ * size and are located through a map of page offsets, which is rebuilt from the file when it is opened.
+ * @note A file that grows allocates its disk space in extents (DbFile::setExtentSize) with `fallocate`, ahead of the
+ * pages that are written, so that the pages of a file are contiguous on disk. The allocation does not change the size
+ * of the file, from which the number of pages is computed.
+ * @note Tuples can be read in place as TupleViews (DbFile::getView, DbFile::scan), which point into pinned pages, so
+ * that a scan only copies the fields it uses.
+ * @note Each file has its own page size, chosen when it is created and recorded with it, so that files with different
+ * page sizes are used together. Its pages are read into the first DbFile::getPageSize bytes of a Page.
  */
     class DbFile {
+        mutable std::mutex trace_latch;
         mutable std::vector<size_t> reads;
         mutable std::vector<size_t> writes;
+        std::atomic<size_t> trace_limit = DEFAULT_TRACE_LIMIT;
+        mutable IoCounters counters;
 
         // TODO pa1: add private members
         int fd;
+        size_t page_size;
+        // The read-only mapping of the file, and the number of pages it covers
+        bool mapped = false;
+        const uint8_t *mapping = nullptr;
+        size_t mapped_pages = 0;
+        std::atomic<bool> direct = false;
+        // Where each page of a compressed file is stored: the offset of its slot, the size of its data (the page
+        // size if it is stored uncompressed) and the size of the slot; pages never written have an empty slot
+        struct PageSlot {
+            uint64_t offset = 0;
+            uint32_t size = 0;
+            uint32_t capacity = 0;
+        };
+        bool compressed = false;
+        // Readers hold it shared, writers exclusively, so that a page is never read while it is rewritten in place
+        mutable std::shared_mutex slot_latch;
+        mutable std::vector<PageSlot> slots;
+        mutable uint64_t file_end = 0;
+        // The pages of the file that have disk space allocated, which may be more than numPages
+        std::mutex extent_latch;
+        std::atomic<size_t> extent_size = DEFAULT_EXTENT_SIZE;
+        std::atomic<size_t> allocated_pages = 0;
+
+        friend class Database;
+
+        friend class BufferPool;
+
+        void trace(std::vector<size_t> &entries, size_t id, size_t count) const;
+
+        // Rebuilds the slots of a compressed file; returns false if the file is not compressed
+        bool loadSlots(size_t file_size);
+
+        void readCompressed(Page &page, size_t id) const;
+
+        void writeCompressed(const Page &page, size_t id) const;
 
     protected:
+        file_id_t id = 0;
         const std::string name;
         const TupleDesc td;
-        size_t numPages;
+        std::atomic<size_t> numPages;
+
+        /**
+         * @brief Returns a guard on a page that is only read.
+         * @details If the file is mapped, the guard points into the mapping; otherwise it pins the page in the
+         * BufferPool. With AccessHint::SEQUENTIAL, a mapped file asks the kernel to read the next pages ahead.
+         * @param page The page number.
+         * @param hint How the page is being accessed.
+         * @throws std::logic_error if the file is mapped and the page is past its end.
+         */
+        PageGuard readGuard(size_t page, AccessHint hint = AccessHint::NORMAL) const;
+
+        /**
+         * @throws std::logic_error if the file is mapped.
+         */
+        void checkWritable() const;
+
+        /**
+         * @brief Reads an extended attribute of the file, such as one a subclass records about the format of its pages.
+         * @param attribute The name of the attribute, in the `user.db.` namespace.
+         * @return Whether the file has the attribute with a value of the specified size.
+         */
+        bool getAttribute(const char *attribute, void *value, size_t size) const;
+
+        /**
+         * @brief Records an extended attribute of the file. A file system without extended attributes does not keep it.
+         * @note The attributes are kept when the file is converted with DbFile::setCompression.
+         */
+        void setAttribute(const char *attribute, const void *value, size_t size) const;
+
+        /**
+         * @brief Adds a page at the end of the file and returns its page number.
+         * @details When the page is past the allocated space, the next extent is allocated first. A file system that
+         * cannot allocate space ahead leaves the file to grow as its pages are written.
+         * @note Compressed files do not allocate ahead, since their pages are not stored at fixed offsets.
+         */
+        size_t appendPage();
+
+        /**
+         * @brief Allocates the disk space of the pages before the specified page number, an extent at a time, without
+         * adding them to the file.
+         * @details A file that writes new pages before it adds them, so that no reader caches them before they are
+         * written, allocates them with this first.
+         */
+        void reserve(size_t pages);
+
+        /**
+         * @brief Removes the pages from the specified page number on, from the BufferPool and from the file.
+         * @details The pages are written back before they are discarded, so that a background write of them cannot
+         * be in progress, then the file is truncated. A file truncated to no pages keeps one empty page.
+         * @param pages The number of pages to keep.
+         * @throws std::logic_error if the file is mapped or compressed, or if one of the pages is pinned.
+         * @throws std::runtime_error if the `ftruncate` system call fails.
+         */
+        void truncate(size_t pages);
 
     public:
         /**
          * @brief Construct a new Db File object with the specified file name and tuple descriptor
          * @param name of the file to be opened or created.
          * @param td tuple description of tuples in the file.
-         * @throws std::runtime_error if the file cannot be opened or if the `fstat` system call fails.
+         * @param page_size The size of the pages of a new file. A file that is not empty keeps the page size it was
+         * created with.
+         * @throws std::runtime_error if the file cannot be opened, if the `fstat` system call fails, or if the file
+         * was written with a page size larger than MAX_PAGE_SIZE.
+         * @throws std::logic_error if the page size is not a valid page size (validPageSize).
+         * @note A compressed file is recognized by its header, which also records its page size.
+         * @note A file that cannot be opened for writing is opened read-only, so that it can be scanned or mapped;
+         * writing its pages fails.
          * @note This method calculates the number of pages in the file by dividing the file size (in bytes)
-         * by the `DEFAULT_PAGE_SIZE`.
+         * by the page size.
+         * @note The page size of a new file is recorded in an extended attribute. A file without it, such as one on a
+         * file system without extended attributes, is assumed to use the page size it is opened with.
          */
-        explicit DbFile(const std::string &name, const TupleDesc &td);
+        explicit DbFile(const std::string &name, const TupleDesc &td, size_t page_size = DEFAULT_PAGE_SIZE);
 
         /**
          * @brief closes the file descriptor.
@@ -42,14 +182,128 @@ namespace db {
 
         const std::string &getName() const;
 
+        /**
+         * @brief Returns the size of the pages of the file in bytes.
+         */
+        size_t getPageSize() const;
+
+        /**
+         * @brief Maps the file read-only, so that its pages are read without going through the BufferPool.
+         * @details The dirty pages of the file are flushed and all its pages are discarded from the BufferPool first.
+         * @param hint AccessHint::SEQUENTIAL advises the kernel that the file is scanned (`MADV_SEQUENTIAL`).
+         * @throws std::runtime_error if the file cannot be mapped.
+         * @throws std::logic_error if the file is compressed.
+         * @note Must not run concurrently with any other access to the file.
+         */
+        void map(AccessHint hint = AccessHint::SEQUENTIAL);
+
+        /**
+         * @brief Removes the mapping of the file, which is read and written through the BufferPool again.
+         */
+        void unmap();
+
+        /**
+         * @brief Returns whether the file is mapped read-only.
+         */
+        bool isMapped() const;
+
+        /**
+         * @brief Turns direct I/O (`O_DIRECT`) on or off for the file.
+         * @details Turning it on writes back and drops the pages of the file cached by the kernel.
+         * @throws std::runtime_error if the file system does not support direct I/O.
+         * @throws std::logic_error if the file is compressed.
+         * @note Must not run concurrently with any I/O of the file.
+         */
+        void setDirectIo(bool enable);
+
+        /**
+         * @brief Returns whether the file uses direct I/O.
+         */
+        bool isDirectIo() const;
+
+        /**
+         * @brief Converts the file to the compressed format or back.
+         * @details The dirty pages of the file are flushed first, then every page is copied to a temporary file in the
+         * new format, which replaces the file. Pages cached in the BufferPool stay valid.
+         * @throws std::logic_error if the file is mapped or uses direct I/O.
+         * @throws std::runtime_error if the file cannot be converted; the file is then left as it was.
+         * @note Must not run concurrently with any other access to the file.
+         */
+        void setCompression(bool enable);
+
+        /**
+         * @brief Returns whether the file is stored compressed.
+         */
+        bool isCompressed() const;
+
+        /**
+         * @brief Returns the number of bytes the file takes on disk.
+         */
+        size_t getStoredSize() const;
+
+        /**
+         * @brief Sets how much disk space the file allocates at once as it grows.
+         * @param bytes The size of an extent, a whole number of pages; 0 allocates nothing ahead.
+         * @throws std::logic_error if the size is not a whole number of pages.
+         */
+        void setExtentSize(size_t bytes);
+
+        /**
+         * @brief Returns how much disk space the file allocates at once as it grows.
+         */
+        size_t getExtentSize() const;
+
+        /**
+         * @brief Returns the number of bytes of disk space allocated to the file, including the space allocated
+         * ahead of its pages.
+         * @throws std::runtime_error if the `fstat` system call fails.
+         */
+        size_t getAllocatedSize() const;
+
+        /**
+         * @brief Returns the id the Database assigned to the file when it was added, 0 if it was never added.
+         */
+        file_id_t getId() const;
+
+        /**
+         * @brief Returns the page numbers read from the file, in order.
+         * @note Only the first accesses are traced, up to the trace limit.
+         * @note The trace grows with later reads, so it must not be read while other threads do I/O on the file.
+         */
         const std::vector<size_t> &getReads() const;
 
+        /**
+         * @brief Returns the page numbers written to the file, in order.
+         * @note Only the first accesses are traced, up to the trace limit.
+         * @note The trace grows with later writes, so it must not be read while other threads do I/O on the file.
+         */
         const std::vector<size_t> &getWrites() const;
 
+        /**
+         * @brief Sets how many page ids are kept in each of the read and write traces.
+         * @param limit The maximum number of entries per trace; 0 disables tracing.
+         * @note Traces that are longer than the new limit are truncated.
+         */
+        void setTraceLimit(size_t limit);
+
+        /**
+         * @brief Returns a snapshot of the buffer pool accesses and the I/O of the file.
+         */
+        IoMetrics getMetrics() const;
+
+        /**
+         * @brief Resets the metrics and clears the read and write traces.
+         */
+        void resetMetrics();
+
         /**
          * @brief Read a page from the file.
          * @param page The page to read into.
          * @param id The page number of the page to be read. It determines the offset within the file.
+         * @note Pages can be read and written from several threads at once.
+         * @note With direct I/O, a read of the last page of a file whose size is not a whole number of pages is
+         * short; the rest of the page reads as zeros, like a page past the end of the file.
+         * @throws std::runtime_error if the `pread` system call fails, or if a compressed page is corrupt.
          */
         void readPage(Page &page, size_t id) const;
 
@@ -58,15 +312,105 @@ namespace db {
          * @param page The page to write.
          * @param id The page number of the page to which the data will be written.
          * It determines the offset in the file.
+         * @throws std::runtime_error if the page cannot be written entirely.
          */
         void writePage(const Page &page, size_t id) const;
 
+        /**
+         * @brief Write consecutive pages to the file with as few system calls as possible.
+         * @param pages The pages to write.
+         * @param id The page number of the first page; the other pages follow it in the file.
+         * @throws std::runtime_error if the pages cannot be written entirely.
+         */
+        void writePages(const std::vector<const Page *> &pages, size_t id) const;
+
+        /**
+         * @brief Build a request that reads consecutive pages of the file, to be issued through an IoQueue.
+         * @param pages The pages to read into, at most `IOV_MAX`; they are zeroed first.
+         * @param id The page number of the first page.
+         * @throws std::logic_error if there are no pages or too many, if the file uses direct I/O and a page is
+         * not aligned to DIRECT_IO_ALIGNMENT, or if the file is compressed.
+         * @note The completed request must be passed to DbFile::complete.
+         */
+        IoRequest readRequest(const std::vector<Page *> &pages, size_t id) const;
+
+        /**
+         * @brief Build a request that writes consecutive pages of the file, to be issued through an IoQueue.
+         * @param pages The pages to write, at most `IOV_MAX`.
+         * @param id The page number of the first page.
+         * @throws std::logic_error if there are no pages or too many, if the file uses direct I/O and a page is
+         * not aligned to DIRECT_IO_ALIGNMENT, or if the file is compressed.
+         * @note The completed request must be passed to DbFile::complete.
+         */
+        IoRequest writeRequest(const std::vector<const Page *> &pages, size_t id) const;
+
+        /**
+         * @brief Record a completed request of the file in its metrics.
+         * @param request A request built by DbFile::readRequest or DbFile::writeRequest.
+         * @throws std::runtime_error if the request failed or did not write all the pages.
+         */
+        void complete(const IoRequest &request) const;
+
+        /**
+         * @brief Waits until the data written to the file is on stable storage.
+         * @throws std::runtime_error if the `fdatasync` system call fails.
+         */
+        virtual void sync() const;
+
         virtual void insertTuple(const Tuple &t);
 
         virtual void deleteTuple(const Iterator &it);
 
         virtual Tuple getTuple(const Iterator &it) const;
 
+        /**
+         * @brief Get a view of a tuple, which reads its fields from its page.
+         * @param it The iterator that identifies the tuple.
+         * @param page The guard that keeps the page pinned while the view is used; it is replaced.
+         * @return The view, valid as long as the guard is held and the tuple is not changed.
+         */
+        virtual TupleView getView(const Iterator &it, PageGuard &page) const;
+
+        /**
+         * @brief Call a function with a view of every tuple of the file, in order.
+         * @details The default goes from DbFile::begin to DbFile::end with DbFile::getView. Files override it to pin
+         * each page once for all its tuples.
+         * @param f The function to call; a view is only valid during the call.
+         * @note The file must not be modified during the scan.
+         */
+        virtual void scan(const std::function<void(const TupleView &)> &f) const;
+
+        /**
+         * @brief Call a function with a view of every tuple of the file, in order, of which only some fields are used.
+         * @details The default is DbFile::scan. A file that stores each field apart, such as a ColumnFile, reads only
+         * the specified fields; the other fields of its views are zeros and empty strings.
+         * @param fields The indices of the fields the function reads.
+         * @param f The function to call; a view is only valid during the call.
+         * @note The file must not be modified during the scan.
+         */
+        virtual void scanColumns(const std::vector<size_t> &fields,
+                                 const std::function<void(const TupleView &)> &f) const;
+
+        /**
+         * @brief Call a function with a view of the tuples at the specified rows, of which only some fields are used.
+         * @details The default scans the file with DbFile::scanColumns and skips the other rows. A file that fetches
+         * rows without a scan (DbFile::supportsRowFetch) only reads the pages that hold them.
+         * @param fields The indices of the fields the function reads.
+         * @param rows The rows to read, in increasing order; rows are numbered from 0 in the order of the scans.
+         * @param f The function to call; a view is only valid during the call.
+         * @throws std::runtime_error if a row is past the last tuple.
+         * @note The file must not be modified during the scan.
+         */
+        virtual void scanColumns(const std::vector<size_t> &fields, std::span<const size_t> rows,
+                                 const std::function<void(const TupleView &)> &f) const;
+
+        /**
+         * @brief Returns whether the file reads the tuples at given rows without a scan of the file.
+         * @details The default is false. An operator that selects few tuples can then read the fields it tests first,
+         * and fetch the other fields of the selected rows only.
+         */
+        virtual bool supportsRowFetch() const;
+
         virtual void next(Iterator &it) const;
 
         virtual Iterator begin() const;
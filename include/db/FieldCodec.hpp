@@ -0,0 +1,120 @@
+#pragma once
+
+#include <db/types.hpp>
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace db {
+/**
+ * @brief How a field of a type is stored in a record, resolved at compile time.
+ * @details Each specialization has the size of the field in the fixed-size part of the record, and functions that
+ * encode a field_t and read the value in place without copying it. The functions take the start of the record and
+ * the start of the field, since the bytes of a VARCHAR are found from the start of the record.
+ * @note TupleDesc switches on the type of each field to call them, and Schema calls them directly.
+ */
+    template<type_t T>
+    struct FieldCodec;
+
+    template<>
+    struct FieldCodec<type_t::INT> {
+        using field_type = int;
+        static constexpr size_t size = INT_SIZE;
+
+        static int read(const uint8_t *, const uint8_t *field) {
+            int value;
+            std::memcpy(&value, field, sizeof(value));
+            return value;
+        }
+
+        static void encode(uint8_t *, uint8_t *field, const field_t &value, uint16_t &) {
+            int v = std::get<int>(value);
+            std::memcpy(field, &v, sizeof(v));
+        }
+    };
+
+    template<>
+    struct FieldCodec<type_t::DOUBLE> {
+        using field_type = double;
+        static constexpr size_t size = DOUBLE_SIZE;
+
+        static double read(const uint8_t *, const uint8_t *field) {
+            double value;
+            std::memcpy(&value, field, sizeof(value));
+            return value;
+        }
+
+        static void encode(uint8_t *, uint8_t *field, const field_t &value, uint16_t &) {
+            double v = std::get<double>(value);
+            std::memcpy(field, &v, sizeof(v));
+        }
+    };
+
+    template<>
+    struct FieldCodec<type_t::CHAR> {
+        using field_type = std::string;
+        static constexpr size_t size = CHAR_SIZE;
+
+        static std::string_view read(const uint8_t *, const uint8_t *field) {
+            const char *chars = reinterpret_cast<const char *>(field);
+            return {chars, strnlen(chars, CHAR_SIZE)};
+        }
+
+        // Longer strings are cut to CHAR_SIZE bytes, and shorter ones padded with zeros
+        static void encode(uint8_t *, uint8_t *field, const field_t &value, uint16_t &) {
+            const std::string &v = std::get<std::string>(value);
+            size_t length = std::min(v.size(), CHAR_SIZE);
+            std::memcpy(field, v.data(), length);
+            std::memset(field + length, 0, CHAR_SIZE - length);
+        }
+    };
+
+    template<>
+    struct FieldCodec<type_t::VARCHAR> {
+        using field_type = std::string;
+        static constexpr size_t size = VARCHAR_SIZE;
+
+        static std::string_view read(const uint8_t *record, const uint8_t *field) {
+            uint16_t offset, length;
+            std::memcpy(&offset, field, sizeof(offset));
+            std::memcpy(&length, field + sizeof(offset), sizeof(length));
+            return {reinterpret_cast<const char *>(record + offset), length};
+        }
+
+        // The bytes are written at the end of the record, which moves past them
+        static void encode(uint8_t *record, uint8_t *field, const field_t &value, uint16_t &end) {
+            const std::string &v = std::get<std::string>(value);
+            auto length = static_cast<uint16_t>(v.size());
+            std::memcpy(field, &end, sizeof(end));
+            std::memcpy(field + sizeof(end), &length, sizeof(length));
+            std::memcpy(record + end, v.data(), length);
+            end += length;
+        }
+    };
+
+    /**
+     * @brief Get the size of a field of a type in the fixed-size part of a record, FieldCodec<T>::size.
+     */
+    constexpr size_t fieldSize(type_t type) {
+        switch (type) {
+            case type_t::INT:
+                return FieldCodec<type_t::INT>::size;
+            case type_t::DOUBLE:
+                return FieldCodec<type_t::DOUBLE>::size;
+            case type_t::CHAR:
+                return FieldCodec<type_t::CHAR>::size;
+            case type_t::VARCHAR:
+                return FieldCodec<type_t::VARCHAR>::size;
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Decode a field of a record, constructing the field_t in place at the end of the fields.
+     */
+    template<type_t T>
+    void decodeField(std::vector<field_t> &fields, const uint8_t *record, const uint8_t *field) {
+        fields.emplace_back(std::in_place_type<typename FieldCodec<T>::field_type>, FieldCodec<T>::read(record, field));
+    }
+} // namespace db
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <db/types.hpp>
+
+namespace db {
+    constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+/**
+ * @brief A contiguous block of memory that holds the frames of a BufferPool.
+ * @details All frames are carved out of a single anonymous mapping, so a scan over the pool touches as few TLB entries
+ * as possible. When huge pages are requested the arena is first mapped with `MAP_HUGETLB`; if the system has no
+ * reserved huge pages it falls back to a regular mapping advised with `MADV_HUGEPAGE` (transparent huge pages).
+ * @note The frames are page aligned.
+ * @note The frames are as large as the largest page they hold, which can be smaller than a Page: only the first
+ * FrameArena::frameSize bytes of a Page returned by the arena belong to the frame.
+ */
+    class FrameArena {
+        uint8_t *frames = nullptr;
+        size_t num_frames = 0;
+        size_t frame_size = MAX_PAGE_SIZE;
+        size_t bytes = 0;
+        bool hugetlb = false;
+
+    public:
+        FrameArena() = default;
+
+        /**
+         * @brief: Maps an arena with the specified number of zeroed frames.
+         * @param num_frames: The number of frames in the arena.
+         * @param huge_pages: Whether the arena should be backed by huge pages.
+         * @param frame_size: The size of the frames in bytes, a valid page size.
+         * @throws std::runtime_error if the memory cannot be mapped.
+         * @throws std::logic_error if the frame size is not a valid page size.
+         */
+        FrameArena(size_t num_frames, bool huge_pages, size_t frame_size = MAX_PAGE_SIZE);
+
+        /**
+         * @brief: Unmaps the arena.
+         */
+        ~FrameArena();
+
+        FrameArena(const FrameArena &) = delete;
+
+        FrameArena &operator=(const FrameArena &) = delete;
+
+        FrameArena(FrameArena &&other) noexcept;
+
+        FrameArena &operator=(FrameArena &&other) noexcept;
+
+        Page &operator[](size_t pos) const { return *reinterpret_cast<Page *>(frames + pos * frame_size); }
+
+        /**
+         * @brief: Returns the number of frames in the arena.
+         */
+        size_t size() const;
+
+        /**
+         * @brief: Returns the size of the frames in bytes.
+         */
+        size_t frameSize() const;
+
+        /**
+         * @brief: Returns whether the arena is backed by explicitly reserved (`MAP_HUGETLB`) huge pages.
+         */
+        bool isHugeTlb() const;
+    };
+} // namespace db
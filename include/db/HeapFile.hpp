@@ -1,23 +1,132 @@
 #pragma once
 
 #include <db/DbFile.hpp>
+#include <db/HeapPage.hpp>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <span>
 
 namespace db {
+// The number of pages HeapFile::bulkInsert fills before it writes them out
+constexpr size_t BULK_LOAD_PAGES = 64;
+
+/**
+ * @brief A DbFile that stores tuples in HeapPages, in no particular order.
+ * @note A HeapFile keeps a free-space map next to it, in a file named after it with a `.fsm` suffix: one bit per page
+ * that is set when the page may have a free slot. Inserts fill the first such page, so space freed by deletes is
+ * reused before the file grows. The bits are hints: a page is checked when it is used, and a page that turns out to be
+ * full is taken off the map. A missing map is rebuilt from the pages when the file is opened. Changed words of the map
+ * are written to the map file when the file is synced (HeapFile::sync) and when it is closed. A map that cannot be
+ * written, such as on a read-only medium, is only kept in memory.
+ * @note The pages of a file of fixed-size records can use the PAX layout (PageLayout::PAX), chosen when the file is
+ * created and recorded with it; opening the file with another layout fails. The tuples are read and written the same
+ * way, and HeapFile::scanPages gives operators the pages, whose columns they read with HeapPage::column.
+ */
 class HeapFile : public DbFile {
+  const PageLayout layout;
+
+  std::mutex append_latch;
+
+  mutable std::mutex space_latch;
+  // -1 if the map is only kept in memory
+  int fsm_fd;
+  std::vector<uint64_t> free_pages;
+  // No page before this word of the map has a free slot
+  size_t first_free = 0;
+  // The words of the map that changed since they were last written to the map file
+  mutable std::set<size_t> dirty_words;
+  // The free-slot hint of each page (HeapPage::freeHint), so that inserts into a page do not search its occupied slots
+  // again; it is not stored, and a page without one is searched from its first slot
+  std::vector<uint16_t> free_slots;
+
+  // Returns the first page of the map with a free slot, if any
+  std::optional<size_t> findFree();
+
+  // Updates the bit of a page, and marks the word that holds it dirty when it changes
+  void setFree(size_t page, bool free);
+
+  // Writes the dirty words of the map to the map file, one write per run of adjacent words
+  void writeMap() const;
+
+  // Returns the free-slot hint of a page for a new wrapper of it
+  size_t freeHint(size_t page);
+
+  // Keeps the free-slot hint of a page after a wrapper of it changed the page
+  void setFreeHint(size_t page, size_t slot);
+
 public:
-  HeapFile(const std::string &name, const TupleDesc &td);
+  /**
+   * @param layout How the records are arranged in the pages of the file.
+   * @param page_size The size of the pages of a new file (see DbFile::DbFile).
+   * @throws std::runtime_error if the file cannot be opened, if it was written with another layout, or if its
+   * free-space map cannot be read.
+   * @throws std::logic_error if the layout is PageLayout::PAX and the TupleDesc has a VARCHAR field, or if the page
+   * size is not valid.
+   */
+  HeapFile(const std::string &name, const TupleDesc &td, PageLayout layout = PageLayout::ROW,
+           size_t page_size = DEFAULT_PAGE_SIZE);
+
+  /**
+   * @brief Writes the dirty words of the free-space map, and closes it.
+   * @note A map that cannot be written is only a hint, so the error is not reported; the map is rebuilt from the
+   * pages if it is removed.
+   */
+  ~HeapFile() override;
+
+  /**
+   * @brief Writes the dirty words of the free-space map to the map file, then waits until the data written to the file
+   * is on stable storage.
+   * @throws std::runtime_error if the map cannot be written, or if the `fdatasync` system call fails. The words that
+   * were not written stay dirty.
+   */
+  void sync() const override;
 
   /**
    * @brief Insert a tuple to the database file.
-   * @details Insert a tuple to the first available slot of the last page. If the last page is full, create a new page.
+   * @details Insert a tuple to the first available slot of the first page with free space in the free-space map. If
+   * no page has free space, create a new page.
    * @param t The tuple to be inserted.
+   * @note Concurrent inserts are serialized, since they all go to the same page.
+   * @throws std::runtime_error if the tuple is not compatible with the TupleDesc, or longer than the maxRecordSize of
+   * the page size.
+   * @throws std::logic_error if the file is mapped read-only.
    */
   void insertTuple(const Tuple &t) override;
 
+  /**
+   * @brief Append many tuples to the database file at once.
+   * @details Fill the last page through the BufferPool first. Then fill new pages in private buffers, BULK_LOAD_PAGES
+   * at a time, and write them out in order with vectored writes, before they are added to the file. Only a partial
+   * page at the end goes through the BufferPool.
+   * @param tuples The tuples to be inserted, in order.
+   * @throws std::runtime_error if a tuple is not compatible with the TupleDesc, or longer than the maxRecordSize of the
+   * page size; nothing is inserted then.
+   * @throws std::logic_error if the file is mapped read-only.
+   * @note Space freed on earlier pages is not reused, but stays in the free-space map for later inserts.
+   * @note A concurrent scan sees each run of new pages once it is written.
+   */
+  void bulkInsert(std::span<const Tuple> tuples);
+
+  /**
+   * @brief Move tuples from the end of the file into free slots of earlier pages, and truncate the emptied pages.
+   * @details Take the tuples of the last page, one at a time, and insert them into the first page with free space in
+   * the free-space map, as long as that page comes before the last one. A page that is emptied is cut off the file,
+   * and the next page from the end is compacted, up to a number of pages per call.
+   * @param max_pages The most pages to take tuples from in this call, so that a compaction can run in steps.
+   * @return The number of pages cut off the file; 0 once no more tuples can move.
+   * @throws std::logic_error if the file is mapped read-only or compressed.
+   * @note Moved tuples change location, so iterators over the file are invalidated. Inserts wait for each call; scans
+   * and deletes must not run concurrently.
+   */
+  size_t compact(size_t max_pages = SIZE_MAX);
+
   /**
    * @brief Delete a tuple from the database file.
-   * @details Delete a tuple from the database file by marking the slot unused.
+   * @details Delete a tuple from the database file by marking the slot unused. The page is marked in the free-space
+   * map, so that the slot is reused.
    * @param it The iterator that identifies the tuple to be deleted.
+   * @throws std::logic_error if the file is mapped read-only.
    */
   void deleteTuple(const Iterator &it) override;
 
@@ -26,14 +135,44 @@ public:
    * @details Get a tuple from the database file by reading the tuple from the page.
    * @param it The iterator that identifies the tuple to be read.
    * @return The tuple read from the page.
+   * @note The page is requested with the default AccessHint, so that pages used by lookups stay in the pool.
    */
   Tuple getTuple(const Iterator &it) const override;
 
+  /**
+   * @brief Get a view of a tuple, which reads its fields from the pinned page.
+   * @param it The iterator that identifies the tuple.
+   * @param page The guard that keeps the page pinned; it is replaced.
+   * @note The page is requested with the default AccessHint, like in HeapFile::getTuple.
+   */
+  TupleView getView(const Iterator &it, PageGuard &page) const override;
+
+  /**
+   * @brief Call a function with a view of every tuple of the file, in order.
+   * @details Pin each page once, with AccessHint::SEQUENTIAL, and visit its occupied slots with HeapPage::forEach.
+   */
+  void scan(const std::function<void(const TupleView &)> &f) const override;
+
+  /**
+   * @brief Call a function with every page of the file, in order.
+   * @details Pin each page once, with AccessHint::SEQUENTIAL, so that an operator can process the tuples of a page at
+   * once, such as a filter over HeapPage::column of a PAX page.
+   * @param f The function to call; the page is only valid during the call.
+   * @note The file must not be modified during the scan.
+   */
+  void scanPages(const std::function<void(const HeapPage &)> &f) const;
+
+  /**
+   * @brief Returns how the records are arranged in the pages of the file.
+   */
+  PageLayout getLayout() const;
+
   /**
    * @brief Advance the iterator to the next tuple.
    * @details Advance the iterator to the next tuple by moving to the next slot of the page.
    * @param it The iterator to be advanced.
    * @note The next tuple may be on a subsequent page (pages might be empty).
+   * @note Pages are requested with AccessHint::SEQUENTIAL so that a scan does not flush frequently used pages.
    */
   void next(Iterator &it) const override;
 
@@ -42,6 +181,7 @@ public:
    * @details Get the iterator to the first tuple by finding the first occupied slot.
    * @return The iterator to the first tuple.
    * @note The first tuple may not be on the first page.
+   * @note Pages are requested with AccessHint::SEQUENTIAL.
    */
   Iterator begin() const override;
 
@@ -1,13 +1,75 @@
 #pragma once
 
 #include <db/DbFile.hpp>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
 
 namespace db {
+// Returns the largest record a slotted HeapPage of a page size holds: the page, less its header and one entry of its slot
+// directory
+constexpr size_t maxRecordSize(size_t page_size = DEFAULT_PAGE_SIZE) { return page_size - 5 * sizeof(uint16_t); }
+// The alignment of the minipages of a PAX page, so that a column of INT or DOUBLE values can be read as an array
+constexpr size_t MINIPAGE_ALIGNMENT = 8;
+
+/**
+ * @brief How the tuples of fixed-size records are arranged in a HeapPage.
+ * @details ROW stores each record contiguously in a slot. PAX (Partition Attributes Across) stores the values of each
+ * field of all the slots contiguously in a minipage of the field, so that a scan of one field only reads that field.
+ */
+enum class PageLayout { ROW, PAX };
+
+/**
+ * @brief Wraps a page as an array of fixed-size slots, with a header bitmap of the occupied slots.
+ * @note The bitmap is searched 64 slots at a time. The first bit of each header byte is the first of its 8 slots, so a
+ * word of the header read in big-endian order has the first of its slots in the most significant bit.
+ * @note Tuples with VARCHAR fields have a variable length, and are stored in a slotted page instead: a header, then a
+ * directory of the offset and the length of each record, which grows from the start of the page, while the records
+ * are stored from the end of the page down. A deleted record leaves a hole, and the records are moved together when
+ * an insert needs the space; the slot numbers do not change.
+ * @note With PageLayout::PAX, the bitmap is followed by a minipage per field, which holds the values of the field of
+ * all the slots in slot order. The capacity is even, and the minipage of a field starts at its offset in a record
+ * times the capacity, aligned to MINIPAGE_ALIGNMENT, so its position does not depend on the contents of the page. The
+ * slots and the bitmap work as in a row page, and HeapPage::column gives the values of a field as an array.
+ */
 class HeapPage {
+  struct SlottedHeader {
+    uint16_t slots;
+    // The bytes at the end of the page taken by records, and those among them freed by deletes
+    uint16_t used;
+    uint16_t holes;
+  };
+  struct Slot {
+    // A free slot has offset 0
+    uint16_t offset;
+    uint16_t length;
+  };
+
   const TupleDesc &td;
+  size_t page_size;
   size_t capacity;
   uint8_t *header;
   uint8_t *data;
+  // Set for a slotted page, whose directory follows the header
+  SlottedHeader *slotted = nullptr;
+  Slot *directory = nullptr;
+  // Set for a PAX page, whose data is the minipages
+  bool pax = false;
+  // No slot before this one is free; the owner of the page keeps it between wrappers (HeapPage::freeHint)
+  size_t free_hint;
+
+  // Returns the first slot from the specified one on that is occupied (or free), capacity if there is none
+  size_t find(size_t from, bool occupied) const;
+
+  // Returns the free bytes of a slotted page, including the holes
+  size_t space() const;
+
+  // Moves the records of a slotted page together at the end of the page
+  void pack();
+
+  // Writes the fields of a tuple into the minipages of a PAX page
+  void store(size_t slot, const Tuple &t);
 
 public:
   /**
@@ -15,10 +77,23 @@ public:
    * @details Wrap a page with a heap page by initializing the header and data pointers.
    * @param page The page to be wrapped.
    * @param td The tuple descriptor of the page.
+   * @param layout How the records are arranged in the page.
+   * @param page_size The size of the page, that of its file; the rest of the Page is not used.
+   * @param free_hint A slot before which no slot of the page is free, as returned by HeapPage::freeHint of an earlier
+   * wrapper of the page; inserts search for a free slot from there.
    * @note header and data should point to locations inside the page buffer. Do not allocate extra memory.
    * @note initialize capacity to the number of slots that can fit in the page.
+   * @throws std::logic_error if the layout is PageLayout::PAX and the TupleDesc has a VARCHAR field.
    */
-  HeapPage(Page &page, const TupleDesc &td);
+  HeapPage(Page &page, const TupleDesc &td, PageLayout layout = PageLayout::ROW, size_t page_size = DEFAULT_PAGE_SIZE,
+           size_t free_hint = 0);
+
+  /**
+   * @brief Get a slot before which no slot of the page is free.
+   * @details Inserts move it forward and deletes move it back, so that an owner that keeps it for the next wrapper of
+   * the page does not search the occupied slots again.
+   */
+  size_t freeHint() const;
 
   /**
    * @brief Get the first occupied slot of the page.
@@ -28,7 +103,7 @@ public:
 
   /**
    * @brief Get the end of the page.
-   * @return capacity can be used as the end of the page.
+   * @return capacity can be used as the end of the page; for a slotted page, the number of slots of its directory.
    */
   size_t end() const;
 
@@ -40,6 +115,23 @@ public:
    */
   bool insertTuple(const Tuple &t);
 
+  /**
+   * @brief Check if every slot of the page is occupied.
+   * @return True if no tuple can be inserted into the page, false otherwise. A slotted page is full when a record of
+   * the smallest size does not fit.
+   */
+  bool full() const;
+
+  /**
+   * @brief Fill an empty page with tuples.
+   * @details Serialize the tuples into the first slots, in order, and mark the slots occupied a header byte at a time.
+   * A slotted page takes the tuples in order until one does not fit.
+   * @param tuples The tuples to be inserted; those that do not fit are left out.
+   * @return The number of tuples inserted.
+   * @note The page must be empty.
+   */
+  size_t fill(std::span<const Tuple> tuples);
+
   /**
    * @brief Delete a tuple from the page.
    * @details Delete a tuple from the page by marking the slot unused.
@@ -63,10 +155,49 @@ public:
    */
   Tuple getTuple(size_t slot) const;
 
+  /**
+   * @brief Get a view of the tuple at the specified slot, which reads its fields from the page.
+   * @param slot The slot of the tuple.
+   * @return The view, valid as long as the page is pinned and the slot is not changed.
+   */
+  TupleView getView(size_t slot) const;
+
   /**
    * @brief Advance the slot to the next occupied slot.
    * @details Advance the slot to the next occupied slot by scanning the header.
    */
   void next(size_t &slot) const;
+
+  /**
+   * @brief Count the occupied slots of the page.
+   */
+  size_t count() const;
+
+  /**
+   * @brief Call a function with every occupied slot of the page, in order.
+   * @details Scan the header a word at a time, visiting only the set bits.
+   * @param f The function to call with each slot.
+   */
+  void forEach(const std::function<void(size_t)> &f) const;
+
+  /**
+   * @brief Get the values of an INT or DOUBLE field of every slot of a PAX page, without copying them.
+   * @details The values are indexed by slot; those of free slots are meaningless, so a vectorized operator checks
+   * HeapPage::empty or visits the slots with HeapPage::forEach.
+   * @tparam T int for an INT field, double for a DOUBLE field.
+   * @param field The index of the field.
+   * @return The values of the capacity slots.
+   * @throws std::logic_error if the page is not a PAX page, or if the field has another type.
+   */
+  template <typename T> std::span<const T> column(size_t field) const {
+    static_assert(std::is_same_v<T, int> || std::is_same_v<T, double>, "Columns of INT or DOUBLE fields");
+    if (!pax) {
+      throw std::logic_error("Only PAX pages store columns");
+    }
+    if (td.field_type(field) != (std::is_same_v<T, int> ? type_t::INT : type_t::DOUBLE)) {
+      throw std::logic_error("Field has another type");
+    }
+    return {reinterpret_cast<const T *>(data + td.offset_of(field) * capacity), capacity};
+  }
 };
 } // namespace db
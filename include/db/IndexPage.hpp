@@ -28,8 +28,9 @@ struct IndexPage {
    *
    * @param page the page contents
    * @param key_index the index of the key in the tuple
+   * @param page_size the size of the page; the rest of the Page is not used
    */
-  explicit IndexPage(Page &page);
+  explicit IndexPage(Page &page, size_t page_size = DEFAULT_PAGE_SIZE);
 
   /**
    * @brief Insert a new key with a corresponding child page number
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <thread>
+#include <vector>
+
+namespace db {
+    /**
+     * @brief The implementations of IoQueue.
+     * @details AUTO uses io_uring when the kernel supports it and falls back to a thread pool otherwise.
+     */
+    enum class IoBackend {
+        AUTO, URING, THREADS
+    };
+
+    /**
+     * @brief A vectored read or write of consecutive bytes of a file.
+     */
+    struct IoRequest {
+        enum Op : uint8_t {
+            READ, WRITE
+        };
+
+        Op op = READ;
+        int fd = -1;
+        off_t offset = 0;
+        // At most IOV_MAX buffers
+        std::vector<iovec> buffers;
+        // Set when the request completes: the number of bytes transferred, or a negated errno value
+        ssize_t result = 0;
+        // Set when the request is prepared
+        std::chrono::steady_clock::time_point issued;
+        // Free for the submitter to identify the request
+        uint64_t tag = 0;
+
+        /**
+         * @brief: Returns the total size of the buffers.
+         */
+        size_t size() const;
+    };
+
+/**
+ * @brief Keeps several reads and writes in flight at once.
+ * @details Requests are prepared one by one, issued together by IoQueue::submit, and returned by IoQueue::wait in the
+ * order they complete. A queue holds at most IoQueue::depth requests that were prepared but not returned by wait yet.
+ * @note A queue must only be used by one thread at a time. The requests and their buffers must stay valid until wait
+ * returns them.
+ */
+    class IoQueue {
+    protected:
+        size_t queue_depth;
+        size_t prepared = 0;
+        size_t in_flight = 0;
+
+        explicit IoQueue(size_t depth) : queue_depth(depth) {}
+
+    public:
+        virtual ~IoQueue() = default;
+
+        IoQueue(const IoQueue &) = delete;
+
+        IoQueue &operator=(const IoQueue &) = delete;
+
+        /**
+         * @brief: Queues a request; it is issued by the next call to IoQueue::submit.
+         * @param request: The request.
+         * @throws std::logic_error if the queue is full.
+         */
+        virtual void prepare(IoRequest &request) = 0;
+
+        /**
+         * @brief: Issues the prepared requests, with a single system call where the backend allows it.
+         * @throws std::runtime_error if the requests cannot be issued.
+         */
+        virtual void submit() = 0;
+
+        /**
+         * @brief: Issues the prepared requests and waits until one of the requests completes.
+         * @return: The completed request; its result tells whether it succeeded.
+         * @throws std::logic_error if no request is pending.
+         */
+        virtual IoRequest &wait() = 0;
+
+        /**
+         * @brief: Returns the number of requests prepared or in flight.
+         */
+        size_t pending() const { return prepared + in_flight; }
+
+        /**
+         * @brief: Returns the maximum number of pending requests.
+         */
+        size_t depth() const { return queue_depth; }
+
+        /**
+         * @brief: Returns the name of the backend.
+         */
+        virtual const char *name() const = 0;
+    };
+
+/**
+ * @brief An IoQueue on an io_uring instance, driven through the raw system calls.
+ * @details Requests are written to the submission ring and issued with one io_uring_enter call per submit; completions
+ * are read from the completion ring without a system call when they are already there.
+ */
+    class UringQueue : public IoQueue {
+        int ring_fd = -1;
+        void *sq_ring = nullptr;
+        size_t sq_ring_size = 0;
+        void *cq_ring = nullptr;
+        size_t cq_ring_size = 0;
+        void *sqes = nullptr;
+        size_t sqes_size = 0;
+        unsigned *sq_tail = nullptr;
+        unsigned sq_mask = 0;
+        unsigned *sq_array = nullptr;
+        unsigned *cq_head = nullptr;
+        unsigned *cq_tail = nullptr;
+        unsigned cq_mask = 0;
+        void *cqes = nullptr;
+
+        void release();
+
+    public:
+        /**
+         * @brief: Sets up an io_uring instance with room for the specified number of requests.
+         * @throws std::runtime_error if the kernel does not support io_uring.
+         */
+        explicit UringQueue(size_t depth);
+
+        ~UringQueue() override;
+
+        void prepare(IoRequest &request) override;
+
+        void submit() override;
+
+        IoRequest &wait() override;
+
+        const char *name() const override { return "io_uring"; }
+    };
+
+/**
+ * @brief An IoQueue that runs blocking preadv and pwritev calls on a pool of threads.
+ */
+    class ThreadPoolQueue : public IoQueue {
+        std::mutex latch;
+        std::condition_variable work;
+        std::condition_variable done;
+        std::deque<IoRequest *> ready;
+        std::deque<IoRequest *> issued;
+        std::deque<IoRequest *> completed;
+        bool stop = false;
+        std::vector<std::thread> workers;
+
+        void run();
+
+    public:
+        /**
+         * @brief: Starts the threads of the pool.
+         * @param depth: The maximum number of pending requests.
+         * @param num_threads: The number of threads; 0 starts one thread per request, up to 16.
+         */
+        explicit ThreadPoolQueue(size_t depth, size_t num_threads = 0);
+
+        ~ThreadPoolQueue() override;
+
+        void prepare(IoRequest &request) override;
+
+        void submit() override;
+
+        IoRequest &wait() override;
+
+        const char *name() const override { return "threads"; }
+    };
+
+/**
+ * @brief Creates an IoQueue.
+ * @param depth: The maximum number of pending requests.
+ * @param backend: The implementation to use.
+ * @return: The new queue.
+ * @throws std::runtime_error if io_uring was requested explicitly and is not supported.
+ */
+    std::unique_ptr<IoQueue> makeIoQueue(size_t depth, IoBackend backend = IoBackend::AUTO);
+} // namespace db
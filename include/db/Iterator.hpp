@@ -5,6 +5,8 @@
 namespace db {
     class DbFile;
 
+    class PageGuard;
+
     struct Iterator {
         const DbFile &file;
         size_t page;
@@ -21,6 +23,12 @@ namespace db {
 
         Tuple operator*() const;
 
+        /**
+         * @brief Get a view of the tuple, which reads its fields from its page instead of copying them.
+         * @param page The guard that keeps the page pinned while the view is used; it is replaced.
+         */
+        TupleView view(PageGuard &page) const;
+
         Iterator &operator++();
 
         bool operator==(const Iterator &other) const { return page == other.page && slot == other.slot; }
@@ -10,17 +10,31 @@ struct LeafPageHeader {
 
   /// The number of tuples in the page
   uint16_t size;
+
+  /// The number of bytes at the end of the page taken by records, for tuples of variable length
+  uint16_t used;
 };
 
+/// Returns the largest record of variable length a leaf of a page size holds, with its entry in the directory: a quarter
+/// of the page, so that a leaf that is not full and either half of a split leaf always have room for one more
+constexpr size_t maxLeafRecordSize(size_t page_size = DEFAULT_PAGE_SIZE) {
+  return (page_size - sizeof(LeafPageHeader)) / 4 - 2 * sizeof(uint16_t);
+}
+
 struct LeafPage {
   const TupleDesc &td;
 
   /// The index of the key in a tuple (the key field should be of type int)
   const size_t key_index;
 
+  /// The size of the page, that of its file; the rest of the Page is not used
+  const size_t page_size;
+
+  /// For tuples of variable length, the number of the smallest ones that fit
   uint16_t capacity;
 
   LeafPageHeader *header;
+  /// For tuples of variable length, the directory of the offset and the length of each record, in key order
   uint8_t *data;
 
   /**
@@ -28,23 +42,29 @@ struct LeafPage {
    *
    * @details The provided page has a header of type LeafPageHeader, followed by a sequence of tuples.
    * The capacity of the page is calculated based on the remaining size of the page and the size of the tuples.
+   * Tuples with VARCHAR fields have a variable length: the header is followed by a directory of the records instead,
+   * and the records are stored from the end of the page down.
    *
    * @param page the page contents
    * @param td the tuple descriptor
    * @param key_index the index of the key in the tuple
+   * @param page_size the size of the page
    */
-  LeafPage(Page &page, const TupleDesc &td, size_t key_index);
+  LeafPage(Page &page, const TupleDesc &td, size_t key_index, size_t page_size = DEFAULT_PAGE_SIZE);
 
   /**
    * @brief Insert a tuple into the page
    * @details The tuple is inserted in sorted order based on the key. If the key already exists, the previous tuple is replaced.
-   * @return true if the leaf is full and needs to be split.
+   * @return true if the leaf is full and needs to be split; a leaf of variable-length tuples is full when a record of
+   * maxLeafRecordSize would not fit.
+   * @throws std::runtime_error if a tuple of variable length is longer than maxLeafRecordSize.
    */
   bool insertTuple(const Tuple &t);
 
   /**
    * @brief Split the leaf page
    * @details The page is split into two pages. The old page contains the first half of the tuples, and the new page contains the second half.
+   * Tuples of variable length are split by size instead of by number.
    * @param new_page a new empty page
    * @return the split key (the first key of the new page)
    */
@@ -57,6 +77,18 @@ struct LeafPage {
    * @return The tuple read from the page.
    */
   Tuple getTuple(size_t slot) const;
+
+  /**
+   * @brief Get a view of a tuple of the page, which reads its fields from the page.
+   * @return The view, valid as long as the page is pinned and not changed.
+   */
+  TupleView getView(size_t slot) const;
+
+  /**
+   * @brief Move the records of a leaf of variable-length tuples together at the end of the page, in key order
+   * @details Records that are not in the directory are dropped.
+   */
+  void pack();
 };
 
 } // namespace db
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+namespace db {
+/**
+ * @brief A histogram of operation latencies with power-of-two buckets.
+ * @details Bucket i counts the operations that took between 2^i and 2^(i+1) nanoseconds; bucket 0 also counts
+ * operations that took no measurable time and the last bucket counts everything slower.
+ */
+    struct LatencyHistogram {
+        static constexpr size_t NUM_BUCKETS = 40;
+
+        std::array<size_t, NUM_BUCKETS> buckets{};
+
+        /**
+         * @brief: Returns the bucket that counts operations with the specified latency.
+         */
+        static size_t bucketOf(std::chrono::nanoseconds latency);
+
+        /**
+         * @brief: Returns the number of operations recorded.
+         */
+        size_t count() const;
+
+        /**
+         * @brief: Returns an upper bound of the latency below which the specified share of the operations completed.
+         * @param ratio: The share of the operations, between 0 and 1 (0.99 for the 99th percentile).
+         * @return: The upper end of the bucket that contains the percentile, 0 if nothing was recorded.
+         */
+        std::chrono::nanoseconds percentile(double ratio) const;
+
+        LatencyHistogram &operator+=(const LatencyHistogram &other);
+    };
+
+/**
+ * @brief A snapshot of the buffer and I/O activity of a DbFile or of a whole BufferPool.
+ */
+    struct IoMetrics {
+        // Requests that found the page in the pool, and requests that had to read it
+        size_t hits = 0;
+        size_t misses = 0;
+        // Pages read by the read-ahead worker before they were requested
+        size_t prefetches = 0;
+        // Pages dropped from the pool to make room for others, and the misses that had to write their victim first
+        size_t evictions = 0;
+        size_t dirty_evictions = 0;
+        size_t pages_read = 0;
+        size_t pages_written = 0;
+        size_t bytes_read = 0;
+        size_t bytes_written = 0;
+        // Latency of every read and of every (possibly vectored) write system call
+        LatencyHistogram read_latency;
+        LatencyHistogram write_latency;
+
+        IoMetrics &operator+=(const IoMetrics &other);
+    };
+
+/**
+ * @brief The live counters behind an IoMetrics snapshot.
+ * @details Every counter is a relaxed atomic, so they can be updated from several threads without a latch. A snapshot
+ * taken while they change is not necessarily consistent across counters.
+ */
+    class IoCounters {
+        using Buckets = std::array<std::atomic<size_t>, LatencyHistogram::NUM_BUCKETS>;
+
+        std::atomic<size_t> hits = 0;
+        std::atomic<size_t> misses = 0;
+        std::atomic<size_t> prefetches = 0;
+        std::atomic<size_t> evictions = 0;
+        std::atomic<size_t> dirty_evictions = 0;
+        std::atomic<size_t> pages_read = 0;
+        std::atomic<size_t> pages_written = 0;
+        std::atomic<size_t> bytes_read = 0;
+        std::atomic<size_t> bytes_written = 0;
+        Buckets read_latency{};
+        Buckets write_latency{};
+
+    public:
+        void recordHit() { hits.fetch_add(1, std::memory_order_relaxed); }
+
+        void recordMiss() { misses.fetch_add(1, std::memory_order_relaxed); }
+
+        void recordPrefetch() { prefetches.fetch_add(1, std::memory_order_relaxed); }
+
+        void recordEviction(bool dirty);
+
+        /**
+         * @brief: Records a read system call.
+         * @param pages: The number of pages read.
+         * @param bytes: The number of bytes read.
+         * @param latency: How long the call took.
+         */
+        void recordRead(size_t pages, size_t bytes, std::chrono::nanoseconds latency);
+
+        /**
+         * @brief: Records a write system call.
+         * @param pages: The number of pages written.
+         * @param bytes: The number of bytes written.
+         * @param latency: How long the call took.
+         */
+        void recordWrite(size_t pages, size_t bytes, std::chrono::nanoseconds latency);
+
+        IoMetrics snapshot() const;
+
+        void reset();
+    };
+} // namespace db
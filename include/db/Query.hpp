@@ -72,6 +72,7 @@ struct Aggregate {
  * @param in The input table.
  * @param out The output table.
  * @param field_names The fields to keep.
+ * @note Only the fields that are kept are read (DbFile::scanColumns).
  */
 void projection(const DbFile &in, DbFile &out, const std::vector<std::string> &field_names);
 
@@ -83,6 +84,8 @@ void projection(const DbFile &in, DbFile &out, const std::vector<std::string> &f
  * @param in The input table.
  * @param out The output table.
  * @param pred The predicates to filter rows.
+ * @note A file that fetches rows without a scan (DbFile::supportsRowFetch), such as a ColumnFile, is read in two
+ * passes: the fields of the predicates, then the other fields at the matching rows.
  */
 void filter(const DbFile &in, DbFile &out, const std::vector<FilterPredicate> &pred);
 
@@ -109,6 +112,7 @@ void join(const DbFile &left, const DbFile &right, DbFile &out, const JoinPredic
  * @param out The output table.
  * @param agg The aggregate operation.
  * @note The computed value should have the same type as the field being aggregated with the exception of AVG which should return a double.
+ * @note Only the aggregated field and the group field are read (DbFile::scanColumns).
  */
 void aggregate(const DbFile &in, DbFile &out, const Aggregate &agg);
 
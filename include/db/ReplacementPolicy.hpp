@@ -0,0 +1,180 @@
+#pragma once
+
+#include <db/types.hpp>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace db {
+    /**
+     * @brief The replacement policies a BufferPool can be configured with.
+     */
+    enum class ReplacementPolicyType {
+        LRU, CLOCK, TWO_Q
+    };
+
+    /**
+     * @brief Describes how a page is being accessed.
+     * @details SEQUENTIAL accesses come from scans that read every page once; policies recycle those pages first
+     * and do not let them displace pages that are accessed repeatedly.
+     */
+    enum class AccessHint {
+        NORMAL, SEQUENTIAL
+    };
+
+/**
+ * @brief Decides which frame of a BufferPool is evicted when a page has to be read into a full pool.
+ * @details A policy only deals with frame positions. The BufferPool reports every page that is loaded, accessed and
+ * discarded, and asks for a victim when it has no free frame left.
+ */
+    class ReplacementPolicy {
+    public:
+        virtual ~ReplacementPolicy() = default;
+
+        /**
+         * @brief: Records that a page was read into the frame at the specified position.
+         * @param pos: The position of the frame.
+         * @param pid: The id of the page that was read.
+         * @param hint: How the page is being accessed.
+         */
+        virtual void insert(size_t pos, const PageId &pid, AccessHint hint) = 0;
+
+        /**
+         * @brief: Records an access to the page in the frame at the specified position.
+         * @param pos: The position of the frame.
+         * @param hint: How the page is being accessed.
+         * @note This is called on every buffer pool hit and should be as cheap as possible.
+         */
+        virtual void touch(size_t pos, AccessHint hint) = 0;
+
+        /**
+         * @brief: Stops tracking the frame at the specified position.
+         * @param pos: The position of the frame.
+         */
+        virtual void erase(size_t pos) = 0;
+
+        /**
+         * @brief: Selects the frame whose page should be evicted.
+         * @param evictable: Returns whether the frame at a position may be evicted.
+         * @return: The position of an occupied, evictable frame, or nothing if there is none.
+         */
+        virtual std::optional<size_t> victim(const std::function<bool(size_t)> &evictable) = 0;
+
+        /**
+         * @brief: Moves the tracked frames to new positions after the BufferPool reallocated its frames.
+         * @param new_pos: The new position of every old frame (only occupied frames are looked up).
+         * @param num_frames: The new number of frames.
+         */
+        virtual void relocate(const std::vector<size_t> &new_pos, size_t num_frames) = 0;
+    };
+
+/**
+ * @brief Evicts the least recently used page.
+ * @details The frames are kept in a list ordered by recency; every access moves the frame to the front.
+ * Sequentially accessed pages are inserted at the back and are not moved on access.
+ */
+    class LruPolicy : public ReplacementPolicy {
+        std::list<size_t> lru_list;
+        std::vector<std::list<size_t>::iterator> pos_to_lru;
+
+    public:
+        explicit LruPolicy(size_t num_frames);
+
+        void insert(size_t pos, const PageId &pid, AccessHint hint) override;
+
+        void touch(size_t pos, AccessHint hint) override;
+
+        void erase(size_t pos) override;
+
+        std::optional<size_t> victim(const std::function<bool(size_t)> &evictable) override;
+
+        void relocate(const std::vector<size_t> &new_pos, size_t num_frames) override;
+    };
+
+/**
+ * @brief Approximates LRU with a reference bit per frame and a sweeping clock hand.
+ * @details The state of every frame is a single byte in a flat array indexed by the frame position, so an access is
+ * a single store. The hand clears the reference bits it passes over and evicts the first frame found unreferenced.
+ * Sequentially accessed pages never get their reference bit set.
+ */
+    class ClockPolicy : public ReplacementPolicy {
+        enum : uint8_t {
+            FREE, UNREFERENCED, REFERENCED
+        };
+
+        std::vector<uint8_t> state;
+        size_t hand = 0;
+
+    public:
+        explicit ClockPolicy(size_t num_frames);
+
+        void insert(size_t pos, const PageId &pid, AccessHint hint) override;
+
+        void touch(size_t pos, AccessHint hint) override {
+            if (hint == AccessHint::NORMAL) {
+                state[pos] = REFERENCED;
+            }
+        }
+
+        void erase(size_t pos) override;
+
+        std::optional<size_t> victim(const std::function<bool(size_t)> &evictable) override;
+
+        void relocate(const std::vector<size_t> &new_pos, size_t num_frames) override;
+    };
+
+/**
+ * @brief The 2Q policy (Johnson and Shasha), which keeps pages referenced only once from displacing hot pages.
+ * @details Pages read for the first time enter a FIFO queue (A1in). Only a page that is read again shortly after it
+ * was evicted from A1in (its id is remembered in the A1out ghost queue) enters the main LRU queue (Am). Victims come
+ * from A1in while it holds more than a quarter of the frames, otherwise from Am. Sequentially accessed pages are put
+ * at the evicting end of A1in and are not remembered in A1out.
+ */
+    class TwoQueuePolicy : public ReplacementPolicy {
+        enum : uint8_t {
+            FREE, A1IN, AM
+        };
+
+        struct Frame {
+            uint8_t queue = FREE;
+            bool sequential = false;
+            size_t key = 0;
+            std::list<size_t>::iterator it;
+        };
+
+        std::vector<Frame> frames;
+        std::list<size_t> a1in;
+        std::list<size_t> am;
+        std::list<size_t> a1out;
+        std::unordered_map<size_t, std::list<size_t>::iterator> ghosts;
+
+        size_t maxA1in() const;
+
+        size_t maxA1out() const;
+
+    public:
+        explicit TwoQueuePolicy(size_t num_frames);
+
+        void insert(size_t pos, const PageId &pid, AccessHint hint) override;
+
+        void touch(size_t pos, AccessHint hint) override;
+
+        void erase(size_t pos) override;
+
+        std::optional<size_t> victim(const std::function<bool(size_t)> &evictable) override;
+
+        void relocate(const std::vector<size_t> &new_pos, size_t num_frames) override;
+    };
+
+/**
+ * @brief Creates a replacement policy of the specified type.
+ * @param type: The type of the policy.
+ * @param num_frames: The number of frames the policy tracks.
+ * @return: The new policy.
+ */
+    std::unique_ptr<ReplacementPolicy> makeReplacementPolicy(ReplacementPolicyType type, size_t num_frames);
+} // namespace db
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <db/Tuple.hpp>
+#include <array>
+#include <utility>
+
+namespace db {
+/**
+ * @brief A schema known at compile time, as the list of the types of its fields.
+ * @details The offsets and the length of the records are constants, and the FieldCodec of each field is called
+ * directly, so serializing a tuple neither switches on the type of each field nor reads the offsets from memory. The
+ * records are the same as those of the TupleDesc with the same types (Schema::desc), so the two can be mixed.
+ * @code
+ * using Item = Schema<type_t::INT, type_t::CHAR, type_t::DOUBLE>;
+ * Item::serialize(data, {{1, "apple", 1.0}});
+ * int id = Item::get<0>(data);
+ * @endcode
+ */
+    template<type_t... Types>
+    class Schema {
+        static constexpr std::array<size_t, sizeof...(Types)> offsets = [] {
+            std::array<size_t, sizeof...(Types)> offsets{};
+            size_t i = 0, offset = 0;
+            ((offsets[i++] = offset, offset += FieldCodec<Types>::size), ...);
+            return offsets;
+        }();
+
+        static constexpr std::array<type_t, sizeof...(Types)> types{Types...};
+
+        template<size_t... I>
+        static void encode(uint8_t *data, const Tuple &t, std::index_sequence<I...>) {
+            auto end = static_cast<uint16_t>(length());
+            (FieldCodec<Types>::encode(data, data + offsets[I], t.get_field(I), end), ...);
+        }
+
+        template<size_t... I>
+        static Tuple decode(const uint8_t *data, std::index_sequence<I...>) {
+            std::vector<field_t> fields;
+            fields.reserve(sizeof...(Types));
+            (decodeField<Types>(fields, data, data + offsets[I]), ...);
+            return {fields};
+        }
+
+    public:
+        /**
+         * @brief Get the number of fields
+         */
+        static constexpr size_t size() { return sizeof...(Types); }
+
+        /**
+         * @brief Get the offset of a field in the record
+         */
+        static constexpr size_t offset_of(size_t index) { return offsets.at(index); }
+
+        /**
+         * @brief Get the length of the records, or of their fixed-size part if the schema has VARCHAR fields
+         */
+        static constexpr size_t length() { return (FieldCodec<Types>::size + ... + 0); }
+
+        /**
+         * @brief Check if every record has the same length
+         */
+        static constexpr bool fixed() { return ((Types != type_t::VARCHAR) && ...); }
+
+        /**
+         * @brief Get the length of the record of a tuple
+         */
+        static size_t length(const Tuple &t) {
+            if constexpr (fixed()) {
+                return length();
+            } else {
+                size_t length = Schema::length();
+                for (size_t i = 0; i < size(); i++) {
+                    if (types[i] == type_t::VARCHAR) {
+                        length += std::get<std::string>(t.get_field(i)).size();
+                    }
+                }
+                return length;
+            }
+        }
+
+        /**
+         * @brief Build the TupleDesc of the schema, with the specified names
+         * @throws std::logic_error if the number of names is wrong, or if the names are not unique.
+         */
+        static TupleDesc desc(const std::vector<std::string> &names) { return {{Types...}, names}; }
+
+        /**
+         * @brief Serialize a Tuple, like TupleDesc::serialize
+         * @param data the buffer to serialize the Tuple into, of at least length(t) bytes
+         * @param t the Tuple to serialize, which must be compatible with the schema
+         */
+        static void serialize(uint8_t *data, const Tuple &t) {
+            encode(data, t, std::make_index_sequence<sizeof...(Types)>{});
+        }
+
+        /**
+         * @brief Deserialize a Tuple, like TupleDesc::deserialize
+         */
+        static Tuple deserialize(const uint8_t *data) {
+            return decode(data, std::make_index_sequence<sizeof...(Types)>{});
+        }
+
+        /**
+         * @brief Read a field of a record in place: an int, a double, or a string_view into the record
+         */
+        template<size_t I>
+        static auto get(const uint8_t *data) {
+            return FieldCodec<types[I]>::read(data, data + offsets[I]);
+        }
+    };
+} // namespace db
@@ -1,6 +1,8 @@
 #pragma once
 
-#include <db/types.hpp>
+#include <db/FieldCodec.hpp>
+#include <stdexcept>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -20,11 +22,21 @@ namespace db {
         const field_t &get_field(size_t i) const;
     };
 
+/**
+ * @brief Describes the fields of the tuples of a file, and how they are stored in a record.
+ * @details The offsets and the length of the fixed-size part of the records are computed once when the TupleDesc is
+ * built, and each field is encoded and decoded by the FieldCodec of its type. Schema does the same at compile time.
+ */
     class TupleDesc {
+        friend class TupleView;
+
         // TODO pa1: add private members
         std::vector<type_t> types;
         std::vector<size_t> offsets;
         std::unordered_map<std::string, size_t> name_to_index;
+        // The size of the fixed-size fields of a record, and the VARCHAR fields among them
+        size_t fixed_length = 0;
+        std::vector<size_t> varchars;
 
     public:
         TupleDesc() = default;
@@ -43,6 +55,7 @@ namespace db {
          * @brief Check if the provided Tuple is compatible with this TupleDesc
          * @details A Tuple is compatible with a TupleDesc if the Tuple has the same number of fields and each field is of the
          * same type as the corresponding field in the TupleDesc
+         * @note A string field is compatible with a CHAR or a VARCHAR field; a VARCHAR holds at most 65535 bytes.
          * @param tuple the Tuple to check
          * @return true if the Tuple is compatible, false otherwise
          */
@@ -51,11 +64,19 @@ namespace db {
         /**
          * @brief Get offset of the field
          * @details The offset of the field is the number of bytes from the start of the Tuple to the start of the field
+         * @note The offset of a VARCHAR field is that of its offset and length, in the fixed-size part of the record.
          * @param index the index of the field
          * @return the offset of the field
          */
         size_t offset_of(const size_t &index) const;
 
+        /**
+         * @brief Get the type of the field
+         * @param index the index of the field
+         * @return the type of the field
+         */
+        type_t field_type(size_t index) const;
+
         /**
          * @brief Get the index of the field
          * @details The index of the field is the position of the field in the Tuple
@@ -72,13 +93,27 @@ namespace db {
 
         /**
          * @brief Get the length of the TupleDesc
-         * @return the number of bytes needed to serialize a Tuple with this TupleDesc
+         * @return the number of bytes needed to serialize a Tuple with this TupleDesc; with VARCHAR fields, the number
+         * of bytes of the fixed-size part of the record, which is also the smallest record
          */
         size_t length() const;
 
+        /**
+         * @brief Get the length of a Tuple serialized with this TupleDesc
+         * @return the fixed-size part of the record, followed by the bytes of its VARCHAR fields
+         */
+        size_t length(const Tuple &t) const;
+
+        /**
+         * @brief Check if every Tuple with this TupleDesc serializes to the same number of bytes
+         * @return false if the TupleDesc has a VARCHAR field, true otherwise
+         */
+        bool fixed() const;
+
         /**
          * @brief Serialize a Tuple
-         * @param data the buffer to serialize the Tuple into
+         * @details The fields are written in order; the bytes of the VARCHAR fields follow them, in order.
+         * @param data the buffer to serialize the Tuple into, of at least length(t) bytes
          * @param t the Tuple to serialize
          */
         void serialize(uint8_t *data, const Tuple &t) const;
@@ -99,4 +134,82 @@ namespace db {
          */
         static db::TupleDesc merge(const TupleDesc &td1, const TupleDesc &td2);
     };
+
+/**
+ * @brief A tuple read in place from its serialized bytes, typically in a pinned page.
+ * @details The typed accessors read a field without building the other fields or copying the bytes of a string.
+ * A Tuple is only built when TupleView::materialize is called.
+ * @note A TupleView does not own its bytes: it is valid as long as the page it points into stays pinned and unchanged,
+ * and as long as its TupleDesc exists.
+ * @note The fields of a tuple of a PAX page are not contiguous: each is read from the minipage of its field.
+ */
+    class TupleView {
+        const TupleDesc *td;
+        const uint8_t *data;
+        // Set for a tuple of a PAX page: the number of values in each minipage, and the row of the tuple in them
+        size_t capacity = 0;
+        size_t row = 0;
+
+        const uint8_t *at(size_t i) const {
+            if (capacity != 0) {
+                return data + td->offsets[i] * capacity + row * fieldSize(td->types[i]);
+            }
+            return data + td->offsets[i];
+        }
+
+        const uint8_t *field(size_t i, type_t type) const {
+            if (td->types.at(i) != type) {
+                throw std::logic_error("Field has another type");
+            }
+            return at(i);
+        }
+
+    public:
+        TupleView(const TupleDesc &td, const uint8_t *data) : td(&td), data(data) {}
+
+        /**
+         * @brief A view of the tuple at a row of a PAX page, whose fields are stored in a minipage each.
+         * @param minipages the start of the minipages, each of which starts at the offset of its field times capacity
+         * @param capacity the number of values in each minipage
+         * @param row the row of the tuple in the minipages
+         */
+        TupleView(const TupleDesc &td, const uint8_t *minipages, size_t capacity, size_t row)
+                : td(&td), data(minipages), capacity(capacity), row(row) {}
+
+        /**
+         * @brief Get the number of fields of the tuple
+         */
+        size_t size() const { return td->types.size(); }
+
+        /**
+         * @brief Get the declared type of a field, CHAR or VARCHAR for a string
+         */
+        type_t field_type(size_t i) const { return td->types.at(i); }
+
+        /**
+         * @throws std::logic_error if the field is not an INT.
+         */
+        int get_int(size_t i) const { return FieldCodec<type_t::INT>::read(data, field(i, type_t::INT)); }
+
+        /**
+         * @throws std::logic_error if the field is not a DOUBLE.
+         */
+        double get_double(size_t i) const { return FieldCodec<type_t::DOUBLE>::read(data, field(i, type_t::DOUBLE)); }
+
+        /**
+         * @brief Get a string field, which points into the bytes of the tuple
+         * @throws std::logic_error if the field is not a CHAR or a VARCHAR.
+         */
+        std::string_view get_string(size_t i) const;
+
+        /**
+         * @brief Get a copy of a field
+         */
+        field_t get_field(size_t i) const;
+
+        /**
+         * @brief Build a Tuple with a copy of every field
+         */
+        Tuple materialize() const;
+    };
 } // namespace db
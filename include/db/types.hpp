@@ -6,33 +6,91 @@
 #include <variant>
 #include <cstdint>
 
+// The page sizes are build parameters of the storage layer: cmake -DDB_PAGE_SIZE=16384 -DDB_MAX_PAGE_SIZE=65536
+#ifndef DB_PAGE_SIZE
+#define DB_PAGE_SIZE 4096
+#endif
+#ifndef DB_MAX_PAGE_SIZE
+#define DB_MAX_PAGE_SIZE 65536
+#endif
+
 namespace db {
     constexpr size_t INT_SIZE = sizeof(int);
     constexpr size_t DOUBLE_SIZE = sizeof(double);
     constexpr size_t CHAR_SIZE = 64;
+    // A VARCHAR field holds the offset and the length of its bytes, which follow the fixed-size fields of the record
+    constexpr size_t VARCHAR_SIZE = 2 * sizeof(uint16_t);
 
     enum class type_t {
-        INT, CHAR, DOUBLE
+        INT, CHAR, DOUBLE, VARCHAR
     };
 
     using field_t = std::variant<int, double, std::string>;
 
+    using file_id_t = uint32_t;
+
+    /**
+     * @brief Identifies a page by the id the Database assigned to its file and the page number within the file.
+     * @details Both are packed into 64 bits, so a PageId is copied, compared and hashed like an integer.
+     */
     struct PageId {
-        std::string file;
-        size_t page;
+        static constexpr size_t FILE_BITS = 24;
+        static constexpr size_t PAGE_BITS = 40;
+
+        uint64_t file: FILE_BITS = 0;
+        uint64_t page: PAGE_BITS = 0;
 
     public:
+        PageId() = default;
+
+        PageId(file_id_t file, size_t page) : file(file), page(page) {}
+
+        /**
+         * @brief Constructs the id of a page of the file registered in the Database under the specified name.
+         * @throws std::logic_error if the name does not exist.
+         * @note This looks the name up in the catalog; code that accesses many pages should use the file id.
+         */
+        PageId(const std::string &file, size_t page);
+
+        uint64_t packed() const { return static_cast<uint64_t>(file) << PAGE_BITS | page; }
+
         bool operator==(const PageId &) const = default;
     };
 
-    constexpr size_t DEFAULT_PAGE_SIZE = 4096;
+    // The smallest page size of a file
+    constexpr size_t MIN_PAGE_SIZE = 4096;
+    // The page size of the files that do not choose one
+    constexpr size_t DEFAULT_PAGE_SIZE = DB_PAGE_SIZE;
+    // The largest page size of a file
+    constexpr size_t MAX_PAGE_SIZE = DB_MAX_PAGE_SIZE;
+
+    /**
+     * @brief Returns whether files can use pages of the specified size: a power of two from MIN_PAGE_SIZE to
+     * MAX_PAGE_SIZE.
+     */
+    constexpr bool validPageSize(size_t size) {
+        return size >= MIN_PAGE_SIZE && size <= MAX_PAGE_SIZE && (size & (size - 1)) == 0;
+    }
+
+    static_assert(MAX_PAGE_SIZE <= 65536 && validPageSize(MAX_PAGE_SIZE),
+                  "The largest page size must be a power of two from 4 KB to 64 KB");
+    static_assert(validPageSize(DEFAULT_PAGE_SIZE), "The page size must be a power of two from 4 KB to the largest one");
 
-    using Page = std::array<uint8_t, DEFAULT_PAGE_SIZE>;
+    // A page of any size; a page smaller than MAX_PAGE_SIZE only uses its first bytes. A Page that refers to a frame of
+    // the BufferPool, or to a page of a mapped file, only has the bytes of the page: its whole size must not be used
+    using Page = std::array<uint8_t, MAX_PAGE_SIZE>;
 } // namespace db
 
 template<>
 struct std::hash<const db::PageId> {
     std::size_t operator()(const db::PageId &r) const {
-        return std::hash<std::string>()(r.file) ^ std::hash<size_t>()(r.page);
+        // The finalizer of MurmurHash3: every bit of the file id and of the page number affects every bit of the hash
+        uint64_t h = r.packed();
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
     }
 };
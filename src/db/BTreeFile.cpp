@@ -7,24 +7,35 @@
 
 using namespace db;
 
-BTreeFile::BTreeFile(const std::string &name, const TupleDesc &td, size_t key_index)
-    : DbFile(name, td), key_index(key_index) {}
+/**
+ * Returns the page number of the leaf that follows a leaf, or nothing for the last leaf.
+ */
+static std::optional<size_t> nextLeaf(const Page &page) {
+  size_t next = reinterpret_cast<const LeafPageHeader *>(page.data())->next_leaf;
+  return next == 0 ? std::nullopt : std::optional(next);
+}
+
+BTreeFile::BTreeFile(const std::string &name, const TupleDesc &td, size_t key_index, size_t page_size)
+    : DbFile(name, td, page_size), key_index(key_index) {}
 
 void BTreeFile::insertTuple(const Tuple &t) {
+  checkWritable();
   std::vector<size_t> path;
   BufferPool &bufferPool = getDatabase().getBufferPool();
-  PageId pid{name, root_id};
+  std::lock_guard lock(insert_latch);
+  PageId pid{id, root_id};
 
-  Page &root_page = bufferPool.getPage(pid);
-  IndexPage root(root_page);
+  // The root stays pinned for the whole insert since a split may propagate up to it
+  PageGuard root_page = bufferPool.pinPage(pid);
+  IndexPage root(*root_page, getPageSize());
   if (root.header->size == 0 && root.children[0] != 1) {
-    bufferPool.markDirty({name, root_id});
-    pid.page = numPages++;
+    root_page.markDirty();
+    pid.page = appendPage();
     root.children[0] = pid.page;
   } else {
     while (true) {
-      Page &page = bufferPool.getPage(pid);
-      IndexPage node(page);
+      PageGuard page = bufferPool.pinPage(pid);
+      IndexPage node(*page, getPageSize());
       auto pos = std::lower_bound(node.keys, node.keys + node.header->size, std::get<int>(t.get_field(key_index)));
       auto slot = pos - node.keys;
       pid.page = node.children[slot];
@@ -35,17 +46,15 @@ void BTreeFile::insertTuple(const Tuple &t) {
     }
   }
 
-  Page &page = bufferPool.getPage(pid);
-  bufferPool.markDirty(pid);
-  LeafPage leaf(page, td, key_index);
+  PageGuard page = bufferPool.pinPage(pid, PageIntent::WRITE);
+  LeafPage leaf(*page, td, key_index, getPageSize());
   if (!leaf.insertTuple(t)) {
     return;
   }
 
-  pid.page = numPages++;
-  Page &new_leaf_page = bufferPool.getPage(pid);
-  bufferPool.markDirty(pid);
-  LeafPage new_leaf(new_leaf_page, td, key_index);
+  pid.page = appendPage();
+  PageGuard new_leaf_page = bufferPool.pinPage(pid, PageIntent::WRITE);
+  LeafPage new_leaf(*new_leaf_page, td, key_index, getPageSize());
   int new_key = leaf.split(new_leaf);
   leaf.header->next_leaf = pid.page;
   size_t new_child = pid.page;
@@ -54,37 +63,33 @@ void BTreeFile::insertTuple(const Tuple &t) {
     size_t parent_id = path.back();
     path.pop_back();
     pid.page = parent_id;
-    Page &parent_page = bufferPool.getPage(pid);
-    bufferPool.markDirty(pid);
-    IndexPage parent(parent_page);
+    PageGuard parent_page = bufferPool.pinPage(pid, PageIntent::WRITE);
+    IndexPage parent(*parent_page, getPageSize());
     if (!parent.insert(new_key, new_child)) {
       return;
     }
 
-    pid.page = numPages++;
-    Page &new_internal_page = bufferPool.getPage(pid);
-    bufferPool.markDirty(pid);
-    IndexPage new_internal(new_internal_page);
+    pid.page = appendPage();
+    PageGuard new_internal_page = bufferPool.pinPage(pid, PageIntent::WRITE);
+    IndexPage new_internal(*new_internal_page, getPageSize());
     new_key = parent.split(new_internal);
     new_child = pid.page;
   }
 
-  bufferPool.markDirty({name, root_id});
+  root_page.markDirty();
   if (!root.insert(new_key, new_child)) {
     return;
   }
-  pid.page = numPages++;
-  Page &new_child1 = bufferPool.getPage(pid);
-  bufferPool.markDirty(pid);
+  pid.page = appendPage();
+  PageGuard new_child1 = bufferPool.pinPage(pid, PageIntent::WRITE);
   size_t child1 = pid.page;
-  new_child1 = root_page;
-  IndexPage child1_page(new_child1);
+  std::copy_n(root_page->begin(), getPageSize(), new_child1->begin());
+  IndexPage child1_page(*new_child1, getPageSize());
 
-  pid.page = numPages++;
-  Page &new_child2 = bufferPool.getPage(pid);
-  bufferPool.markDirty(pid);
+  pid.page = appendPage();
+  PageGuard new_child2 = bufferPool.pinPage(pid, PageIntent::WRITE);
   size_t child2 = pid.page;
-  IndexPage child2_page(new_child2);
+  IndexPage child2_page(*new_child2, getPageSize());
 
   int key = child1_page.split(child2_page);
   root.header->size = 1;
@@ -98,38 +103,59 @@ void BTreeFile::deleteTuple(const Iterator &it) {
 }
 
 Tuple BTreeFile::getTuple(const Iterator &it) const {
-  BufferPool &bufferPool = getDatabase().getBufferPool();
-  PageId pid{name, it.page};
-  Page &page = bufferPool.getPage(pid);
-  LeafPage leaf(page, td, key_index);
+  PageGuard page = readGuard(it.page);
+  LeafPage leaf(*page, td, key_index, getPageSize());
   return leaf.getTuple(it.slot);
 }
 
+TupleView BTreeFile::getView(const Iterator &it, PageGuard &page) const {
+  page = readGuard(it.page);
+  return LeafPage(*page, td, key_index, getPageSize()).getView(it.slot);
+}
+
+void BTreeFile::scan(const std::function<void(const TupleView &)> &f) const {
+  size_t page = begin().page;
+  while (page != 0) {
+    PageGuard guard = readGuard(page, AccessHint::SEQUENTIAL);
+    LeafPage leaf(*guard, td, key_index, getPageSize());
+    for (size_t slot = 0; slot < leaf.header->size; slot++) {
+      f(leaf.getView(slot));
+    }
+    page = leaf.header->next_leaf;
+    if (page != 0 && !isMapped()) {
+      getDatabase().getBufferPool().readAheadChain({id, page}, nextLeaf);
+    }
+  }
+}
+
 void BTreeFile::next(Iterator &it) const {
-  BufferPool &bufferPool = getDatabase().getBufferPool();
-  PageId pid{name, it.page};
-  Page &page = bufferPool.getPage(pid);
-  LeafPage leaf(page, td, key_index);
+  PageGuard page = readGuard(it.page, AccessHint::SEQUENTIAL);
+  LeafPage leaf(*page, td, key_index, getPageSize());
   if (it.slot + 1 < leaf.header->size) {
     it.slot++;
   } else {
     it.page = leaf.header->next_leaf;
     it.slot = 0;
+    if (it.page != 0 && !isMapped()) {
+      getDatabase().getBufferPool().readAheadChain({id, it.page}, nextLeaf);
+    }
   }
 }
 
 Iterator BTreeFile::begin() const {
-  BufferPool &bufferPool = getDatabase().getBufferPool();
-  PageId pid{name, root_id};
+  size_t page = root_id;
   while (true) {
-    Page &page = bufferPool.getPage(pid);
-    IndexPage node(page);
-    pid.page = node.children[0];
+    PageGuard guard = readGuard(page);
+    IndexPage node(*guard, getPageSize());
+    page = node.children[0];
     if (!node.header->index_children) {
       break;
     }
   }
-  return {*this, pid.page, 0};
+  if (page != 0 && !isMapped()) {
+    getDatabase().getBufferPool().readAheadChain({id, page}, nextLeaf);
+  }
+  return {*this, page, 0};
 }
 
 Iterator BTreeFile::end() const {
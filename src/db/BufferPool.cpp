@@ -1,106 +1,960 @@
 #include <db/BufferPool.hpp>
 #include <db/Database.hpp>
+#include <algorithm>
 #include <numeric>
+#include <stdexcept>
+#include <utility>
 
 using namespace db;
 
-BufferPool::BufferPool() : available(DEFAULT_NUM_PAGES) {
-    // TODO pa0
+BufferPool::Shard::Shard(size_t first, size_t num_frames, ReplacementPolicyType policy)
+    : first(first), pos_to_pid(num_frames), pos_to_file(num_frames), available(num_frames),
+      policy(makeReplacementPolicy(policy, num_frames)), pins(num_frames), loading(num_frames),
+      prefetched(num_frames) {
     std::iota(available.rbegin(), available.rend(), 0);
 }
 
-BufferPool::~BufferPool() {
+BufferPool::BufferPool(size_t num_pages, bool huge_pages, ReplacementPolicyType policy, size_t num_shards)
+    : pages(num_pages, huge_pages, DEFAULT_PAGE_SIZE), huge_pages(huge_pages), policy_type(policy) {
     // TODO pa0
-    for (const size_t &pos: dirty) {
-        const Page &page = pages[pos];
-        const PageId &pid = pos_to_pid[pos];
-        getDatabase().get(pid.file).writePage(page, pid.page);
+    if (num_pages == 0) {
+        throw std::logic_error("Buffer pool must have at least one page");
     }
+    if (num_shards == 0 || num_shards > num_pages) {
+        throw std::logic_error("Invalid number of shards");
+    }
+    createShards(num_shards);
 }
 
-Page &BufferPool::getPage(const PageId &pid) {
+BufferPool::~BufferPool() {
     // TODO pa0
-    // If already in buffer pool, make it the most recent page and return it
-    if (contains(pid)) {
-        size_t pos = pid_to_pos.at(pid);
-        lru_list.splice(lru_list.begin(), lru_list, pos_to_lru[pos]);
-        pos_to_lru[pos] = lru_list.begin();
-        return pages[pos];
+    setReadAhead(0);
+    stopFlusher();
+    try {
+        flushAll();
+    } catch (const std::runtime_error &) {
+        // There is no one left to report a failed write to
+    }
+}
+
+void BufferPool::createShards(size_t num_shards) {
+    // Frames are split as evenly as possible; shard i owns [i * n / s, (i + 1) * n / s)
+    shards.clear();
+    for (size_t i = 0; i < num_shards; i++) {
+        size_t first = i * pages.size() / num_shards;
+        size_t last = (i + 1) * pages.size() / num_shards;
+        shards.push_back(std::make_unique<Shard>(first, last - first, policy_type));
+    }
+}
+
+size_t BufferPool::shardOf(const PageId &pid) const {
+    // Consecutive pages of a file go to consecutive shards, so a scan spreads evenly over all of them
+    return shards.size() == 1 ? 0 : (std::hash<const PageId>()(PageId(pid.file, 0)) + pid.page) % shards.size();
+}
+
+std::optional<size_t> BufferPool::fetch(Shard &shard, const PageId &pid, AccessHint hint, bool pin,
+                                        DbFile *prefetch_file) {
+    std::unique_lock lock(shard.latch);
+    auto claimed = claim(shard, lock, pid, hint, pin, prefetch_file);
+    if (!claimed || !claimed->second) {
+        return claimed ? std::optional(claimed->first) : std::nullopt;
+    }
+
+    // The read happens without the latch so that the rest of the shard is usable
+    size_t pos = claimed->first;
+    DbFile &file = *shard.pos_to_file[pos];
+    lock.unlock();
+    try {
+        auto start = std::chrono::steady_clock::now();
+        file.readPage(pages[shard.first + pos], pid.page);
+        io.recordRead(1, file.getPageSize(), std::chrono::steady_clock::now() - start);
+    } catch (...) {
+        lock.lock();
+        loaded(shard, pos, false, false);
+        throw;
     }
+    lock.lock();
+    loaded(shard, pos, pin, true);
+    return pos;
+}
+
+std::optional<std::pair<size_t, bool>> BufferPool::claim(Shard &shard, std::unique_lock<std::mutex> &lock,
+                                                         const PageId &pid, AccessHint hint, bool pin,
+                                                         DbFile *prefetch_file) {
+    while (true) {
+        // If already in buffer pool, record the access and return it. If another thread is still reading the page
+        // (or writing it out to evict it), wait for that to complete and look again, since the page may be gone
+        auto found = shard.pid_to_pos.find(pid);
+        if (found != shard.pid_to_pos.end()) {
+            size_t pos = found->second;
+            if (shard.loading[pos]) {
+                shard.io_done.wait(lock);
+                continue;
+            }
+            if (prefetch_file == nullptr) {
+                shard.hits++;
+                shard.pos_to_file[pos]->counters.recordHit();
+                shard.policy->touch(pos, hint);
+                shard.prefetched[pos] = false;
+            }
+            if (pin) {
+                shard.pins[pos]++;
+            }
+            return std::pair{pos, false};
+        }
+        if (!shard.available.empty()) {
+            break;
+        }
+
+        // If there are no available pages, evict the page chosen by the policy. Pages read ahead are only evicted
+        // before they are used if nothing else can be, and never to read ahead others
+        auto victim = shard.policy->victim(
+                [&](size_t candidate) { return shard.pins[candidate] == 0 && !shard.prefetched[candidate]; });
+        if (!victim && prefetch_file == nullptr) {
+            victim = shard.policy->victim([&](size_t candidate) { return shard.pins[candidate] == 0; });
+        }
+        if (!victim) {
+            if (prefetch_file != nullptr) {
+                return std::nullopt;
+            }
+            throw std::runtime_error("All pages are pinned");
+        }
+        bool dirty = shard.dirty.contains(*victim);
+        shard.evictions++;
+        shard.dirty_evictions += dirty;
+        shard.pos_to_file[*victim]->counters.recordEviction(dirty);
+        if (!dirty) {
+            evict(shard, *victim);
+            break;
+        }
 
-    // If there are no available pages, evict the least recently used page. If the page is dirty, flush it to disk
-    if (available.empty()) {
-        size_t pos = lru_list.back();
-        const PageId &old_pid = pos_to_pid.at(pos);
-        if (isDirty(old_pid)) {
-            flushPage(old_pid);
+        // A dirty victim is written without the latch, like a read. It stays pinned and loading until the write
+        // completes, and counts as a background write so that flushes wait for it. The page table may change in the
+        // meantime, so the page is looked up again afterwards
+        size_t pos = *victim;
+        DbFile &file = *shard.pos_to_file[pos];
+        size_t page = shard.pos_to_pid[pos].page;
+        shard.dirty.erase(pos);
+        shard.pins[pos]++;
+        shard.loading[pos] = true;
+        shard.writebacks++;
+        lock.unlock();
+        bool written = true;
+        try {
+            auto start = std::chrono::steady_clock::now();
+            file.writePage(pages[shard.first + pos], page);
+            io.recordWrite(1, file.getPageSize(), std::chrono::steady_clock::now() - start);
+        } catch (const std::runtime_error &) {
+            written = false;
+        }
+        lock.lock();
+        shard.pins[pos]--;
+        shard.loading[pos] = false;
+        shard.writebacks--;
+        if (written) {
+            evict(shard, pos);
+        } else {
+            shard.dirty.insert(pos);
         }
-        discardPage(old_pid);
+        shard.io_done.notify_all();
+        if (!written) {
+            throw std::runtime_error("pwrite");
+        }
+    }
+
+    DbFile &file = prefetch_file != nullptr ? *prefetch_file : getDatabase().get(pid.file);
+    if (file.getPageSize() > pages.frameSize()) {
+        throw std::logic_error("The pages of the file are larger than the frames");
+    }
+    if (prefetch_file != nullptr) {
+        shard.prefetches++;
+        file.counters.recordPrefetch();
+    } else {
+        shard.misses++;
+        file.counters.recordMiss();
+    }
+
+    // Claim one of the available slots and start tracking the page. The frame stays pinned while it is read so that
+    // it cannot be chosen as a victim
+    size_t pos = shard.available.back();
+    shard.available.pop_back();
+    shard.pid_to_pos[pid] = pos;
+    shard.pos_to_pid[pos] = pid;
+    shard.pos_to_file[pos] = &file;
+    shard.policy->insert(pos, pid, prefetch_file != nullptr ? AccessHint::SEQUENTIAL : hint);
+    shard.prefetched[pos] = prefetch_file != nullptr;
+    shard.pins[pos]++;
+    shard.loading[pos] = true;
+    if (flusher.joinable() && shard.dirty.size() > dirtyLimit(shard)) {
+        flusher_wake.notify_one();
+    }
+    return std::pair{pos, true};
+}
+
+void BufferPool::loaded(Shard &shard, size_t pos, bool pin, bool success) {
+    shard.loading[pos] = false;
+    if (!success || !pin) {
+        shard.pins[pos]--;
+    }
+    if (!success) {
+        evict(shard, pos);
+    }
+    shard.io_done.notify_all();
+}
+
+IoQueue &BufferPool::ioQueue() {
+    if (!io_queue) {
+        io_queue = makeIoQueue(IO_QUEUE_DEPTH);
+    }
+    return *io_queue;
+}
+
+void BufferPool::evict(Shard &shard, size_t pos) {
+    shard.pid_to_pos.erase(shard.pos_to_pid[pos]);
+    shard.pos_to_pid[pos] = {};
+    shard.pos_to_file[pos] = nullptr;
+    shard.prefetched[pos] = false;
+    shard.policy->erase(pos);
+    shard.dirty.erase(pos);
+    shard.available.push_back(pos);
+}
+
+void BufferPool::flush(Shard &shard, size_t pos) {
+    if (shard.dirty.erase(pos) == 0) {
+        return;
     }
+    auto start = std::chrono::steady_clock::now();
+    DbFile &file = *shard.pos_to_file[pos];
+    file.writePage(pages[shard.first + pos], shard.pos_to_pid[pos].page);
+    io.recordWrite(1, file.getPageSize(), std::chrono::steady_clock::now() - start);
+}
 
-    // Read the page from disk to one of the available slots, make it the most recent page
-    size_t pos = available.back();
-    available.pop_back();
+void BufferPool::unpin(size_t shard, size_t pos, bool dirty) {
+    Shard &s = *shards[shard];
+    std::lock_guard lock(s.latch);
+    if (dirty) {
+        s.dirty.insert(pos);
+    }
+    s.pins[pos]--;
+}
 
-    Page &page = pages[pos];
-    getDatabase().get(pid.file).readPage(page, pid.page);
-    pid_to_pos[pid] = pos;
-    pos_to_pid[pos] = pid;
+Page &BufferPool::getPage(const PageId &pid, AccessHint hint) {
+    // TODO pa0
+    Shard &shard = *shards[shardOf(pid)];
+    size_t pos = *fetch(shard, pid, hint, false);
+    if (readahead_pages != 0) {
+        detectSequential(pid, hint);
+    }
+    return pages[shard.first + pos];
+}
 
-    lru_list.push_front(pos);
-    pos_to_lru[pos] = lru_list.begin();
+PageGuard BufferPool::pinPage(const PageId &pid, PageIntent intent, AccessHint hint) {
+    size_t index = shardOf(pid);
+    Shard &shard = *shards[index];
+    size_t pos = *fetch(shard, pid, hint, true);
+    if (readahead_pages != 0) {
+        detectSequential(pid, hint);
+    }
+    return {this, index, pos, &pages[shard.first + pos], intent == PageIntent::WRITE};
+}
 
-    return page;
+bool BufferPool::isPinned(const PageId &pid) const {
+    const Shard &shard = *shards[shardOf(pid)];
+    std::lock_guard lock(shard.latch);
+    return shard.pins[shard.pid_to_pos.at(pid)] > 0;
 }
 
 void BufferPool::markDirty(const PageId &pid) {
     // TODO pa0
-    size_t pos = pid_to_pos.at(pid);
-    dirty.insert(pos);
+    Shard &shard = *shards[shardOf(pid)];
+    std::lock_guard lock(shard.latch);
+    shard.dirty.insert(shard.pid_to_pos.at(pid));
 }
 
 bool BufferPool::isDirty(const PageId &pid) const {
     // TODO pa0
-    size_t pos = pid_to_pos.at(pid);
-    return dirty.contains(pos);
+    const Shard &shard = *shards[shardOf(pid)];
+    std::lock_guard lock(shard.latch);
+    return shard.dirty.contains(shard.pid_to_pos.at(pid));
 }
 
 bool BufferPool::contains(const PageId &pid) const {
     // TODO pa0
-    return pid_to_pos.contains(pid);
+    const Shard &shard = *shards[shardOf(pid)];
+    std::lock_guard lock(shard.latch);
+    return shard.pid_to_pos.contains(pid);
 }
 
 void BufferPool::discardPage(const PageId &pid) {
     // TODO pa0
-    size_t pos = pid_to_pos.at(pid);
-    pid_to_pos.erase(pid);
-    pos_to_pid[pos] = {};
-
-    lru_list.erase(pos_to_lru[pos]);
-    pos_to_lru.erase(pos);
-    dirty.erase(pos);
-    available.push_back(pos);
+    Shard &shard = *shards[shardOf(pid)];
+    std::lock_guard lock(shard.latch);
+    size_t pos = shard.pid_to_pos.at(pid);
+    if (shard.pins[pos] > 0) {
+        throw std::logic_error("Page is pinned");
+    }
+    evict(shard, pos);
 }
 
 void BufferPool::flushPage(const PageId &pid) {
     // TODO pa0
-    size_t pos = pid_to_pos.at(pid);
-    if (dirty.erase(pos) == 0)
-        return;
-    const Page &page = pages[pos];
-    getDatabase().get(pid.file).writePage(page, pid.page);
+    Shard &shard = *shards[shardOf(pid)];
+    std::unique_lock lock(shard.latch);
+    shard.io_done.wait(lock, [&] { return shard.writebacks == 0; });
+    flush(shard, shard.pid_to_pos.at(pid));
 }
 
-void BufferPool::flushFile(const std::string &file) {
+void BufferPool::flushFile(const std::string &file, bool sync) {
     // TODO pa0
-    std::vector<size_t> to_flush;
-    for (const size_t &pos: dirty) {
-        const PageId &pid = pos_to_pid[pos];
-        if (pid.file == file) {
-            to_flush.emplace_back(pid.page);
+    file_id_t id = getDatabase().getId(file);
+    std::vector<PendingWrite> batch;
+    {
+        auto locks = lockIdleShards();
+        for (size_t i = 0; i < shards.size(); i++) {
+            takeDirty(i, [&](size_t pos) { return shards[i]->pos_to_pid[pos].file == id; }, batch);
+        }
+    }
+    writePending(batch);
+    if (sync) {
+        getDatabase().get(file).sync();
+    }
+}
+
+void BufferPool::flushAll(bool sync) {
+    std::vector<PendingWrite> batch;
+    {
+        auto locks = lockIdleShards();
+        for (size_t i = 0; i < shards.size(); i++) {
+            takeDirty(i, [](size_t) { return true; }, batch);
+        }
+    }
+    writePending(batch);
+    if (sync) {
+        std::unordered_set<const DbFile *> files;
+        for (const PendingWrite &write: batch) {
+            if (files.insert(write.file).second) {
+                write.file->sync();
+            }
+        }
+    }
+}
+
+std::vector<std::unique_lock<std::mutex>> BufferPool::lockIdleShards() {
+    // Background writes must complete before their pages are taken again, or an older copy could land after a newer
+    // one. No latch is held while waiting, and the latches are taken in shard order
+    while (true) {
+        for (const auto &shard: shards) {
+            std::unique_lock lock(shard->latch);
+            shard->io_done.wait(lock, [&] { return shard->writebacks == 0; });
+        }
+        std::vector<std::unique_lock<std::mutex>> locks;
+        for (const auto &shard: shards) {
+            locks.emplace_back(shard->latch);
+        }
+        if (std::all_of(shards.begin(), shards.end(), [](const auto &shard) { return shard->writebacks == 0; })) {
+            return locks;
+        }
+    }
+}
+
+void BufferPool::takeDirty(size_t shard, const std::function<bool(size_t)> &select, std::vector<PendingWrite> &batch) {
+    Shard &s = *shards[shard];
+    std::vector<size_t> chosen;
+    for (const size_t &pos: s.dirty) {
+        if (select(pos)) {
+            chosen.push_back(pos);
+        }
+    }
+    for (const size_t &pos: chosen) {
+        batch.push_back({s.pos_to_file[pos], s.pos_to_pid[pos].page, shard, pos, &pages[s.first + pos]});
+        s.dirty.erase(pos);
+        s.pins[pos]++;
+        s.writebacks++;
+    }
+}
+
+void BufferPool::writePending(std::vector<PendingWrite> &batch) {
+    // Write runs of adjacent pages of the same file with a single request, and keep the requests in flight together
+    std::sort(batch.begin(), batch.end(), [](const PendingWrite &a, const PendingWrite &b) {
+        return std::pair{a.file->getId(), a.page} < std::pair{b.file->getId(), b.page};
+    });
+    std::vector<size_t> run_start;
+    std::vector<uint8_t> failed;
+    std::vector<IoRequest> requests;
+    std::vector<size_t> request_run;
+    for (size_t start = 0, end; start < batch.size(); start = end) {
+        std::vector<const Page *> run{batch[start].data};
+        for (end = start + 1; end < batch.size() && end - start < IOV_MAX && batch[end].file == batch[start].file &&
+                              batch[end].page == batch[end - 1].page + 1; end++) {
+            run.push_back(batch[end].data);
+        }
+        run_start.push_back(start);
+        failed.push_back(false);
+        // Compressed pages have no fixed offset in the file, so they are written here, one by one
+        if (batch[start].file->isCompressed()) {
+            try {
+                auto begin = std::chrono::steady_clock::now();
+                batch[start].file->writePages(run, batch[start].page);
+                io.recordWrite(run.size(), run.size() * batch[start].file->getPageSize(), std::chrono::steady_clock::now() - begin);
+            } catch (const std::runtime_error &) {
+                failed.back() = true;
+            }
+            continue;
+        }
+        request_run.push_back(run_start.size() - 1);
+        requests.push_back(batch[start].file->writeRequest(run, batch[start].page));
+    }
+    run_start.push_back(batch.size());
+    issue(requests, [&](size_t i) {
+        try {
+            batch[run_start[request_run[i]]].file->complete(requests[i]);
+            io.recordWrite(requests[i].buffers.size(), requests[i].result,
+                           std::chrono::steady_clock::now() - requests[i].issued);
+        } catch (const std::runtime_error &) {
+            failed[request_run[i]] = true;
+        }
+    });
+
+    // Pages that could not be written are dirty again, so that they are not lost
+    for (size_t i = 0; i < failed.size(); i++) {
+        for (size_t j = run_start[i]; j < run_start[i + 1]; j++) {
+            const PendingWrite &write = batch[j];
+            Shard &shard = *shards[write.shard];
+            std::lock_guard lock(shard.latch);
+            if (failed[i]) {
+                shard.dirty.insert(write.pos);
+            }
+            shard.pins[write.pos]--;
+            if (--shard.writebacks == 0) {
+                shard.io_done.notify_all();
+            }
+        }
+    }
+    if (std::any_of(failed.begin(), failed.end(), [](uint8_t run_failed) { return run_failed; })) {
+        throw std::runtime_error("pwritev");
+    }
+}
+
+void BufferPool::readPending(DbFile &file, const std::vector<PendingRead> &batch) {
+    // Compressed pages have no fixed offset in the file, so they are read here, one by one
+    if (file.isCompressed()) {
+        bool failed = false;
+        for (const PendingRead &read: batch) {
+            Shard &shard = *shards[read.shard];
+            bool success = true;
+            try {
+                auto start = std::chrono::steady_clock::now();
+                file.readPage(pages[shard.first + read.pos], read.page);
+                io.recordRead(1, file.getPageSize(), std::chrono::steady_clock::now() - start);
+            } catch (const std::runtime_error &) {
+                success = false;
+                failed = true;
+            }
+            std::lock_guard lock(shard.latch);
+            loaded(shard, read.pos, false, success);
+        }
+        if (failed) {
+            throw std::runtime_error("pread");
+        }
+        return;
+    }
+    // Read runs of adjacent pages with a single request, and keep the requests in flight together
+    std::vector<size_t> run_start;
+    std::vector<IoRequest> requests;
+    for (size_t start = 0, end; start < batch.size(); start = end) {
+        std::vector<Page *> run{&pages[shards[batch[start].shard]->first + batch[start].pos]};
+        for (end = start + 1; end < batch.size() && end - start < IOV_MAX &&
+                              batch[end].page == batch[end - 1].page + 1; end++) {
+            run.push_back(&pages[shards[batch[end].shard]->first + batch[end].pos]);
+        }
+        run_start.push_back(start);
+        requests.push_back(file.readRequest(run, batch[start].page));
+    }
+    run_start.push_back(batch.size());
+    bool failed = false;
+    issue(requests, [&](size_t i) {
+        bool success = true;
+        try {
+            file.complete(requests[i]);
+            io.recordRead(requests[i].buffers.size(), requests[i].result,
+                          std::chrono::steady_clock::now() - requests[i].issued);
+        } catch (const std::runtime_error &) {
+            success = false;
+            failed = true;
+        }
+        for (size_t j = run_start[i]; j < run_start[i + 1]; j++) {
+            Shard &shard = *shards[batch[j].shard];
+            std::lock_guard lock(shard.latch);
+            loaded(shard, batch[j].pos, false, success);
+        }
+    });
+    if (failed) {
+        throw std::runtime_error("preadv");
+    }
+}
+
+void BufferPool::issue(std::vector<IoRequest> &requests, const std::function<void(size_t)> &done) {
+    std::lock_guard lock(io_queue_latch);
+    IoQueue &queue = ioQueue();
+    auto complete = [&] { done(queue.wait().tag); };
+    for (size_t i = 0; i < requests.size(); i++) {
+        if (queue.pending() == queue.depth()) {
+            complete();
+        }
+        requests[i].tag = i;
+        queue.prepare(requests[i]);
+    }
+    while (queue.pending() > 0) {
+        complete();
+    }
+}
+
+void BufferPool::discardFile(const std::string &file) {
+    file_id_t id = getDatabase().getId(file);
+    for (const auto &shard: shards) {
+        std::unique_lock lock(shard->latch);
+        shard->io_done.wait(lock, [&] { return shard->writebacks == 0; });
+        std::vector<size_t> to_discard;
+        for (const auto &[pid, pos]: shard->pid_to_pos) {
+            if (pid.file == id) {
+                if (shard->pins[pos] > 0) {
+                    throw std::logic_error("Page is pinned");
+                }
+                to_discard.push_back(pos);
+            }
+        }
+        for (const auto &pos: to_discard) {
+            evict(*shard, pos);
+        }
+    }
+}
+
+size_t BufferPool::size() const { return pages.size(); }
+
+void BufferPool::resize(size_t num_pages, bool huge_pages) {
+    std::unique_lock pause(restructure_latch);
+    rebuild(num_pages, huge_pages, pages.frameSize());
+}
+
+size_t BufferPool::getFrameSize() const { return pages.frameSize(); }
+
+void BufferPool::fitPageSize(size_t page_size) {
+    std::unique_lock pause(restructure_latch);
+    if (page_size > pages.frameSize()) {
+        rebuild(pages.size(), huge_pages, page_size);
+    }
+}
+
+void BufferPool::rebuild(size_t num_pages, bool huge_pages, size_t frame_size) {
+    if (num_pages == 0) {
+        throw std::logic_error("Buffer pool must have at least one page");
+    }
+    if (num_pages < shards.size()) {
+        throw std::logic_error("Buffer pool must have at least one page per shard");
+    }
+    for (const auto &shard: shards) {
+        if (std::any_of(shard->pins.begin(), shard->pins.end(), [](uint32_t count) { return count > 0; })) {
+            throw std::logic_error("Cannot resize while pages are pinned");
+        }
+    }
+
+    FrameArena new_pages(num_pages, huge_pages, frame_size);
+    for (size_t i = 0; i < shards.size(); i++) {
+        Shard &shard = *shards[i];
+        size_t first = i * num_pages / shards.size();
+        size_t num_frames = (i + 1) * num_pages / shards.size() - first;
+
+        // Evict pages until the remaining ones fit in the frames of the shard
+        while (shard.pid_to_pos.size() > num_frames) {
+            size_t pos = *shard.policy->victim([](size_t) { return true; });
+            shard.evictions++;
+            shard.pos_to_file[pos]->counters.recordEviction(shard.dirty.contains(pos));
+            flush(shard, pos);
+            evict(shard, pos);
+        }
+
+        // Move the resident pages to the front of the frames of the shard in the new arena
+        std::vector<PageId> new_pos_to_pid(num_frames);
+        std::vector<DbFile *> new_pos_to_file(num_frames);
+        std::vector<size_t> new_pos(shard.pos_to_pid.size());
+        std::unordered_set<size_t> new_dirty;
+        size_t next_pos = 0;
+        for (auto &[pid, pos]: shard.pid_to_pos) {
+            std::copy_n(pages[shard.first + pos].begin(), shard.pos_to_file[pos]->getPageSize(),
+                        new_pages[first + next_pos].begin());
+            new_pos_to_pid[next_pos] = pid;
+            new_pos_to_file[next_pos] = shard.pos_to_file[pos];
+            if (shard.dirty.contains(pos)) {
+                new_dirty.insert(next_pos);
+            }
+            new_pos[pos] = next_pos;
+            pos = next_pos++;
+        }
+        shard.policy->relocate(new_pos, num_frames);
+
+        shard.first = first;
+        shard.pos_to_pid = std::move(new_pos_to_pid);
+        shard.pos_to_file = std::move(new_pos_to_file);
+        shard.dirty = std::move(new_dirty);
+        shard.pins.assign(num_frames, 0);
+        shard.loading.assign(num_frames, false);
+        shard.prefetched.assign(num_frames, false);
+        shard.available.resize(num_frames - next_pos);
+        std::iota(shard.available.rbegin(), shard.available.rend(), next_pos);
+    }
+    pages = std::move(new_pages);
+    this->huge_pages = huge_pages;
+}
+
+bool BufferPool::usesHugeTlb() const { return pages.isHugeTlb(); }
+
+size_t BufferPool::getNumShards() const { return shards.size(); }
+
+void BufferPool::setNumShards(size_t num_shards) {
+    std::unique_lock pause(restructure_latch);
+    if (num_shards == 0 || num_shards > pages.size()) {
+        throw std::logic_error("Invalid number of shards");
+    }
+    for (const auto &shard: shards) {
+        if (std::any_of(shard->pins.begin(), shard->pins.end(), [](uint32_t count) { return count > 0; })) {
+            throw std::logic_error("Cannot change the number of shards while pages are pinned");
+        }
+    }
+    flushAll();
+    createShards(num_shards);
+}
+
+void BufferPool::setReplacementPolicy(ReplacementPolicyType type) {
+    std::unique_lock pause(restructure_latch);
+    policy_type = type;
+    for (const auto &shard: shards) {
+        shard->policy = makeReplacementPolicy(type, shard->pos_to_pid.size());
+        for (const auto &[pid, pos]: shard->pid_to_pos) {
+            shard->policy->insert(pos, pid, AccessHint::NORMAL);
+        }
+    }
+}
+
+IoMetrics BufferPool::getMetrics() const {
+    IoMetrics metrics = io.snapshot();
+    for (const auto &shard: shards) {
+        std::lock_guard lock(shard->latch);
+        metrics.hits += shard->hits;
+        metrics.misses += shard->misses;
+        metrics.prefetches += shard->prefetches;
+        metrics.evictions += shard->evictions;
+        metrics.dirty_evictions += shard->dirty_evictions;
+    }
+    return metrics;
+}
+
+size_t BufferPool::getHits() const { return getMetrics().hits; }
+
+size_t BufferPool::getMisses() const { return getMetrics().misses; }
+
+size_t BufferPool::getDirtyEvictions() const { return getMetrics().dirty_evictions; }
+
+void BufferPool::resetStats() {
+    for (const auto &shard: shards) {
+        std::lock_guard lock(shard->latch);
+        shard->hits = 0;
+        shard->misses = 0;
+        shard->evictions = 0;
+        shard->dirty_evictions = 0;
+        shard->prefetches = 0;
+    }
+    io.reset();
+}
+
+size_t BufferPool::getPrefetches() const { return getMetrics().prefetches; }
+
+size_t BufferPool::dirtyLimit(const Shard &shard) const {
+    return static_cast<size_t>(static_cast<double>(shard.pos_to_pid.size()) * (1 - flusher_config.clean_ratio));
+}
+
+void BufferPool::startFlusher(const FlusherConfig &config) {
+    if (config.clean_ratio < 0 || config.clean_ratio > 1 || config.max_batch == 0) {
+        throw std::logic_error("Invalid flusher configuration");
+    }
+    stopFlusher();
+    flusher_config = config;
+    flusher = std::thread(&BufferPool::runFlusher, this);
+}
+
+void BufferPool::stopFlusher() {
+    if (!flusher.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard lock(flusher_latch);
+        flusher_stop = true;
+    }
+    flusher_wake.notify_one();
+    flusher.join();
+    flusher_stop = false;
+}
+
+bool BufferPool::isFlusherRunning() const { return flusher.joinable(); }
+
+void BufferPool::runFlusher() {
+    std::unique_lock lock(flusher_latch);
+    while (!flusher_stop) {
+        try {
+            writeBack();
+        } catch (const std::runtime_error &) {
+            // The pages that could not be written are dirty again and are retried on the next pass
+        }
+        flusher_wake.wait_for(lock, flusher_config.interval);
+    }
+}
+
+void BufferPool::writeBack() {
+    // Copy dirty pages until every shard is back to its share of clean frames. The copies are taken under the latch,
+    // so they are consistent, and the frames stay pinned until they are written so that they cannot be evicted and
+    // read back from disk before the write lands
+    std::shared_lock work(restructure_latch);
+    std::vector<PendingWrite> batch;
+    // Page aligned, so that files with direct I/O can write the copies as they are
+    FrameArena copies(flusher_config.max_batch, false, pages.frameSize());
+    for (size_t i = 0; i < shards.size() && batch.size() < flusher_config.max_batch; i++) {
+        Shard &shard = *shards[i];
+        std::lock_guard lock(shard.latch);
+        size_t limit = dirtyLimit(shard);
+        std::vector<size_t> chosen;
+        for (const size_t &pos: shard.dirty) {
+            bool enough = shard.dirty.size() - chosen.size() <= limit;
+            if (enough || batch.size() + chosen.size() >= flusher_config.max_batch) {
+                break;
+            }
+            if (shard.pins[pos] == 0) {
+                chosen.push_back(pos);
+            }
+        }
+        for (const size_t &pos: chosen) {
+            Page &copy = copies[batch.size()];
+            std::copy_n(pages[shard.first + pos].begin(), shard.pos_to_file[pos]->getPageSize(), copy.begin());
+            batch.push_back({shard.pos_to_file[pos], shard.pos_to_pid[pos].page, i, pos, &copy});
+            shard.dirty.erase(pos);
+            shard.pins[pos]++;
+            shard.writebacks++;
+        }
+    }
+    writePending(batch);
+}
+
+PageGuard::PageGuard(BufferPool *pool, size_t shard, size_t pos, Page *page, bool dirty)
+    : pool(pool), shard(shard), pos(pos), page(page), dirty(dirty) {}
+
+PageGuard::~PageGuard() { release(); }
+
+PageGuard::PageGuard(PageGuard &&other) noexcept
+    : pool(std::exchange(other.pool, nullptr)), shard(other.shard), pos(other.pos), page(std::exchange(other.page, nullptr)),
+      dirty(other.dirty) {}
+
+PageGuard &PageGuard::operator=(PageGuard &&other) noexcept {
+    if (this != &other) {
+        release();
+        pool = std::exchange(other.pool, nullptr);
+        shard = other.shard;
+        pos = other.pos;
+        page = std::exchange(other.page, nullptr);
+        dirty = other.dirty;
+    }
+    return *this;
+}
+
+void PageGuard::markDirty() { dirty = true; }
+
+void PageGuard::release() {
+    if (pool != nullptr) {
+        pool->unpin(shard, pos, dirty);
+        pool = nullptr;
+        page = nullptr;
+    }
+}
+
+void BufferPool::setReadAhead(size_t num_pages) {
+    if (readahead_worker.joinable()) {
+        {
+            std::lock_guard lock(readahead_latch);
+            readahead_stop = true;
+        }
+        readahead_wake.notify_one();
+        readahead_worker.join();
+        readahead_stop = false;
+        readahead_queue.clear();
+    }
+    readahead_pages = num_pages;
+    if (num_pages != 0) {
+        readahead_worker = std::thread(&BufferPool::runReadAhead, this);
+    }
+}
+
+size_t BufferPool::getReadAhead() const { return readahead_pages; }
+
+void BufferPool::prefetch(const PageId &pid, size_t count) {
+    if (readahead_pages != 0) {
+        enqueueReadAhead({&getDatabase().get(pid.file), pid.page, count});
+    }
+}
+
+void BufferPool::detectSequential(const PageId &pid, AccessHint hint) {
+    ReadAheadStream &stream = streams[pid.file % streams.size()];
+    std::unique_lock lock(stream.latch);
+    if (stream.file == pid.file && stream.chain) {
+        // The pages of the file are read through a chain
+        return;
+    }
+    bool same = stream.file == pid.file;
+    if (same && pid.page == stream.last) {
+        return;
+    }
+    bool continues = same && pid.page == stream.last + 1;
+    if (!continues) {
+        stream.file = pid.file;
+        stream.chain = false;
+        stream.ahead = pid.page;
+    }
+    stream.last = pid.page;
+    // Without a hint, a scan is only recognized from its second page on
+    if (!continues && hint != AccessHint::SEQUENTIAL) {
+        return;
+    }
+    // Keep between half and all of the read-ahead distance requested ahead of the scan
+    if (stream.ahead > pid.page + readahead_pages / 2) {
+        return;
+    }
+    size_t first = std::max(stream.ahead, pid.page) + 1;
+    stream.ahead = pid.page + readahead_pages;
+    size_t count = stream.ahead + 1 - first;
+    lock.unlock();
+    enqueueReadAhead({&getDatabase().get(pid.file), first, count});
+}
+
+void BufferPool::readAheadChain(const PageId &pid, std::function<std::optional<size_t>(const Page &)> next) {
+    if (readahead_pages == 0) {
+        return;
+    }
+    ReadAheadStream &stream = streams[pid.file % streams.size()];
+    std::unique_lock lock(stream.latch);
+    bool same = stream.file == pid.file && stream.chain;
+    if (same && !stream.window.empty() && stream.window.front() == pid.page) {
+        stream.window.pop_front();
+    } else if (!same || !stream.window.empty() || stream.tail != pid.page) {
+        // The scan is not where the stream expects it: start over from here
+        stream.file = pid.file;
+        stream.chain = true;
+        stream.window.clear();
+        stream.tail = pid.page;
+        stream.pending = 0;
+        stream.generation++;
+    }
+    size_t requested = stream.window.size() + stream.pending;
+    if (requested > readahead_pages / 2) {
+        return;
+    }
+    size_t count = readahead_pages - requested;
+    stream.pending += count;
+    ReadAheadRequest request{&getDatabase().get(pid.file), 0, count, &stream, stream.generation, std::move(next)};
+    lock.unlock();
+    enqueueReadAhead(std::move(request));
+}
+
+void BufferPool::cancelReadAhead(const DbFile &file) {
+    std::unique_lock lock(readahead_latch);
+    std::erase_if(readahead_queue, [&](const ReadAheadRequest &request) { return request.file == &file; });
+    readahead_done.wait(lock, [&] { return readahead_current != &file; });
+}
+
+void BufferPool::enqueueReadAhead(ReadAheadRequest request) {
+    {
+        std::lock_guard lock(readahead_latch);
+        readahead_queue.push_back(std::move(request));
+    }
+    readahead_wake.notify_one();
+}
+
+void BufferPool::runReadAhead() {
+    std::unique_lock lock(readahead_latch);
+    while (true) {
+        readahead_wake.wait(lock, [&] { return readahead_stop || !readahead_queue.empty(); });
+        if (readahead_stop) {
+            return;
+        }
+        ReadAheadRequest request = std::move(readahead_queue.front());
+        readahead_queue.pop_front();
+        readahead_current = request.file;
+        lock.unlock();
+        try {
+            readAhead(request);
+        } catch (const std::exception &) {
+            // Read-ahead is best effort: the scan reads the page itself if it is needed
+        }
+        lock.lock();
+        readahead_current = nullptr;
+        readahead_done.notify_all();
+    }
+}
+
+void BufferPool::readAhead(const ReadAheadRequest &request) {
+    std::shared_lock work(restructure_latch);
+    file_id_t file = request.file->getId();
+    if (request.stream == nullptr) {
+        // Claim frames for all the pages first, then read them together
+        std::vector<PendingRead> batch;
+        size_t end = std::min(request.first + request.count, request.file->getNumPages());
+        for (size_t page = request.first; page < end; page++) {
+            PageId pid(file, page);
+            size_t index = shardOf(pid);
+            Shard &shard = *shards[index];
+            std::unique_lock lock(shard.latch);
+            auto claimed = claim(shard, lock, pid, AccessHint::SEQUENTIAL, false, request.file);
+            if (!claimed) {
+                break;
+            }
+            if (claimed->second) {
+                batch.push_back({index, claimed->first, page});
+            }
+        }
+        readPending(*request.file, batch);
+        return;
+    }
+
+    // Follow the chain from the last page requested, reading every page to find the next one
+    ReadAheadStream &stream = *request.stream;
+    std::unique_lock lock(stream.latch);
+    if (stream.generation != request.generation) {
+        return;
+    }
+    PageId pid(file, stream.tail);
+    lock.unlock();
+    size_t done = 0;
+    for (; done < request.count; done++) {
+        size_t index = shardOf(pid);
+        auto pos = fetch(*shards[index], pid, AccessHint::SEQUENTIAL, true, request.file);
+        if (!pos) {
+            break;
+        }
+        std::optional<size_t> next = request.next(pages[shards[index]->first + *pos]);
+        unpin(index, *pos, false);
+        if (!next) {
+            break;
+        }
+        pid.page = *next;
+        if (!fetch(*shards[shardOf(pid)], pid, AccessHint::SEQUENTIAL, false, request.file)) {
+            break;
+        }
+        lock.lock();
+        if (stream.generation != request.generation) {
+            return;
         }
+        stream.window.push_back(pid.page);
+        stream.tail = pid.page;
+        stream.pending--;
+        lock.unlock();
     }
-    for (const auto &page: to_flush) {
-        flushPage({file, page});
+    lock.lock();
+    if (stream.generation == request.generation) {
+        stream.pending -= request.count - done;
     }
 }
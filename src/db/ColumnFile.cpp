@@ -0,0 +1,380 @@
+#include <db/ColumnFile.hpp>
+#include <db/Database.hpp>
+#include <db/FrameArena.hpp>
+#include <db/HeapPage.hpp>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+using namespace db;
+
+// Every page of a column starts with this header; a page with no rows is empty
+struct ColumnPageHeader {
+    uint64_t first_row;
+    uint32_t field;
+    uint32_t rows;
+    // The bytes of values after the header, and the offset of the last value among them
+    uint32_t used;
+    uint32_t last;
+    uint16_t encoding;
+};
+
+// The number of rows of a value of a RUN_LENGTH column, which precedes the value
+using Run = uint32_t;
+
+// Returns the bytes of values a column page of a page size holds
+static size_t valuesSize(size_t page_size) { return page_size - sizeof(ColumnPageHeader); }
+
+// The rows that ColumnFile::visit reads from a column before it releases its page and goes on to the next column
+static constexpr size_t VISIT_ROWS = 1024;
+
+// Returns the size of a value once it is encoded for a column page
+static size_t encodedSize(type_t type, const field_t &value) {
+    return type == type_t::VARCHAR ? sizeof(uint16_t) + std::get<std::string>(value).size() : fieldSize(type);
+}
+
+// Encodes a value as it is stored in a column page, and returns its size
+static size_t encodeValue(uint8_t *out, type_t type, const field_t &value) {
+    uint16_t end = 0;
+    switch (type) {
+        case type_t::INT:
+            FieldCodec<type_t::INT>::encode(out, out, value, end);
+            break;
+        case type_t::DOUBLE:
+            FieldCodec<type_t::DOUBLE>::encode(out, out, value, end);
+            break;
+        case type_t::CHAR:
+            FieldCodec<type_t::CHAR>::encode(out, out, value, end);
+            break;
+        case type_t::VARCHAR: {
+            const std::string &v = std::get<std::string>(value);
+            auto length = static_cast<uint16_t>(v.size());
+            std::memcpy(out, &length, sizeof(length));
+            std::memcpy(out + sizeof(length), v.data(), length);
+            return sizeof(length) + length;
+        }
+    }
+    return fieldSize(type);
+}
+
+// Returns the size of a value stored in a column page
+static size_t storedSize(const uint8_t *value, type_t type) {
+    if (type != type_t::VARCHAR) {
+        return fieldSize(type);
+    }
+    uint16_t length;
+    std::memcpy(&length, value, sizeof(length));
+    return sizeof(length) + length;
+}
+
+struct ColumnFile::Cursor {
+    const ColumnFile &file;
+    const std::vector<Segment> &segments;
+    const type_t type;
+    const size_t offset;
+    const bool runs;
+    // The segment of the current page, its rows, and the offset in the page of the value that holds the rows from row
+    // to row + run; the page stays pinned until it is released
+    size_t segment = 0;
+    PageGuard page;
+    size_t first_row = 0;
+    size_t end_row = 0;
+    size_t entry = 0;
+    size_t row = 0;
+    size_t run = 0;
+
+    Cursor(const ColumnFile &file, size_t field)
+        : file(file), segments(file.columns[field]), type(file.td.field_type(field)), offset(file.td.offset_of(field)),
+          runs(file.encodings[field] == ColumnEncoding::RUN_LENGTH) {}
+
+    size_t runOf(const uint8_t *value) const {
+        if (!runs) {
+            return 1;
+        }
+        Run count;
+        std::memcpy(&count, value, sizeof(count));
+        return count;
+    }
+
+    // Returns the stored value of a row, which is not before the row of the last call; the page is pinned until the
+    // next call that moves to another page, or until it is released
+    const uint8_t *seek(size_t target) {
+        if (target >= end_row) {
+            // Rows that are skipped do not pin the pages between them
+            auto next = std::upper_bound(segments.begin() + segment, segments.end(), target,
+                                         [](size_t r, const Segment &s) { return r < s.first_row; });
+            segment = next - segments.begin() - 1;
+            page = file.readGuard(segments[segment].page, AccessHint::SEQUENTIAL);
+            const auto *header = reinterpret_cast<const ColumnPageHeader *>(page->data());
+            first_row = row = header->first_row;
+            end_row = first_row + header->rows;
+            entry = sizeof(ColumnPageHeader);
+            run = runOf(page->data() + entry);
+        } else if (!page) {
+            // The position in a released page is kept, and the page is pinned again
+            page = file.readGuard(segments[segment].page, AccessHint::SEQUENTIAL);
+        }
+        const uint8_t *data = page->data();
+        if (!runs && type != type_t::VARCHAR) {
+            return data + sizeof(ColumnPageHeader) + (target - first_row) * fieldSize(type);
+        }
+        size_t header = runs ? sizeof(Run) : 0;
+        while (target >= row + run) {
+            entry += header + storedSize(data + entry + header, type);
+            row += run;
+            run = runOf(data + entry);
+        }
+        return data + entry + header;
+    }
+
+    void release() { page.release(); }
+};
+
+ColumnFile::ColumnFile(const std::string &name, const TupleDesc &td, const std::vector<ColumnEncoding> &encodings,
+                       size_t page_size)
+    : DbFile(name, td, page_size),
+      encodings(encodings.empty() ? std::vector<ColumnEncoding>(td.size(), ColumnEncoding::PLAIN) : encodings),
+      columns(td.size()) {
+    if (this->encodings.size() != td.size()) {
+        throw std::logic_error("Encodings and fields sizes do not match");
+    }
+    // Each column fills its pages in order, so the pages of a column are found in the order of their rows
+    FrameArena buffer(1, false, getPageSize());
+    Page &page = buffer[0];
+    for (size_t i = 0; i < numPages; i++) {
+        readPage(page, i);
+        ColumnPageHeader header;
+        std::memcpy(&header, page.data(), sizeof(header));
+        if (header.rows == 0) {
+            spare = spare.value_or(i);
+            continue;
+        }
+        if (header.field >= td.size()) {
+            throw std::runtime_error("Page of an unknown column");
+        }
+        if (header.encoding != static_cast<uint16_t>(this->encodings[header.field])) {
+            throw std::runtime_error("Column stored with another encoding");
+        }
+        columns[header.field].push_back({i, header.first_row});
+        if (header.field == 0) {
+            numRows = header.first_row + header.rows;
+        }
+    }
+}
+
+void ColumnFile::append(size_t field, const field_t &value) {
+    type_t type = td.field_type(field);
+    bool runs = encodings[field] == ColumnEncoding::RUN_LENGTH;
+    encoded.resize(std::max(encoded.size(), encodedSize(type, value)));
+    uint8_t *bytes = encoded.data();
+    size_t size = encodeValue(bytes, type, value);
+    size_t entry = (runs ? sizeof(Run) : 0) + size;
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    std::vector<Segment> &segments = columns[field];
+    if (!segments.empty()) {
+        PageGuard p = bufferPool.pinPage({id, segments.back().page});
+        auto *header = reinterpret_cast<ColumnPageHeader *>(p->data());
+        uint8_t *values = p->data() + sizeof(ColumnPageHeader);
+        if (runs) {
+            // A value equal to the last one extends its run, even on a full page
+            uint8_t *last = values + header->last;
+            Run run;
+            std::memcpy(&run, last, sizeof(run));
+            if (run < UINT32_MAX && storedSize(last + sizeof(run), type) == size &&
+                std::memcmp(last + sizeof(run), bytes, size) == 0) {
+                run++;
+                std::memcpy(last, &run, sizeof(run));
+                header->rows++;
+                p.markDirty();
+                return;
+            }
+        }
+        if (header->used + entry <= valuesSize(getPageSize())) {
+            if (runs) {
+                Run run = 1;
+                std::memcpy(values + header->used, &run, sizeof(run));
+            }
+            std::memcpy(values + header->used + entry - size, bytes, size);
+            header->last = header->used;
+            header->used += entry;
+            header->rows++;
+            p.markDirty();
+            return;
+        }
+    }
+    size_t page = spare ? *std::exchange(spare, std::nullopt) : appendPage();
+    PageGuard np = bufferPool.pinPage({id, page}, PageIntent::WRITE);
+    auto *header = reinterpret_cast<ColumnPageHeader *>(np->data());
+    *header = {numRows, static_cast<uint32_t>(field), 1, static_cast<uint32_t>(entry), 0,
+               static_cast<uint16_t>(encodings[field])};
+    uint8_t *values = np->data() + sizeof(ColumnPageHeader);
+    if (runs) {
+        Run run = 1;
+        std::memcpy(values, &run, sizeof(run));
+    }
+    std::memcpy(values + entry - size, bytes, size);
+    segments.push_back({page, numRows});
+}
+
+void ColumnFile::insertTuple(const Tuple &t) {
+    if (!td.compatible(t)) {
+        throw std::runtime_error("Tuple not compatible with TupleDesc");
+    }
+    if (td.length(t) > maxRecordSize(getPageSize())) {
+        throw std::runtime_error("Tuple does not fit in a page");
+    }
+    for (size_t i = 0; i < td.size(); i++) {
+        if (td.field_type(i) == type_t::VARCHAR &&
+            (encodings[i] == ColumnEncoding::RUN_LENGTH ? sizeof(Run) : 0) + sizeof(uint16_t) +
+                    std::get<std::string>(t.get_field(i)).size() > valuesSize(getPageSize())) {
+            throw std::runtime_error("Tuple does not fit in a page");
+        }
+    }
+    checkWritable();
+    std::unique_lock lock(latch);
+    for (size_t i = 0; i < td.size(); i++) {
+        append(i, t.get_field(i));
+    }
+    numRows++;
+}
+
+void ColumnFile::visit(const std::vector<size_t> &fields, const size_t *rows, size_t count,
+                       const std::function<void(const TupleView &)> &f) const {
+    std::vector<size_t> read(fields);
+    std::sort(read.begin(), read.end());
+    read.erase(std::unique(read.begin(), read.end()), read.end());
+    std::vector<Cursor> cursors;
+    cursors.reserve(read.size());
+    for (size_t field : read) {
+        cursors.emplace_back(*this, field);
+    }
+    // The rows are read VISIT_ROWS at a time, a column after the other, and each column releases its page before the
+    // next one is pinned, so that no more pages are pinned than there are frames however many columns are read; a
+    // single column keeps its page until it moves on. The fields that are read are copied into the record of their
+    // row, and the bytes of their VARCHARs aside
+    size_t length = td.length();
+    size_t batch = std::min(count, VISIT_ROWS);
+    std::vector<uint8_t> records(batch * length);
+    std::vector<std::vector<uint8_t>> strings(batch);
+    std::vector<uint8_t> record(std::max(length, maxRecordSize(getPageSize())));
+    for (size_t first = 0; first < count; first += batch) {
+        batch = std::min(count - first, VISIT_ROWS);
+        for (size_t i = 0; i < batch; i++) {
+            strings[i].clear();
+        }
+        for (Cursor &cursor : cursors) {
+            for (size_t i = 0; i < batch; i++) {
+                const uint8_t *value = cursor.seek(rows != nullptr ? rows[first + i] : first + i);
+                uint8_t *field = records.data() + i * length + cursor.offset;
+                if (cursor.type != type_t::VARCHAR) {
+                    std::memcpy(field, value, fieldSize(cursor.type));
+                    continue;
+                }
+                uint16_t size;
+                std::memcpy(&size, value, sizeof(size));
+                auto end = static_cast<uint16_t>(length + strings[i].size());
+                std::memcpy(field, &end, sizeof(end));
+                std::memcpy(field + sizeof(end), &size, sizeof(size));
+                strings[i].insert(strings[i].end(), value + sizeof(size), value + sizeof(size) + size);
+            }
+            if (cursors.size() > 1) {
+                cursor.release();
+            }
+        }
+        // A record without VARCHARs is passed as it is; one with VARCHARs is followed by their bytes
+        for (size_t i = 0; i < batch; i++) {
+            if (strings[i].empty()) {
+                f(TupleView(td, records.data() + i * length));
+                continue;
+            }
+            std::memcpy(record.data(), records.data() + i * length, length);
+            std::copy(strings[i].begin(), strings[i].end(), record.begin() + length);
+            f(TupleView(td, record.data()));
+        }
+    }
+}
+
+size_t ColumnFile::rowOf(const Iterator &it) const {
+    const std::vector<Segment> &segments = columns[0];
+    auto segment = std::lower_bound(segments.begin(), segments.end(), it.page,
+                                    [](const Segment &s, size_t page) { return s.page < page; });
+    size_t end_row = segment != segments.end() && segment + 1 != segments.end() ? segment[1].first_row : numRows.load();
+    if (segment == segments.end() || segment->page != it.page || segment->first_row + it.slot >= end_row) {
+        throw std::runtime_error("Out of index");
+    }
+    return segment->first_row + it.slot;
+}
+
+Tuple ColumnFile::getTuple(const Iterator &it) const {
+    std::shared_lock lock(latch);
+    size_t row = rowOf(it);
+    std::vector<size_t> fields(td.size());
+    std::iota(fields.begin(), fields.end(), 0);
+    std::optional<Tuple> t;
+    visit(fields, &row, 1, [&](const TupleView &view) { t = view.materialize(); });
+    return *t;
+}
+
+void ColumnFile::scan(const std::function<void(const TupleView &)> &f) const {
+    std::vector<size_t> fields(td.size());
+    std::iota(fields.begin(), fields.end(), 0);
+    std::shared_lock lock(latch);
+    visit(fields, nullptr, numRows, f);
+}
+
+void ColumnFile::scanColumns(const std::vector<size_t> &fields, const std::function<void(const TupleView &)> &f) const {
+    std::shared_lock lock(latch);
+    visit(fields, nullptr, numRows, f);
+}
+
+void ColumnFile::scanColumns(const std::vector<size_t> &fields, std::span<const size_t> rows,
+                             const std::function<void(const TupleView &)> &f) const {
+    std::shared_lock lock(latch);
+    if (!rows.empty() && rows.back() >= numRows) {
+        throw std::runtime_error("Out of index");
+    }
+    visit(fields, rows.data(), rows.size(), f);
+}
+
+bool ColumnFile::supportsRowFetch() const { return true; }
+
+size_t ColumnFile::getNumRows() const { return numRows; }
+
+ColumnEncoding ColumnFile::getEncoding(size_t field) const { return encodings.at(field); }
+
+size_t ColumnFile::getColumnPages(size_t field) const {
+    std::shared_lock lock(latch);
+    return columns.at(field).size();
+}
+
+void ColumnFile::next(Iterator &it) const {
+    std::shared_lock lock(latch);
+    const std::vector<Segment> &segments = columns[0];
+    auto segment = std::lower_bound(segments.begin(), segments.end(), it.page,
+                                    [](const Segment &s, size_t page) { return s.page < page; });
+    if (segment != segments.end() && segment->page == it.page) {
+        size_t end_row = segment + 1 != segments.end() ? segment[1].first_row : numRows.load();
+        if (segment->first_row + ++it.slot < end_row) {
+            return;
+        }
+        if (++segment != segments.end()) {
+            it.page = segment->page;
+            it.slot = 0;
+            return;
+        }
+    }
+    it.page = numPages;
+    it.slot = 0;
+}
+
+Iterator ColumnFile::begin() const {
+    std::shared_lock lock(latch);
+    if (numRows == 0) {
+        return end();
+    }
+    return {*this, columns[0].front().page, 0};
+}
+
+Iterator ColumnFile::end() const { return {*this, numPages, 0}; }
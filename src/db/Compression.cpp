@@ -0,0 +1,166 @@
+#include <db/Compression.hpp>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+using namespace db;
+
+// The shortest back reference, and the number of bits of the hash table of 4-byte prefixes
+static constexpr size_t MIN_MATCH = 4;
+static constexpr size_t HASH_BITS = 12;
+// A sequence starts with a token: the literal length in the high nibble and the match length minus MIN_MATCH in the
+// low nibble; 15 means that more length bytes follow, each 255 meaning that yet another byte follows
+static constexpr size_t RUN_MASK = 15;
+
+static uint32_t read32(const uint8_t *p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static size_t hashOf(uint32_t prefix) { return (prefix * 2654435761u) >> (32 - HASH_BITS); }
+
+namespace {
+    // Appends to the output buffer and remembers whether anything did not fit
+    struct Writer {
+        uint8_t *out;
+        uint8_t *end;
+        bool overflow = false;
+
+        void byte(uint8_t value) {
+            if (out == end) {
+                overflow = true;
+                return;
+            }
+            *out++ = value;
+        }
+
+        void length(size_t extra) {
+            for (; extra >= 255; extra -= 255) {
+                byte(255);
+            }
+            byte(static_cast<uint8_t>(extra));
+        }
+
+        void bytes(const uint8_t *src, size_t count) {
+            if (static_cast<size_t>(end - out) < count) {
+                overflow = true;
+                return;
+            }
+            std::memcpy(out, src, count);
+            out += count;
+        }
+
+        void sequence(const uint8_t *literals, size_t num_literals, size_t distance, size_t match) {
+            size_t match_code = match == 0 ? 0 : match - MIN_MATCH;
+            byte(static_cast<uint8_t>(std::min(num_literals, RUN_MASK) << 4 | std::min(match_code, RUN_MASK)));
+            if (num_literals >= RUN_MASK) {
+                length(num_literals - RUN_MASK);
+            }
+            bytes(literals, num_literals);
+            if (match == 0) {
+                return;
+            }
+            byte(static_cast<uint8_t>(distance));
+            byte(static_cast<uint8_t>(distance >> 8));
+            if (match_code >= RUN_MASK) {
+                length(match_code - RUN_MASK);
+            }
+        }
+    };
+}
+
+size_t db::compress(const uint8_t *src, size_t size, uint8_t *dst, size_t capacity) {
+    if (size > 65536) {
+        throw std::logic_error("Block is too large to compress");
+    }
+    Writer writer{dst, dst + capacity};
+    // Positions fit in 16 bits; an empty slot reads as position 0, which is checked like any other candidate
+    std::array<uint16_t, 1 << HASH_BITS> table{};
+    size_t anchor = 0;
+    size_t pos = 0;
+    while (pos + MIN_MATCH <= size && !writer.overflow) {
+        uint32_t prefix = read32(src + pos);
+        uint16_t &slot = table[hashOf(prefix)];
+        size_t candidate = slot;
+        slot = static_cast<uint16_t>(pos);
+        if (candidate < pos && read32(src + candidate) == prefix) {
+            size_t match = MIN_MATCH;
+            while (pos + match < size && src[candidate + match] == src[pos + match]) {
+                match++;
+            }
+            writer.sequence(src + anchor, pos - anchor, pos - candidate, match);
+            pos += match;
+            anchor = pos;
+        } else {
+            // Skip faster and faster through data that does not compress
+            pos += 1 + ((pos - anchor) >> 5);
+        }
+    }
+    // The block always ends with a sequence of literals, possibly empty
+    writer.sequence(src + anchor, size - anchor, 0, 0);
+    return writer.overflow ? 0 : writer.out - dst;
+}
+
+[[noreturn]] static void corrupt() { throw std::runtime_error("Corrupt compressed block"); }
+
+void db::decompress(const uint8_t *src, size_t size, uint8_t *dst, size_t capacity) {
+    const uint8_t *in = src;
+    const uint8_t *in_end = src + size;
+    uint8_t *out = dst;
+    uint8_t *out_end = dst + capacity;
+    auto length = [&](size_t value) {
+        if (value == RUN_MASK) {
+            uint8_t extra;
+            do {
+                if (in == in_end) {
+                    corrupt();
+                }
+                extra = *in++;
+                value += extra;
+            } while (extra == 255);
+        }
+        return value;
+    };
+    while (true) {
+        if (in == in_end) {
+            corrupt();
+        }
+        uint8_t token = *in++;
+        size_t num_literals = length(token >> 4);
+        if (static_cast<size_t>(in_end - in) < num_literals || static_cast<size_t>(out_end - out) < num_literals) {
+            corrupt();
+        }
+        std::memcpy(out, in, num_literals);
+        in += num_literals;
+        out += num_literals;
+        // The last sequence has no back reference
+        if (in == in_end) {
+            break;
+        }
+        if (in_end - in < 2) {
+            corrupt();
+        }
+        size_t distance = in[0] | in[1] << 8;
+        in += 2;
+        size_t match = length(token & RUN_MASK) + MIN_MATCH;
+        if (distance == 0 || distance > static_cast<size_t>(out - dst) ||
+            static_cast<size_t>(out_end - out) < match) {
+            corrupt();
+        }
+        const uint8_t *ref = out - distance;
+        if (distance >= match) {
+            std::memcpy(out, ref, match);
+        } else {
+            // The reference overlaps the bytes being produced, which repeats the last distance bytes
+            for (size_t i = 0; i < match; i++) {
+                out[i] = ref[i];
+            }
+        }
+        out += match;
+    }
+    if (out != out_end) {
+        corrupt();
+    }
+}
@@ -2,29 +2,54 @@
 
 using namespace db;
 
+// The configuration of the singleton, and whether it was constructed already
+static DatabaseConfig config;
+static bool constructed = false;
+
+Database::Database(const DatabaseConfig &config) : bufferPool(config.num_pages, config.huge_pages) {
+    constructed = true;
+}
+
 BufferPool &Database::getBufferPool() { return bufferPool; }
 
 Database &db::getDatabase() {
-    static Database instance;
+    static Database instance(config);
     return instance;
 }
 
+void db::configureDatabase(const DatabaseConfig &config) {
+    if (constructed) {
+        throw std::logic_error("The database is already constructed");
+    }
+    ::config = config;
+}
+
 void Database::add(std::unique_ptr<DbFile> file) {
     // TODO pa0
     const std::string &name = file->getName();
     if (files.contains(name)) {
         throw std::logic_error("File already exists");
     }
+    if (ids.size() >= size_t{1} << PageId::FILE_BITS) {
+        throw std::runtime_error("Too many files");
+    }
+    bufferPool.fitPageSize(file->getPageSize());
+    file->id = ids.size();
+    ids.push_back(file.get());
     files[name] = std::move(file);
 }
 
 std::unique_ptr<DbFile> Database::remove(const std::string &name) {
     // TODO pa0
-    auto nh = files.extract(name);
-    if (nh.empty()) {
+    if (!files.contains(name)) {
         throw std::logic_error("File does not exist");
     }
-    Database::getBufferPool().flushFile(nh.key());
+    // Flush while the file is still registered: writing a page back looks the file up by name
+    Database::getBufferPool().cancelReadAhead(*files.at(name));
+    Database::getBufferPool().flushFile(name);
+    Database::getBufferPool().discardFile(name);
+    auto nh = files.extract(name);
+    ids[nh.mapped()->getId()] = nullptr;
     return std::move(nh.mapped());
 }
 
@@ -32,3 +57,7 @@ DbFile &Database::get(const std::string &name) const {
     // TODO pa0
     return *files.at(name);
 }
+
+file_id_t Database::getId(const std::string &name) const { return get(name).getId(); }
+
+PageId::PageId(const std::string &file, size_t page) : PageId(getDatabase().getId(file), page) {}
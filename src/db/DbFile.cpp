@@ -1,17 +1,68 @@
+#include <db/Compression.hpp>
+#include <db/Database.hpp>
 #include <db/DbFile.hpp>
+#include <db/FrameArena.hpp>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
 #include <stdexcept>
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/xattr.h>
 #include <unistd.h>
 
 using namespace db;
 
+// Pages of a mapped file past the end of the file read as zeros, like they do with pread
+static const Page zero_page{};
+
+// The extended attribute that records the page size a file was written with
+static const char *const page_size_attribute = "user.db.page_size";
+
+// A compressed file starts with a header, followed by the slots of the pages; each slot starts with its own header
+struct FileHeader {
+    char magic[8];
+    uint32_t page_size;
+    uint32_t reserved;
+};
+
+struct SlotHeader {
+    uint64_t page;
+    uint32_t size;
+    uint32_t capacity;
+};
+
+static constexpr char compressed_magic[8] = {'d', 'b', 'p', 'a', 'g', 'e', 'z', '1'};
+
+static bool isAligned(const Page *page) {
+    return reinterpret_cast<uintptr_t>(page->data()) % DIRECT_IO_ALIGNMENT == 0;
+}
+
+// The aligned buffer that a thread reads and writes unaligned pages of files with direct I/O through. It is only
+// mapped once a thread needs it, and only the bytes of the pages it holds are touched
+static Page &bounceBuffer() {
+    static thread_local FrameArena bounce(1, false);
+    return bounce[0];
+}
+
 const TupleDesc &DbFile::getTupleDesc() const { return td; }
 
-DbFile::DbFile(const std::string &name, const TupleDesc &td) : name(name), td(td) {
+DbFile::DbFile(const std::string &name, const TupleDesc &td, size_t page_size)
+    : page_size(page_size), name(name), td(td) {
     // TODO pa1: open file and initialize numPages
     // Hint: use open, fstat
+    if (!validPageSize(page_size)) {
+        throw std::logic_error("The page size must be a power of two from MIN_PAGE_SIZE to MAX_PAGE_SIZE");
+    }
     fd = open(name.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fd == -1) {
+        // A file on a read-only directory or medium can still be scanned
+        fd = open(name.c_str(), O_RDONLY);
+    }
     if (fd == -1) {
         throw std::runtime_error("open");
     }
@@ -19,38 +70,566 @@ DbFile::DbFile(const std::string &name, const TupleDesc &td) : name(name), td(td
     if (fstat(fd, &st) == -1) {
         throw std::runtime_error("fstat");
     }
-    numPages = st.st_size / DEFAULT_PAGE_SIZE;
+    uint32_t recorded = page_size;
+    if (st.st_size == 0) {
+        // Only a new file records its page size. A file without the attribute, written by an older build or on a file
+        // system without extended attributes, is assumed to use the page size it is opened with
+        fsetxattr(fd, page_size_attribute, &recorded, sizeof(recorded), 0);
+    } else if (fgetxattr(fd, page_size_attribute, &recorded, sizeof(recorded)) == sizeof(recorded)) {
+        if (!validPageSize(recorded)) {
+            close(fd);
+            throw std::runtime_error("The file was written with an unsupported page size");
+        }
+        this->page_size = recorded;
+    }
+    bool is_compressed;
+    try {
+        is_compressed = loadSlots(st.st_size);
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+    numPages = is_compressed ? slots.size() : st.st_size / this->page_size;
     if (numPages == 0) {
         numPages = 1;
     }
+    // Space allocated ahead by an earlier run is used before more is allocated
+    allocated_pages = std::max<size_t>((st.st_size + this->page_size - 1) / this->page_size,
+                                       st.st_blocks * 512 / this->page_size);
 }
 
 DbFile::~DbFile() {
     // TODO pa1: close file
     // Hind: use close
+    unmap();
     close(fd);
 }
 
+bool DbFile::loadSlots(size_t file_size) {
+    FileHeader header{};
+    if (file_size < sizeof(header) || pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+        std::memcmp(header.magic, compressed_magic, sizeof(header.magic)) != 0) {
+        return false;
+    }
+    // The header records the page size, also on file systems without extended attributes
+    if (!validPageSize(header.page_size)) {
+        throw std::runtime_error("The file was written with an unsupported page size");
+    }
+    page_size = header.page_size;
+    // A page that outgrows its slot moves to the end of the file, so the last slot of a page is the current one. A
+    // slot torn at the end of the file ends the scan, and is overwritten by the next page that moves
+    uint64_t offset = sizeof(header);
+    SlotHeader slot{};
+    while (offset + sizeof(slot) <= file_size && pread(fd, &slot, sizeof(slot), offset) == sizeof(slot)) {
+        if (slot.size == 0 || slot.size > page_size || slot.capacity < sizeof(slot) + slot.size ||
+            slot.capacity % COMPRESSED_SLOT_SIZE != 0 || offset + sizeof(slot) + slot.size > file_size) {
+            break;
+        }
+        if (slot.page >= slots.size()) {
+            slots.resize(slot.page + 1);
+        }
+        slots[slot.page] = {offset, slot.size, slot.capacity};
+        offset += slot.capacity;
+    }
+    file_end = offset;
+    compressed = true;
+    return true;
+}
+
+void DbFile::map(AccessHint hint) {
+    if (mapped) {
+        return;
+    }
+    if (compressed) {
+        throw std::logic_error("A compressed file cannot be mapped");
+    }
+    if (id != 0) {
+        BufferPool &bufferPool = getDatabase().getBufferPool();
+        bufferPool.flushFile(name);
+        bufferPool.discardFile(name);
+    }
+    struct stat st{};
+    if (fstat(fd, &st) == -1) {
+        throw std::runtime_error("fstat");
+    }
+    // Pages past the end of the file are not mapped, since accessing them would raise SIGBUS
+    size_t pages = st.st_size / page_size;
+    if (pages != 0) {
+        void *ptr = mmap(nullptr, pages * page_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (ptr == MAP_FAILED) {
+            throw std::runtime_error("mmap");
+        }
+        madvise(ptr, pages * page_size, hint == AccessHint::SEQUENTIAL ? MADV_SEQUENTIAL : MADV_NORMAL);
+        mapping = static_cast<const uint8_t *>(ptr);
+    }
+    mapped_pages = pages;
+    mapped = true;
+}
+
+void DbFile::unmap() {
+    if (mapping != nullptr) {
+        munmap(const_cast<uint8_t *>(mapping), mapped_pages * page_size);
+    }
+    mapped = false;
+    mapping = nullptr;
+    mapped_pages = 0;
+}
+
+bool DbFile::isMapped() const { return mapped; }
+
+PageGuard DbFile::readGuard(size_t page, AccessHint hint) const {
+    if (!mapped) {
+        return getDatabase().getBufferPool().pinPage({id, page}, PageIntent::READ, hint);
+    }
+    if (page >= numPages) {
+        throw std::logic_error("Page is out of range");
+    }
+    if (page >= mapped_pages) {
+        return {nullptr, 0, 0, const_cast<Page *>(&zero_page), false};
+    }
+    // Keep the kernel reading one window ahead of a scan
+    if (hint == AccessHint::SEQUENTIAL && page % MAPPED_READAHEAD == 0) {
+        size_t count = std::min(2 * MAPPED_READAHEAD, mapped_pages - page);
+        madvise(const_cast<uint8_t *>(mapping + page * page_size), count * page_size, MADV_WILLNEED);
+    }
+    // The page views only write to pages that are modified, which a mapped file refuses, and any write would fault
+    auto *data = const_cast<uint8_t *>(mapping + page * page_size);
+    return {nullptr, 0, 0, reinterpret_cast<Page *>(data), false};
+}
+
+void DbFile::checkWritable() const {
+    if (mapped) {
+        throw std::logic_error("File is mapped read-only");
+    }
+}
+
+bool DbFile::getAttribute(const char *attribute, void *value, size_t size) const {
+    return fgetxattr(fd, attribute, value, size) == static_cast<ssize_t>(size);
+}
+
+void DbFile::setAttribute(const char *attribute, const void *value, size_t size) const {
+    fsetxattr(fd, attribute, value, size, 0);
+}
+
+// Copies the extended attributes of a file to the file that replaces it
+static void copyAttributes(int from, int to) {
+    ssize_t size = flistxattr(from, nullptr, 0);
+    if (size <= 0) {
+        return;
+    }
+    std::vector<char> names(size);
+    size = flistxattr(from, names.data(), names.size());
+    for (ssize_t i = 0; i < size; i += std::strlen(&names[i]) + 1) {
+        ssize_t length = fgetxattr(from, &names[i], nullptr, 0);
+        if (length < 0) {
+            continue;
+        }
+        std::vector<char> value(length);
+        length = fgetxattr(from, &names[i], value.data(), value.size());
+        if (length >= 0) {
+            fsetxattr(to, &names[i], value.data(), length, 0);
+        }
+    }
+}
+
+void DbFile::setDirectIo(bool enable) {
+    if (enable == direct) {
+        return;
+    }
+    if (compressed) {
+        throw std::logic_error("Direct I/O needs uncompressed pages");
+    }
+    int flags = fcntl(fd, F_GETFL);
+    if (flags == -1 || fcntl(fd, F_SETFL, enable ? flags | O_DIRECT : flags & ~O_DIRECT) == -1) {
+        throw std::runtime_error("fcntl");
+    }
+    if (enable) {
+        // Only clean pages can be dropped from the page cache
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    }
+    direct = enable;
+}
+
+bool DbFile::isDirectIo() const { return direct; }
+
+void DbFile::setCompression(bool enable) {
+    if (enable == compressed) {
+        return;
+    }
+    checkWritable();
+    if (direct) {
+        throw std::logic_error("Direct I/O needs uncompressed pages");
+    }
+    if (id != 0) {
+        getDatabase().getBufferPool().flushFile(name);
+    }
+    // Copy the pages to a temporary file in the new format, then put it in place of the file
+    std::string temp = name + ".tmp";
+    std::remove(temp.c_str());
+    DbFile converted(temp, td, page_size);
+    try {
+        if (enable) {
+            FileHeader header{{}, static_cast<uint32_t>(page_size), 0};
+            std::memcpy(header.magic, compressed_magic, sizeof(header.magic));
+            if (pwrite(converted.fd, &header, sizeof(header), 0) != sizeof(header)) {
+                throw std::runtime_error("pwrite");
+            }
+            converted.compressed = true;
+            converted.file_end = sizeof(header);
+        }
+        FrameArena buffer(1, false, page_size);
+        for (size_t i = 0; i < numPages; i++) {
+            readPage(buffer[0], i);
+            converted.writePage(buffer[0], i);
+        }
+        converted.sync();
+        copyAttributes(fd, converted.fd);
+        if (rename(temp.c_str(), name.c_str()) == -1) {
+            throw std::runtime_error("rename");
+        }
+    } catch (...) {
+        std::remove(temp.c_str());
+        throw;
+    }
+    // The temporary file object closes the old descriptor
+    std::swap(fd, converted.fd);
+    compressed = enable;
+    slots = std::move(converted.slots);
+    file_end = converted.file_end;
+    allocated_pages = enable ? 0 : numPages.load();
+}
+
+bool DbFile::isCompressed() const { return compressed; }
+
+size_t DbFile::getStoredSize() const {
+    struct stat st{};
+    if (fstat(fd, &st) == -1) {
+        throw std::runtime_error("fstat");
+    }
+    return st.st_size;
+}
+
 const std::string &DbFile::getName() const { return name; }
 
+size_t DbFile::getPageSize() const { return page_size; }
+
+file_id_t DbFile::getId() const { return id; }
+
+void DbFile::trace(std::vector<size_t> &entries, size_t id, size_t count) const {
+    if (trace_limit.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    std::lock_guard lock(trace_latch);
+    for (size_t i = 0; i < count && entries.size() < trace_limit; i++) {
+        entries.push_back(id + i);
+    }
+}
+
+size_t DbFile::appendPage() {
+    size_t page = numPages++;
+    reserve(page + 1);
+    return page;
+}
+
+void DbFile::reserve(size_t pages) {
+    if (pages <= allocated_pages || compressed || extent_size == 0) {
+        return;
+    }
+    std::lock_guard lock(extent_latch);
+    size_t first = allocated_pages;
+    if (pages <= first) {
+        return;
+    }
+    // Extents start at multiples of the extent size, so that files that grow together do not interleave
+    size_t extent_pages = extent_size / page_size;
+    size_t end = ((pages - 1) / extent_pages + 1) * extent_pages;
+    // Without support for fallocate, the file grows as its pages are written; the next extent tries again
+    fallocate(fd, FALLOC_FL_KEEP_SIZE, first * page_size, (end - first) * page_size);
+    allocated_pages = end;
+}
+
+void DbFile::truncate(size_t pages) {
+    checkWritable();
+    if (compressed) {
+        throw std::logic_error("A compressed file cannot be truncated");
+    }
+    if (id != 0) {
+        BufferPool &bufferPool = getDatabase().getBufferPool();
+        for (size_t page = pages; page < numPages; page++) {
+            if (bufferPool.contains({id, page})) {
+                bufferPool.flushPage({id, page});
+                bufferPool.discardPage({id, page});
+            }
+        }
+    }
+    if (ftruncate(fd, pages * page_size) == -1) {
+        throw std::runtime_error("ftruncate");
+    }
+    // Truncating also frees the space allocated ahead
+    std::lock_guard lock(extent_latch);
+    allocated_pages = pages;
+    numPages = std::max<size_t>(pages, 1);
+}
+
+void DbFile::setExtentSize(size_t bytes) {
+    if (bytes % page_size != 0) {
+        throw std::logic_error("Extents must be whole pages");
+    }
+    std::lock_guard lock(extent_latch);
+    extent_size = bytes;
+}
+
+size_t DbFile::getExtentSize() const { return extent_size; }
+
+size_t DbFile::getAllocatedSize() const {
+    struct stat st{};
+    if (fstat(fd, &st) == -1) {
+        throw std::runtime_error("fstat");
+    }
+    return st.st_blocks * 512;
+}
+
+void DbFile::readCompressed(Page &page, size_t id) const {
+    // Grown to the largest page size the thread reads
+    static thread_local std::vector<uint8_t> buffer;
+    if (buffer.size() < page_size) {
+        buffer.resize(page_size);
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::shared_lock lock(slot_latch);
+    PageSlot slot = id < slots.size() ? slots[id] : PageSlot{};
+    if (slot.capacity == 0) {
+        // A page that was never written reads as zeros, like a page past the end of an uncompressed file
+        std::fill_n(page.begin(), page_size, 0);
+        counters.recordRead(1, 0, std::chrono::steady_clock::now() - start);
+        return;
+    }
+    ssize_t bytes = pread(fd, buffer.data(), slot.size, slot.offset + sizeof(SlotHeader));
+    if (bytes != slot.size) {
+        throw std::runtime_error("pread");
+    }
+    lock.unlock();
+    if (slot.size == page_size) {
+        std::memcpy(page.data(), buffer.data(), page_size);
+    } else {
+        decompress(buffer.data(), slot.size, page.data(), page_size);
+    }
+    counters.recordRead(1, bytes, std::chrono::steady_clock::now() - start);
+}
+
+void DbFile::writeCompressed(const Page &page, size_t id) const {
+    static thread_local std::vector<uint8_t> buffer;
+    if (buffer.size() < sizeof(SlotHeader) + page_size) {
+        buffer.resize(sizeof(SlotHeader) + page_size);
+    }
+    auto start = std::chrono::steady_clock::now();
+    uint8_t *data = buffer.data() + sizeof(SlotHeader);
+    // A page that does not shrink is stored as is
+    size_t size = compress(page.data(), page_size, data, page_size - 1);
+    if (size == 0) {
+        std::memcpy(data, page.data(), page_size);
+        size = page_size;
+    }
+    size_t capacity = (sizeof(SlotHeader) + size + COMPRESSED_SLOT_SIZE - 1) / COMPRESSED_SLOT_SIZE *
+                      COMPRESSED_SLOT_SIZE;
+
+    std::unique_lock lock(slot_latch);
+    PageSlot slot = id < slots.size() ? slots[id] : PageSlot{};
+    bool moved = capacity > slot.capacity;
+    if (moved) {
+        slot.offset = file_end;
+        slot.capacity = capacity;
+        file_end += capacity;
+    }
+    slot.size = size;
+    SlotHeader header{id, slot.size, slot.capacity};
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    ssize_t bytes = pwrite(fd, buffer.data(), sizeof(header) + size, slot.offset);
+    if (bytes != static_cast<ssize_t>(sizeof(header) + size)) {
+        // Give the new slot back, so that no gap is left that would end the scan of the slots
+        if (moved) {
+            file_end = slot.offset;
+        }
+        throw std::runtime_error("pwrite");
+    }
+    if (id >= slots.size()) {
+        slots.resize(id + 1);
+    }
+    slots[id] = slot;
+    lock.unlock();
+    counters.recordWrite(1, bytes, std::chrono::steady_clock::now() - start);
+}
+
 void DbFile::readPage(Page &page, const size_t id) const {
-    reads.push_back(id);
+    trace(reads, id, 1);
+    if (compressed) {
+        readCompressed(page, id);
+        return;
+    }
     // TODO pa1: read page
     // Hint: use pread
-    std::fill(page.begin(), page.end(), 0);
-    pread(fd, page.data(), DEFAULT_PAGE_SIZE, id * DEFAULT_PAGE_SIZE);
+    Page &buffer = direct && !isAligned(&page) ? bounceBuffer() : page;
+    std::fill_n(buffer.begin(), page_size, 0);
+    auto start = std::chrono::steady_clock::now();
+    ssize_t bytes = pread(fd, buffer.data(), page_size, id * page_size);
+    if (bytes == -1) {
+        throw std::runtime_error("pread");
+    }
+    if (&buffer != &page) {
+        std::copy_n(buffer.begin(), page_size, page.begin());
+    }
+    // A page past the end of the file reads as zeros, and so does the rest of a short page at the end of the file
+    counters.recordRead(1, bytes, std::chrono::steady_clock::now() - start);
 }
 
 void DbFile::writePage(const Page &page, const size_t id) const {
-    writes.push_back(id);
+    trace(writes, id, 1);
+    if (compressed) {
+        writeCompressed(page, id);
+        return;
+    }
     // TODO pa1: write page
     // Hint: use pwrite
-    pwrite(fd, page.data(), DEFAULT_PAGE_SIZE, id * DEFAULT_PAGE_SIZE);
+    const Page *buffer = &page;
+    if (direct && !isAligned(buffer)) {
+        Page &bounce = bounceBuffer();
+        std::copy_n(page.begin(), page_size, bounce.begin());
+        buffer = &bounce;
+    }
+    auto start = std::chrono::steady_clock::now();
+    ssize_t bytes = pwrite(fd, buffer->data(), page_size, id * page_size);
+    if (bytes != static_cast<ssize_t>(page_size)) {
+        throw std::runtime_error("pwrite");
+    }
+    counters.recordWrite(1, bytes, std::chrono::steady_clock::now() - start);
 }
 
-const std::vector<size_t> &DbFile::getReads() const { return reads; }
+void DbFile::writePages(const std::vector<const Page *> &pages, size_t id) const {
+    trace(writes, id, pages.size());
+    if (compressed) {
+        for (size_t i = 0; i < pages.size(); i++) {
+            writeCompressed(*pages[i], id + i);
+        }
+        return;
+    }
+    std::vector<iovec> iov(pages.size());
+    for (size_t i = 0; i < pages.size(); i++) {
+        iov[i] = {const_cast<uint8_t *>(pages[i]->data()), page_size};
+    }
+    FrameArena bounce;
+    if (direct && !std::all_of(pages.begin(), pages.end(), isAligned)) {
+        bounce = FrameArena(pages.size(), false, page_size);
+        for (size_t i = 0; i < pages.size(); i++) {
+            std::copy_n(pages[i]->begin(), page_size, bounce[i].begin());
+            iov[i].iov_base = bounce[i].data();
+        }
+    }
+    for (size_t i = 0; i < iov.size(); i += IOV_MAX) {
+        int count = static_cast<int>(std::min<size_t>(IOV_MAX, iov.size() - i));
+        auto start = std::chrono::steady_clock::now();
+        ssize_t bytes = pwritev(fd, iov.data() + i, count, (id + i) * page_size);
+        if (bytes != static_cast<ssize_t>(count * page_size)) {
+            throw std::runtime_error("pwritev");
+        }
+        counters.recordWrite(count, bytes, std::chrono::steady_clock::now() - start);
+    }
+}
+
+IoRequest DbFile::readRequest(const std::vector<Page *> &pages, size_t id) const {
+    if (pages.empty() || pages.size() > IOV_MAX) {
+        throw std::logic_error("Invalid number of pages");
+    }
+    if (direct && !std::all_of(pages.begin(), pages.end(), isAligned)) {
+        throw std::logic_error("Direct I/O needs aligned pages");
+    }
+    if (compressed) {
+        throw std::logic_error("Compressed pages have no fixed offset in the file");
+    }
+    trace(reads, id, pages.size());
+    IoRequest request;
+    request.op = IoRequest::READ;
+    request.fd = fd;
+    request.offset = static_cast<off_t>(id * page_size);
+    for (Page *page: pages) {
+        std::fill_n(page->begin(), page_size, 0);
+        request.buffers.push_back({page->data(), page_size});
+    }
+    return request;
+}
+
+IoRequest DbFile::writeRequest(const std::vector<const Page *> &pages, size_t id) const {
+    if (pages.empty() || pages.size() > IOV_MAX) {
+        throw std::logic_error("Invalid number of pages");
+    }
+    if (direct && !std::all_of(pages.begin(), pages.end(), isAligned)) {
+        throw std::logic_error("Direct I/O needs aligned pages");
+    }
+    if (compressed) {
+        throw std::logic_error("Compressed pages have no fixed offset in the file");
+    }
+    trace(writes, id, pages.size());
+    IoRequest request;
+    request.op = IoRequest::WRITE;
+    request.fd = fd;
+    request.offset = static_cast<off_t>(id * page_size);
+    for (const Page *page: pages) {
+        request.buffers.push_back({const_cast<uint8_t *>(page->data()), page_size});
+    }
+    return request;
+}
+
+void DbFile::complete(const IoRequest &request) const {
+    size_t pages = request.buffers.size();
+    auto latency = std::chrono::steady_clock::now() - request.issued;
+    if (request.op == IoRequest::READ) {
+        if (request.result < 0) {
+            throw std::runtime_error("preadv");
+        }
+        counters.recordRead(pages, request.result, latency);
+    } else {
+        if (request.result != static_cast<ssize_t>(request.size())) {
+            throw std::runtime_error("pwritev");
+        }
+        counters.recordWrite(pages, request.result, latency);
+    }
+}
 
-const std::vector<size_t> &DbFile::getWrites() const { return writes; }
+void DbFile::sync() const {
+    if (fdatasync(fd) == -1) {
+        throw std::runtime_error("fdatasync");
+    }
+}
+
+const std::vector<size_t> &DbFile::getReads() const {
+    std::lock_guard lock(trace_latch);
+    return reads;
+}
+
+const std::vector<size_t> &DbFile::getWrites() const {
+    std::lock_guard lock(trace_latch);
+    return writes;
+}
+
+void DbFile::setTraceLimit(size_t limit) {
+    std::lock_guard lock(trace_latch);
+    trace_limit = limit;
+    for (auto *entries: {&reads, &writes}) {
+        if (entries->size() > limit) {
+            entries->resize(limit);
+            entries->shrink_to_fit();
+        }
+    }
+}
+
+IoMetrics DbFile::getMetrics() const { return counters.snapshot(); }
+
+void DbFile::resetMetrics() {
+    counters.reset();
+    std::lock_guard lock(trace_latch);
+    reads.clear();
+    writes.clear();
+}
 
 void DbFile::insertTuple(const Tuple &t) { throw std::runtime_error("Not implemented"); }
 
@@ -58,6 +637,37 @@ void DbFile::deleteTuple(const Iterator &it) { throw std::runtime_error("Not imp
 
 Tuple DbFile::getTuple(const Iterator &it) const { throw std::runtime_error("Not implemented"); }
 
+TupleView DbFile::getView(const Iterator &it, PageGuard &page) const { throw std::runtime_error("Not implemented"); }
+
+void DbFile::scan(const std::function<void(const TupleView &)> &f) const {
+    PageGuard page;
+    for (Iterator it = begin(); it != end(); next(it)) {
+        f(getView(it, page));
+    }
+}
+
+void DbFile::scanColumns(const std::vector<size_t> &, const std::function<void(const TupleView &)> &f) const {
+    scan(f);
+}
+
+void DbFile::scanColumns(const std::vector<size_t> &fields, std::span<const size_t> rows,
+                         const std::function<void(const TupleView &)> &f) const {
+    size_t row = 0;
+    size_t next = 0;
+    scanColumns(fields, [&](const TupleView &t) {
+        if (next < rows.size() && rows[next] == row) {
+            f(t);
+            next++;
+        }
+        row++;
+    });
+    if (next < rows.size()) {
+        throw std::runtime_error("Out of index");
+    }
+}
+
+bool DbFile::supportsRowFetch() const { return false; }
+
 void DbFile::next(Iterator &it) const { throw std::runtime_error("Not implemented"); }
 
 Iterator DbFile::begin() const { throw std::runtime_error("Not implemented"); }
@@ -0,0 +1,70 @@
+#include <db/FrameArena.hpp>
+#include <stdexcept>
+#include <utility>
+#include <sys/mman.h>
+
+using namespace db;
+
+FrameArena::FrameArena(size_t num_frames, bool huge_pages, size_t frame_size)
+    : num_frames(num_frames), frame_size(frame_size) {
+    if (!validPageSize(frame_size)) {
+        throw std::logic_error("Invalid frame size");
+    }
+    if (num_frames == 0) {
+        return;
+    }
+    bytes = num_frames * frame_size;
+    void *memory = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (huge_pages) {
+        size_t rounded = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        memory = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED) {
+            bytes = rounded;
+            hugetlb = true;
+        }
+    }
+#endif
+    if (memory == MAP_FAILED) {
+        memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            throw std::runtime_error("mmap");
+        }
+#ifdef MADV_HUGEPAGE
+        if (huge_pages) {
+            madvise(memory, bytes, MADV_HUGEPAGE);
+        }
+#endif
+    }
+    frames = static_cast<uint8_t *>(memory);
+}
+
+FrameArena::~FrameArena() {
+    if (frames != nullptr) {
+        munmap(frames, bytes);
+    }
+}
+
+FrameArena::FrameArena(FrameArena &&other) noexcept
+    : frames(std::exchange(other.frames, nullptr)), num_frames(std::exchange(other.num_frames, 0)),
+      frame_size(other.frame_size), bytes(std::exchange(other.bytes, 0)), hugetlb(std::exchange(other.hugetlb, false)) {}
+
+FrameArena &FrameArena::operator=(FrameArena &&other) noexcept {
+    if (this != &other) {
+        if (frames != nullptr) {
+            munmap(frames, bytes);
+        }
+        frames = std::exchange(other.frames, nullptr);
+        num_frames = std::exchange(other.num_frames, 0);
+        frame_size = other.frame_size;
+        bytes = std::exchange(other.bytes, 0);
+        hugetlb = std::exchange(other.hugetlb, false);
+    }
+    return *this;
+}
+
+size_t FrameArena::size() const { return num_frames; }
+
+size_t FrameArena::frameSize() const { return frame_size; }
+
+bool FrameArena::isHugeTlb() const { return hugetlb; }
@@ -1,58 +1,373 @@
 #include <db/Database.hpp>
+#include <db/FrameArena.hpp>
 #include <db/HeapFile.hpp>
 #include <db/HeapPage.hpp>
+#include <algorithm>
+#include <bit>
 #include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace db;
 
-HeapFile::HeapFile(const std::string &name, const TupleDesc &td) : DbFile(name, td) {}
+// The extended attribute that records the layout of the pages of a file
+static const char *const layout_attribute = "user.db.layout";
+
+HeapFile::HeapFile(const std::string &name, const TupleDesc &td, PageLayout layout, size_t page_size)
+    : DbFile(name, td, page_size), layout(layout) {
+    if (layout == PageLayout::PAX && !td.fixed()) {
+        throw std::logic_error("PAX pages need fixed-size fields");
+    }
+    // Only a new file records its layout, like its page size. A file without the attribute is assumed to use the
+    // layout it is opened with
+    const uint8_t requested = static_cast<uint8_t>(layout);
+    uint8_t recorded = requested;
+    if (getStoredSize() == 0) {
+        setAttribute(layout_attribute, &recorded, sizeof(recorded));
+    } else if (getAttribute(layout_attribute, &recorded, sizeof(recorded)) && recorded != requested) {
+        throw std::runtime_error("The file was written with another page layout");
+    }
+    // A file on a read-only directory or medium keeps its map in memory, read from the map file if there is one
+    std::string fsm_name = name + ".fsm";
+    fsm_fd = open(fsm_name.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    bool writable = fsm_fd != -1;
+    if (!writable) {
+        fsm_fd = open(fsm_name.c_str(), O_RDONLY);
+    }
+    struct stat st{};
+    if (fsm_fd != -1 && fstat(fsm_fd, &st) == -1) {
+        close(fsm_fd);
+        throw std::runtime_error("fstat");
+    }
+    free_pages.resize((numPages + 63) / 64);
+    if (getStoredSize() == 0) {
+        // A new file starts with one empty page; a map left over from an earlier file of the same name is dropped
+        free_pages[0] = 1;
+        if (writable && (ftruncate(fsm_fd, 0) == -1 || pwrite(fsm_fd, free_pages.data(), sizeof(uint64_t), 0) == -1)) {
+            close(fsm_fd);
+            throw std::runtime_error("pwrite");
+        }
+    } else if (st.st_size == 0) {
+        // Rebuild the map of a file that has none
+        FrameArena buffer(1, false, getPageSize());
+        Page &page = buffer[0];
+        for (size_t i = 0; i < numPages; i++) {
+            readPage(page, i);
+            if (!HeapPage(page, td, layout, getPageSize()).full()) {
+                free_pages[i / 64] |= uint64_t{1} << i % 64;
+            }
+        }
+        if (writable && pwrite(fsm_fd, free_pages.data(), free_pages.size() * sizeof(uint64_t), 0) == -1) {
+            close(fsm_fd);
+            throw std::runtime_error("pwrite");
+        }
+    } else {
+        size_t size = std::min<size_t>(st.st_size, free_pages.size() * sizeof(uint64_t));
+        if (pread(fsm_fd, free_pages.data(), size, 0) == -1) {
+            close(fsm_fd);
+            throw std::runtime_error("pread");
+        }
+        // Pages past the end of the file are not in the map
+        if (numPages % 64 != 0) {
+            free_pages.back() &= (uint64_t{1} << numPages % 64) - 1;
+        }
+    }
+    if (!writable && fsm_fd != -1) {
+        close(fsm_fd);
+        fsm_fd = -1;
+    }
+}
+
+HeapFile::~HeapFile() {
+    if (fsm_fd != -1) {
+        try {
+            writeMap();
+        } catch (const std::runtime_error &) {
+            // The map is a hint, so a failed write only costs space that is not reused
+        }
+        close(fsm_fd);
+    }
+}
+
+void HeapFile::writeMap() const {
+    std::lock_guard lock(space_latch);
+    if (fsm_fd == -1) {
+        dirty_words.clear();
+        return;
+    }
+    auto it = dirty_words.begin();
+    while (it != dirty_words.end()) {
+        size_t first = *it;
+        size_t last = first;
+        auto end = std::next(it);
+        while (end != dirty_words.end() && *end == last + 1) {
+            last = *end;
+            ++end;
+        }
+        size_t size = (last - first + 1) * sizeof(uint64_t);
+        if (pwrite(fsm_fd, free_pages.data() + first, size, first * sizeof(uint64_t)) != static_cast<ssize_t>(size)) {
+            throw std::runtime_error("pwrite");
+        }
+        it = dirty_words.erase(it, end);
+    }
+}
+
+void HeapFile::sync() const {
+    writeMap();
+    DbFile::sync();
+}
+
+std::optional<size_t> HeapFile::findFree() {
+    std::lock_guard lock(space_latch);
+    while (first_free < free_pages.size() && free_pages[first_free] == 0) {
+        first_free++;
+    }
+    if (first_free == free_pages.size()) {
+        return std::nullopt;
+    }
+    return first_free * 64 + std::countr_zero(free_pages[first_free]);
+}
+
+void HeapFile::setFree(size_t page, bool free) {
+    std::lock_guard lock(space_latch);
+    size_t word = page / 64;
+    if (word >= free_pages.size()) {
+        free_pages.resize(word + 1);
+    }
+    uint64_t value = free ? free_pages[word] | uint64_t{1} << page % 64 : free_pages[word] & ~(uint64_t{1} << page % 64);
+    if (value == free_pages[word]) {
+        return;
+    }
+    free_pages[word] = value;
+    if (free) {
+        first_free = std::min(first_free, word);
+    }
+    dirty_words.insert(word);
+}
+
+size_t HeapFile::freeHint(size_t page) {
+    std::lock_guard lock(space_latch);
+    return page < free_slots.size() ? free_slots[page] : 0;
+}
+
+void HeapFile::setFreeHint(size_t page, size_t slot) {
+    std::lock_guard lock(space_latch);
+    if (page >= free_slots.size()) {
+        free_slots.resize(page + 1);
+    }
+    free_slots[page] = static_cast<uint16_t>(slot);
+}
 
 void HeapFile::insertTuple(const Tuple &t) {
     // TODO pa1
     if (!td.compatible(t)) {
         throw std::runtime_error("Tuple not compatible with TupleDesc");
     }
+    if (td.length(t) > maxRecordSize(getPageSize())) {
+        throw std::runtime_error("Tuple does not fit in a page");
+    }
+    checkWritable();
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    std::lock_guard lock(append_latch);
+    // Fill the pages the free-space map points to first; a page that turns out to be full is taken off the map
+    while (std::optional<size_t> page = findFree()) {
+        PageGuard p = bufferPool.pinPage({id, *page});
+        HeapPage hp(*p, td, layout, getPageSize(), freeHint(*page));
+        bool inserted = hp.insertTuple(t);
+        setFreeHint(*page, hp.freeHint());
+        if (!inserted || hp.full()) {
+            setFree(*page, false);
+        }
+        if (inserted) {
+            p.markDirty();
+            return;
+        }
+    }
+    PageId pid{id, appendPage()};
+    PageGuard np = bufferPool.pinPage(pid, PageIntent::WRITE);
+    HeapPage nhp(*np, td, layout, getPageSize());
+    nhp.insertTuple(t);
+    setFreeHint(pid.page, nhp.freeHint());
+    setFree(pid.page, !nhp.full());
+}
+
+void HeapFile::bulkInsert(std::span<const Tuple> tuples) {
+    if (!std::all_of(tuples.begin(), tuples.end(), [&](const Tuple &t) { return td.compatible(t); })) {
+        throw std::runtime_error("Tuple not compatible with TupleDesc");
+    }
+    size_t max_record = maxRecordSize(getPageSize());
+    if (!std::all_of(tuples.begin(), tuples.end(), [&](const Tuple &t) { return td.length(t) <= max_record; })) {
+        throw std::runtime_error("Tuple does not fit in a page");
+    }
+    checkWritable();
+    BufferPool &bufferPool = getDatabase().getBufferPool();
+    std::lock_guard lock(append_latch);
+    size_t next = 0;
+    {
+        size_t last = numPages - 1;
+        PageGuard p = bufferPool.pinPage({id, last});
+        HeapPage hp(*p, td, layout, getPageSize(), freeHint(last));
+        while (next < tuples.size() && hp.insertTuple(tuples[next])) {
+            next++;
+        }
+        if (next > 0) {
+            p.markDirty();
+        }
+        setFreeHint(last, hp.freeHint());
+        setFree(last, !hp.full());
+    }
+
+    // Full pages are written straight to the file; they are past the end, so the pool holds none of them. How many
+    // tuples a page takes is only known once it is filled, so the last page is filled before it is found partial.
+    // The pages of a run are only added to the file once they are written: a concurrent scan would otherwise cache
+    // them empty, and keep them so after the write.
+    FrameArena buffers(BULK_LOAD_PAGES, false, getPageSize());
+    std::vector<const Page *> run;
+    const Page *partial = nullptr;
+    size_t partial_hint = 0;
+    auto publish = [&] {
+        size_t first = numPages;
+        reserve(first + run.size());
+        writePages(run, first);
+        numPages += run.size();
+        run.clear();
+    };
+    while (next < tuples.size()) {
+        Page &page = buffers[run.size()];
+        std::fill_n(page.begin(), getPageSize(), 0);
+        HeapPage hp(page, td, layout, getPageSize());
+        next += hp.fill(tuples.subspan(next));
+        if (next == tuples.size() && !hp.full()) {
+            partial = &page;
+            partial_hint = hp.freeHint();
+            break;
+        }
+        run.push_back(&page);
+        if (run.size() == buffers.size()) {
+            publish();
+        }
+    }
+    if (!run.empty()) {
+        publish();
+    }
+    if (partial == nullptr) {
+        return;
+    }
+    PageId pid{id, appendPage()};
+    PageGuard np = bufferPool.pinPage(pid, PageIntent::WRITE);
+    std::copy_n(partial->begin(), getPageSize(), np->begin());
+    setFreeHint(pid.page, partial_hint);
+    setFree(pid.page, true);
+}
+
+size_t HeapFile::compact(size_t max_pages) {
+    checkWritable();
+    if (isCompressed()) {
+        throw std::logic_error("A compressed file cannot be truncated");
+    }
     BufferPool &bufferPool = getDatabase().getBufferPool();
-    PageId pid{name, 0};
-    pid.page = numPages - 1;
-    Page &p = bufferPool.getPage(pid);
-    HeapPage hp(p, td);
-    if (!hp.insertTuple(t)) {
-        numPages++;
-        pid.page++;
-        Page &np = bufferPool.getPage(pid);
-        HeapPage nhp(np, td);
-        nhp.insertTuple(t);
+    std::lock_guard lock(append_latch);
+    size_t end = numPages;
+    for (size_t step = 0; step < max_pages && end > 1; step++) {
+        size_t last = end - 1;
+        // The source is only written back if a tuple moves off it
+        PageGuard source_page = bufferPool.pinPage({id, last});
+        HeapPage source(*source_page, td, layout, getPageSize(), freeHint(last));
+        // The target stays pinned until it is full, and a page the map lists by mistake is taken off it. It is only
+        // written back if a tuple moves onto it
+        std::optional<PageGuard> target_page;
+        std::optional<size_t> target;
+        for (size_t slot = source.begin(); slot != source.end(); source.next(slot)) {
+            Tuple t = source.getTuple(slot);
+            while (true) {
+                if (!target_page) {
+                    target = findFree();
+                    if (!target || *target >= last) {
+                        break;
+                    }
+                    target_page = bufferPool.pinPage({id, *target});
+                }
+                HeapPage hp(**target_page, td, layout, getPageSize(), freeHint(*target));
+                bool inserted = hp.insertTuple(t);
+                setFreeHint(*target, hp.freeHint());
+                if (inserted) {
+                    target_page->markDirty();
+                }
+                if (!inserted || hp.full()) {
+                    setFree(*target, false);
+                    target_page.reset();
+                }
+                if (inserted) {
+                    break;
+                }
+            }
+            if (!target || *target >= last) {
+                break;
+            }
+            source.deleteTuple(slot);
+            source_page.markDirty();
+        }
+        if (source.begin() != source.end()) {
+            setFreeHint(last, source.freeHint());
+            setFree(last, true);
+            break;
+        }
+        setFree(last, false);
+        end = last;
+    }
+    size_t reclaimed = numPages - end;
+    if (reclaimed > 0) {
+        truncate(end);
+        // Pages added later in place of the truncated ones start empty
+        std::lock_guard space_lock(space_latch);
+        free_slots.resize(std::min(free_slots.size(), end));
     }
-    bufferPool.markDirty(pid);
+    return reclaimed;
 }
 
 void HeapFile::deleteTuple(const Iterator &it) {
     // TODO pa1
+    checkWritable();
     BufferPool &bufferPool = getDatabase().getBufferPool();
-    PageId pid{name, it.page};
-    Page &p = bufferPool.getPage(pid);
-    HeapPage hp(p, td);
-    bufferPool.markDirty(pid);
+    PageId pid{id, it.page};
+    PageGuard p = bufferPool.pinPage(pid, PageIntent::WRITE);
+    HeapPage hp(*p, td, layout, getPageSize(), freeHint(it.page));
     hp.deleteTuple(it.slot);
+    setFreeHint(it.page, hp.freeHint());
+    setFree(it.page, true);
 }
 
 Tuple HeapFile::getTuple(const Iterator &it) const {
     // TODO pa1
-    BufferPool &bufferPool = getDatabase().getBufferPool();
-    PageId pid{name, it.page};
-    Page &p = bufferPool.getPage(pid);
-    HeapPage hp(p, td);
+    PageGuard p = readGuard(it.page);
+    HeapPage hp(*p, td, layout, getPageSize());
     return hp.getTuple(it.slot);
 }
 
+TupleView HeapFile::getView(const Iterator &it, PageGuard &page) const {
+    page = readGuard(it.page);
+    return HeapPage(*page, td, layout, getPageSize()).getView(it.slot);
+}
+
+void HeapFile::scan(const std::function<void(const TupleView &)> &f) const {
+    scanPages([&](const HeapPage &hp) { hp.forEach([&](size_t slot) { f(hp.getView(slot)); }); });
+}
+
+void HeapFile::scanPages(const std::function<void(const HeapPage &)> &f) const {
+    for (size_t page = 0; page < numPages; page++) {
+        PageGuard p = readGuard(page, AccessHint::SEQUENTIAL);
+        f(HeapPage(*p, td, layout, getPageSize()));
+    }
+}
+
+PageLayout HeapFile::getLayout() const { return layout; }
+
 void HeapFile::next(Iterator &it) const {
     // TODO pa1
-    BufferPool &bufferPool = getDatabase().getBufferPool();
     if (it.page < numPages) {
-        PageId pid{name, it.page};
-        Page &p = bufferPool.getPage(pid);
-        const HeapPage hp(p, td);
+        PageGuard p = readGuard(it.page, AccessHint::SEQUENTIAL);
+        const HeapPage hp(*p, td, layout, getPageSize());
         hp.next(it.slot);
         if (it.slot != hp.end()) {
             return;
@@ -60,9 +375,8 @@ void HeapFile::next(Iterator &it) const {
         it.page++;
     }
     while (it.page < numPages) {
-        PageId pid{name, it.page};
-        Page &p = bufferPool.getPage(pid);
-        const HeapPage hp(p, td);
+        PageGuard p = readGuard(it.page, AccessHint::SEQUENTIAL);
+        const HeapPage hp(*p, td, layout, getPageSize());
         it.slot = hp.begin();
         if (it.slot != hp.end()) {
             return;
@@ -74,12 +388,10 @@ void HeapFile::next(Iterator &it) const {
 
 Iterator HeapFile::begin() const {
     // TODO pa1
-    BufferPool &bufferPool = getDatabase().getBufferPool();
     size_t page = 0;
     while (page < numPages) {
-        PageId pid{name, page};
-        Page &p = bufferPool.getPage(pid);
-        const HeapPage hp(p, td);
+        PageGuard p = readGuard(page, AccessHint::SEQUENTIAL);
+        const HeapPage hp(*p, td, layout, getPageSize());
         size_t slot = hp.begin();
         if (slot != hp.end())
             return {*this, page, slot};
@@ -1,73 +1,274 @@
 #include <db/Database.hpp>
 #include <db/HeapPage.hpp>
+#include <algorithm>
+#include <bit>
+#include <cstring>
 #include <stdexcept>
 
 using namespace db;
 
-HeapPage::HeapPage(Page &page, const TupleDesc &td) : td(td) {
+// Returns the 64 header bits of the slots from first on (a multiple of 64), the first slot in the most significant bit
+static uint64_t loadWord(const uint8_t *header, size_t first) {
+    uint64_t word;
+    std::memcpy(&word, header + first / 8, sizeof(word));
+    if constexpr (std::endian::native == std::endian::little) {
+        word = __builtin_bswap64(word);
+    }
+    return word;
+}
+
+// Returns the bits of the word of the slots from first on that stand for slots of the page; the rest of the last
+// header byte, and the data past the header, are not slots
+static uint64_t validBits(size_t first, size_t capacity) {
+    return capacity - first >= 64 ? ~uint64_t{0} : ~(~uint64_t{0} >> (capacity - first));
+}
+
+HeapPage::HeapPage(Page &page, const TupleDesc &td, PageLayout layout, size_t page_size, size_t free_hint)
+    : td(td), page_size(page_size), free_hint(free_hint) {
     // TODO pa1
     // NOTE: header and data should point to locations inside the page buffer. Do not allocate extra memory.
-    capacity = DEFAULT_PAGE_SIZE * 8 / (td.length() * 8 + 1);
     header = page.data();
-    data = header + DEFAULT_PAGE_SIZE - td.length() * capacity;
+    if (!td.fixed()) {
+        if (layout == PageLayout::PAX) {
+            throw std::logic_error("PAX pages need fixed-size fields");
+        }
+        capacity = 0;
+        data = header;
+        slotted = reinterpret_cast<SlottedHeader *>(header);
+        directory = reinterpret_cast<Slot *>(header + sizeof(SlottedHeader));
+        return;
+    }
+    if (layout == PageLayout::PAX) {
+        // An even capacity starts every minipage at a multiple of 8 bytes, since the offsets are multiples of 4
+        pax = true;
+        capacity = (page_size - MINIPAGE_ALIGNMENT + 1) * 8 / (td.length() * 8 + 1) / 2 * 2;
+        data = header + ((capacity + 7) / 8 + MINIPAGE_ALIGNMENT - 1) / MINIPAGE_ALIGNMENT * MINIPAGE_ALIGNMENT;
+        return;
+    }
+    capacity = page_size * 8 / (td.length() * 8 + 1);
+    data = header + page_size - td.length() * capacity;
 }
 
-size_t HeapPage::begin() const {
-    // TODO pa1
-    for (size_t i = 0; i < capacity; i++) {
-        if (!empty(i)) {
-            return i;
+void HeapPage::store(size_t slot, const Tuple &t) {
+    uint16_t end = 0;
+    for (size_t i = 0; i < td.size(); i++) {
+        type_t type = td.field_type(i);
+        uint8_t *field = data + td.offset_of(i) * capacity + slot * fieldSize(type);
+        switch (type) {
+            case type_t::INT:
+                FieldCodec<type_t::INT>::encode(field, field, t.get_field(i), end);
+                break;
+            case type_t::DOUBLE:
+                FieldCodec<type_t::DOUBLE>::encode(field, field, t.get_field(i), end);
+                break;
+            case type_t::CHAR:
+                FieldCodec<type_t::CHAR>::encode(field, field, t.get_field(i), end);
+                break;
+            case type_t::VARCHAR:
+                // PAX pages only hold fixed-size fields
+                break;
+        }
+    }
+}
+
+size_t HeapPage::find(size_t from, bool occupied) const {
+    if (slotted) {
+        while (from < slotted->slots && (directory[from].offset != 0) != occupied) {
+            from++;
+        }
+        return std::min<size_t>(from, slotted->slots);
+    }
+    for (size_t first = from / 64 * 64; first < capacity; first += 64) {
+        uint64_t word = loadWord(header, first);
+        word = (occupied ? word : ~word) & validBits(first, capacity);
+        if (first < from) {
+            word &= ~uint64_t{0} >> (from - first);
+        }
+        if (word != 0) {
+            return first + std::countl_zero(word);
         }
     }
     return capacity;
 }
 
+size_t HeapPage::begin() const {
+    // TODO pa1
+    return find(0, true);
+}
+
 size_t HeapPage::end() const {
     // TODO pa1
-    return capacity;
+    return slotted ? slotted->slots : capacity;
+}
+
+size_t HeapPage::freeHint() const { return free_hint; }
+
+size_t HeapPage::space() const {
+    return page_size - sizeof(SlottedHeader) - slotted->slots * sizeof(Slot) - slotted->used + slotted->holes;
+}
+
+void HeapPage::pack() {
+    std::vector<uint8_t> copy(header, header + page_size);
+    size_t used = 0;
+    for (size_t slot = 0; slot < slotted->slots; slot++) {
+        Slot &entry = directory[slot];
+        if (entry.offset != 0) {
+            used += entry.length;
+            std::memcpy(header + page_size - used, copy.data() + entry.offset, entry.length);
+            entry.offset = static_cast<uint16_t>(page_size - used);
+        }
+    }
+    slotted->used = static_cast<uint16_t>(used);
+    slotted->holes = 0;
 }
 
 bool HeapPage::insertTuple(const Tuple &t) {
     // TODO pa1
-    size_t slot = 0;
-    while (slot < capacity && (header[slot / 8] & (1 << (7 - slot % 8)))) {
-        slot++;
+    size_t slot = find(free_hint, false);
+    free_hint = slot;
+    if (slotted) {
+        // A record that does not fit between the directory and the records may fit once the holes are packed
+        size_t length = td.length(t);
+        size_t slots = std::max<size_t>(slot + 1, slotted->slots);
+        if (length + (slots - slotted->slots) * sizeof(Slot) > space()) {
+            return false;
+        }
+        if (sizeof(SlottedHeader) + slots * sizeof(Slot) + slotted->used + length > page_size) {
+            pack();
+        }
+        slotted->slots = static_cast<uint16_t>(slots);
+        slotted->used += length;
+        directory[slot] = {static_cast<uint16_t>(page_size - slotted->used), static_cast<uint16_t>(length)};
+        td.serialize(header + directory[slot].offset, t);
+        free_hint = slot + 1;
+        return true;
     }
     if (slot == capacity) {
         return false;
     }
     header[slot / 8] |= 1 << (7 - slot % 8);
+    free_hint = slot + 1;
+    if (pax) {
+        store(slot, t);
+        return true;
+    }
     uint8_t *slotData = data + slot * td.length();
     td.serialize(slotData, t);
     return true;
 }
 
+bool HeapPage::full() const {
+    if (slotted) {
+        return space() < td.length() + sizeof(Slot);
+    }
+    return find(free_hint, false) == capacity;
+}
+
+size_t HeapPage::fill(std::span<const Tuple> tuples) {
+    if (slotted) {
+        size_t filled = 0;
+        while (filled < tuples.size() && insertTuple(tuples[filled])) {
+            filled++;
+        }
+        return filled;
+    }
+    size_t filled = std::min(tuples.size(), capacity);
+    if (pax) {
+        for (size_t slot = 0; slot < filled; slot++) {
+            store(slot, tuples[slot]);
+        }
+    } else {
+        for (size_t slot = 0; slot < filled; slot++) {
+            td.serialize(data + slot * td.length(), tuples[slot]);
+        }
+    }
+    std::fill(header, header + filled / 8, 0xff);
+    if (filled % 8 != 0) {
+        header[filled / 8] = static_cast<uint8_t>(0xff << (8 - filled % 8));
+    }
+    free_hint = filled;
+    return filled;
+}
+
 void HeapPage::deleteTuple(size_t slot) {
     // TODO pa1
-    if (slot >= capacity) {
+    if (slot >= end()) {
         throw std::runtime_error("Out of index");
     }
     if (empty(slot)) {
         throw std::runtime_error("Slot not occupied");
     }
-    header[slot / 8] &= ~(1 << (7 - slot % 8));
+    if (slotted) {
+        slotted->holes += directory[slot].length;
+        directory[slot] = {0, 0};
+    } else {
+        header[slot / 8] &= ~(1 << (7 - slot % 8));
+    }
+    free_hint = std::min(free_hint, slot);
 }
 
 Tuple HeapPage::getTuple(size_t slot) const {
     // TODO pa1
+    return getView(slot).materialize();
+}
+
+TupleView HeapPage::getView(size_t slot) const {
     if (empty(slot)) {
         throw std::runtime_error("Slot not occupied");
     }
-    uint8_t *slotData = data + slot * td.length();
-    return td.deserialize(slotData);
+    if (slotted) {
+        return {td, header + directory[slot].offset};
+    }
+    if (pax) {
+        return {td, data, capacity, slot};
+    }
+    return {td, data + slot * td.length()};
 }
 
 void HeapPage::next(size_t &slot) const {
     // TODO pa1
-    while (++slot < capacity && empty(slot));
+    // In a dense page the next slot is usually occupied, which one bit tells
+    if (++slot < end() && !empty(slot)) {
+        return;
+    }
+    slot = find(slot, true);
+}
+
+size_t HeapPage::count() const {
+    size_t count = 0;
+    if (slotted) {
+        for (size_t slot = 0; slot < slotted->slots; slot++) {
+            count += directory[slot].offset != 0;
+        }
+        return count;
+    }
+    for (size_t first = 0; first < capacity; first += 64) {
+        count += std::popcount(loadWord(header, first) & validBits(first, capacity));
+    }
+    return count;
+}
+
+void HeapPage::forEach(const std::function<void(size_t)> &f) const {
+    if (slotted) {
+        for (size_t slot = find(0, true); slot < slotted->slots; slot = find(slot + 1, true)) {
+            f(slot);
+        }
+        return;
+    }
+    for (size_t first = 0; first < capacity; first += 64) {
+        uint64_t word = loadWord(header, first) & validBits(first, capacity);
+        while (word != 0) {
+            int bit = std::countl_zero(word);
+            f(first + bit);
+            word &= ~(uint64_t{1} << (63 - bit));
+        }
+    }
 }
 
 bool HeapPage::empty(size_t slot) const {
     // TODO pa1
+    if (slotted) {
+        return slot >= slotted->slots || directory[slot].offset == 0;
+    }
     return !(header[slot / 8] & (1 << (7 - slot % 8)));
 }
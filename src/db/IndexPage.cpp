@@ -3,8 +3,10 @@
 
 using namespace db;
 
-IndexPage::IndexPage(Page &page) {
-  capacity = (DEFAULT_PAGE_SIZE - sizeof(IndexPageHeader) - sizeof(int)) / (sizeof(int) + sizeof(size_t));
+IndexPage::IndexPage(Page &page, size_t page_size) {
+  // There is room for capacity + 1 keys and children, and the children must be aligned
+  capacity = (page_size - sizeof(IndexPageHeader)) / (sizeof(int) + sizeof(size_t)) - 1;
+  capacity -= (sizeof(IndexPageHeader) + (capacity + 1) * sizeof(int)) % alignof(size_t) / sizeof(int);
   header = reinterpret_cast<IndexPageHeader *>(page.data());
   keys = reinterpret_cast<int *>(header + 1);
   children = reinterpret_cast<size_t *>(keys + capacity + 1);
@@ -0,0 +1,238 @@
+#include <db/IoQueue.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <numeric>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace db;
+
+size_t IoRequest::size() const {
+    return std::accumulate(buffers.begin(), buffers.end(), size_t{0},
+                           [](size_t total, const iovec &buffer) { return total + buffer.iov_len; });
+}
+
+static int uringSetup(unsigned entries, io_uring_params *params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int uringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+UringQueue::UringQueue(size_t depth) : IoQueue(depth) {
+    if (depth == 0) {
+        throw std::logic_error("I/O queue depth must be positive");
+    }
+    // Larger rings are rejected by older kernels
+    queue_depth = std::min<size_t>(depth, 4096);
+    io_uring_params params{};
+    ring_fd = uringSetup(static_cast<unsigned>(queue_depth), &params);
+    if (ring_fd < 0) {
+        throw std::runtime_error("io_uring_setup");
+    }
+
+    // The submission and completion rings may share one mapping; the submission entries always have their own
+    sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+    }
+    auto map = [&](size_t size, off_t offset) {
+        void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+        if (ptr == MAP_FAILED) {
+            release();
+            throw std::runtime_error("mmap");
+        }
+        return ptr;
+    };
+    sq_ring = map(sq_ring_size, IORING_OFF_SQ_RING);
+    cq_ring = single_mmap ? sq_ring : map(cq_ring_size, IORING_OFF_CQ_RING);
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = map(sqes_size, IORING_OFF_SQES);
+
+    auto *sq = static_cast<uint8_t *>(sq_ring);
+    sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    auto *cq = static_cast<uint8_t *>(cq_ring);
+    cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes = cq + params.cq_off.cqes;
+}
+
+UringQueue::~UringQueue() { release(); }
+
+void UringQueue::release() {
+    if (sqes != nullptr) {
+        munmap(sqes, sqes_size);
+    }
+    if (cq_ring != nullptr && cq_ring != sq_ring) {
+        munmap(cq_ring, cq_ring_size);
+    }
+    if (sq_ring != nullptr) {
+        munmap(sq_ring, sq_ring_size);
+    }
+    if (ring_fd >= 0) {
+        close(ring_fd);
+    }
+    sqes = cq_ring = sq_ring = nullptr;
+    ring_fd = -1;
+}
+
+void UringQueue::prepare(IoRequest &request) {
+    if (pending() == queue_depth) {
+        throw std::logic_error("I/O queue is full");
+    }
+    // This thread is the only producer of the submission ring, the kernel reads the tail
+    unsigned tail = *sq_tail;
+    unsigned index = tail & sq_mask;
+    auto &sqe = static_cast<io_uring_sqe *>(sqes)[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = request.op == IoRequest::READ ? IORING_OP_READV : IORING_OP_WRITEV;
+    sqe.fd = request.fd;
+    sqe.addr = reinterpret_cast<uint64_t>(request.buffers.data());
+    sqe.len = static_cast<uint32_t>(request.buffers.size());
+    sqe.off = static_cast<uint64_t>(request.offset);
+    sqe.user_data = reinterpret_cast<uint64_t>(&request);
+    sq_array[index] = index;
+    request.issued = std::chrono::steady_clock::now();
+    std::atomic_ref(*sq_tail).store(tail + 1, std::memory_order_release);
+    prepared++;
+}
+
+void UringQueue::submit() {
+    while (prepared > 0) {
+        int submitted = uringEnter(ring_fd, static_cast<unsigned>(prepared), 0, 0);
+        if (submitted < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            throw std::runtime_error("io_uring_enter");
+        }
+        prepared -= submitted;
+        in_flight += submitted;
+    }
+}
+
+IoRequest &UringQueue::wait() {
+    if (pending() == 0) {
+        throw std::logic_error("No I/O request is pending");
+    }
+    submit();
+    while (true) {
+        // This thread is the only consumer of the completion ring, the kernel writes the tail
+        unsigned head = *cq_head;
+        if (head != std::atomic_ref(*cq_tail).load(std::memory_order_acquire)) {
+            const auto &cqe = static_cast<io_uring_cqe *>(cqes)[head & cq_mask];
+            auto &request = *reinterpret_cast<IoRequest *>(cqe.user_data);
+            request.result = cqe.res;
+            std::atomic_ref(*cq_head).store(head + 1, std::memory_order_release);
+            in_flight--;
+            return request;
+        }
+        if (uringEnter(ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+            throw std::runtime_error("io_uring_enter");
+        }
+    }
+}
+
+ThreadPoolQueue::ThreadPoolQueue(size_t depth, size_t num_threads) : IoQueue(depth) {
+    if (depth == 0) {
+        throw std::logic_error("I/O queue depth must be positive");
+    }
+    if (num_threads == 0) {
+        num_threads = std::min<size_t>(depth, 16);
+    }
+    for (size_t i = 0; i < num_threads; i++) {
+        workers.emplace_back(&ThreadPoolQueue::run, this);
+    }
+}
+
+ThreadPoolQueue::~ThreadPoolQueue() {
+    {
+        std::lock_guard lock(latch);
+        stop = true;
+    }
+    work.notify_all();
+    for (auto &worker: workers) {
+        worker.join();
+    }
+}
+
+void ThreadPoolQueue::run() {
+    std::unique_lock lock(latch);
+    while (true) {
+        work.wait(lock, [&] { return stop || !issued.empty(); });
+        if (stop) {
+            return;
+        }
+        IoRequest &request = *issued.front();
+        issued.pop_front();
+        lock.unlock();
+        auto count = static_cast<int>(request.buffers.size());
+        ssize_t result = request.op == IoRequest::READ
+                         ? preadv(request.fd, request.buffers.data(), count, request.offset)
+                         : pwritev(request.fd, request.buffers.data(), count, request.offset);
+        request.result = result < 0 ? -errno : result;
+        lock.lock();
+        completed.push_back(&request);
+        done.notify_one();
+    }
+}
+
+void ThreadPoolQueue::prepare(IoRequest &request) {
+    if (pending() == queue_depth) {
+        throw std::logic_error("I/O queue is full");
+    }
+    request.issued = std::chrono::steady_clock::now();
+    ready.push_back(&request);
+    prepared++;
+}
+
+void ThreadPoolQueue::submit() {
+    if (prepared == 0) {
+        return;
+    }
+    {
+        std::lock_guard lock(latch);
+        issued.insert(issued.end(), ready.begin(), ready.end());
+    }
+    ready.clear();
+    in_flight += prepared;
+    prepared = 0;
+    work.notify_all();
+}
+
+IoRequest &ThreadPoolQueue::wait() {
+    if (pending() == 0) {
+        throw std::logic_error("No I/O request is pending");
+    }
+    submit();
+    std::unique_lock lock(latch);
+    done.wait(lock, [&] { return !completed.empty(); });
+    IoRequest &request = *completed.front();
+    completed.pop_front();
+    in_flight--;
+    return request;
+}
+
+std::unique_ptr<IoQueue> db::makeIoQueue(size_t depth, IoBackend backend) {
+    if (backend != IoBackend::THREADS) {
+        try {
+            return std::make_unique<UringQueue>(depth);
+        } catch (const std::runtime_error &) {
+            if (backend == IoBackend::URING) {
+                throw;
+            }
+        }
+    }
+    return std::make_unique<ThreadPoolQueue>(depth);
+}
@@ -1,4 +1,5 @@
 #include <db/LeafPage.hpp>
+#include <cstring>
 #include <stdexcept>
 
 using namespace db;
@@ -22,14 +23,65 @@ struct Iterator {
   int operator*() const { return *reinterpret_cast<const int *>(data + slot * width); }
 };
 
-LeafPage::LeafPage(Page &page, const TupleDesc &td, size_t key_index) : td(td), key_index(key_index) {
+/// An entry of the directory of a leaf of variable-length tuples
+struct LeafSlot {
+  uint16_t offset;
+  uint16_t length;
+};
+
+/// The space of a leaf of variable-length tuples, shared by the directory and the records
+static size_t leafSpace(size_t page_size) { return page_size - sizeof(LeafPageHeader); }
+
+LeafPage::LeafPage(Page &page, const TupleDesc &td, size_t key_index, size_t page_size)
+    : td(td), key_index(key_index), page_size(page_size) {
   header = reinterpret_cast<LeafPageHeader *>(page.data());
-  capacity = (DEFAULT_PAGE_SIZE - sizeof(LeafPageHeader)) / td.length();
-  data = page.data() + DEFAULT_PAGE_SIZE - td.length() * capacity;
+  if (!td.fixed()) {
+    capacity = leafSpace(page_size) / (td.length() + sizeof(LeafSlot));
+    data = page.data() + sizeof(LeafPageHeader);
+    return;
+  }
+  capacity = (page_size - sizeof(LeafPageHeader)) / td.length();
+  data = page.data() + page_size - td.length() * capacity;
 }
 
 bool LeafPage::insertTuple(const Tuple &t) {
   int key = std::get<int>(t.get_field(key_index));
+  if (!td.fixed()) {
+    size_t length = td.length(t);
+    if (length > maxLeafRecordSize(page_size)) {
+      throw std::runtime_error("Tuple too large for a leaf");
+    }
+    auto *page = reinterpret_cast<uint8_t *>(header);
+    auto *slots = reinterpret_cast<LeafSlot *>(data);
+    auto key_at = [&](size_t slot) {
+      int k;
+      std::memcpy(&k, page + slots[slot].offset + td.offset_of(key_index), sizeof(k));
+      return k;
+    };
+    size_t slot = 0;
+    for (size_t count = header->size; count > 0;) {
+      size_t half = count / 2;
+      if (key_at(slot + half) < key) {
+        slot += half + 1;
+        count -= half + 1;
+      } else {
+        count = half;
+      }
+    }
+    if (slot < header->size && key == key_at(slot)) {
+      // The replaced record is dropped by packing the others
+      slots[slot].length = 0;
+      pack();
+    } else {
+      std::memmove(slots + slot + 1, slots + slot, (header->size - slot) * sizeof(LeafSlot));
+      ++header->size;
+    }
+    header->used += length;
+    slots[slot] = {static_cast<uint16_t>(page_size - header->used), static_cast<uint16_t>(length)};
+    td.serialize(page + slots[slot].offset, t);
+    return leafSpace(page_size) - header->size * sizeof(LeafSlot) - header->used <
+           maxLeafRecordSize(page_size) + sizeof(LeafSlot);
+  }
 
   const auto first = data + td.offset_of(key_index);
   const auto width = td.length();
@@ -46,6 +98,30 @@ bool LeafPage::insertTuple(const Tuple &t) {
 }
 
 int LeafPage::split(LeafPage &new_page) {
+  if (!td.fixed()) {
+    // The first half of the bytes stays; it ends within one record of the middle, which leaves room in both halves
+    auto *page = reinterpret_cast<uint8_t *>(header);
+    auto *slots = reinterpret_cast<LeafSlot *>(data);
+    auto *new_slots = reinterpret_cast<LeafSlot *>(new_page.data);
+    size_t total = header->used + header->size * sizeof(LeafSlot);
+    size_t half = 0;
+    for (size_t kept = 0; kept < total / 2; half++) {
+      kept += slots[half].length + sizeof(LeafSlot);
+    }
+    new_page.header->size = header->size - half;
+    new_page.header->next_leaf = header->next_leaf;
+    new_page.header->used = 0;
+    auto *new_data = reinterpret_cast<uint8_t *>(new_page.header);
+    for (size_t slot = half; slot < header->size; slot++) {
+      new_page.header->used += slots[slot].length;
+      LeafSlot &entry = new_slots[slot - half];
+      entry = {static_cast<uint16_t>(new_page.page_size - new_page.header->used), slots[slot].length};
+      std::memcpy(new_data + entry.offset, page + slots[slot].offset, entry.length);
+    }
+    header->size = half;
+    pack();
+    return new_page.getView(0).get_int(key_index);
+  }
   size_t half = header->size / 2;
   new_page.header->size = header->size - half;
   new_page.header->next_leaf = header->next_leaf;
@@ -54,9 +130,28 @@ int LeafPage::split(LeafPage &new_page) {
   return std::get<int>(td.deserialize(new_page.data).get_field(key_index));
 }
 
-Tuple LeafPage::getTuple(size_t slot) const {
+Tuple LeafPage::getTuple(size_t slot) const { return getView(slot).materialize(); }
+
+TupleView LeafPage::getView(size_t slot) const {
   if (slot >= header->size) {
     throw std::out_of_range("slot out of range");
   }
-  return td.deserialize(data + slot * td.length());
+  if (!td.fixed()) {
+    const LeafSlot &entry = reinterpret_cast<const LeafSlot *>(data)[slot];
+    return {td, reinterpret_cast<const uint8_t *>(header) + entry.offset};
+  }
+  return {td, data + slot * td.length()};
+}
+
+void LeafPage::pack() {
+  auto *page = reinterpret_cast<uint8_t *>(header);
+  auto *slots = reinterpret_cast<LeafSlot *>(data);
+  Page copy;
+  std::memcpy(copy.data(), page, page_size);
+  header->used = 0;
+  for (size_t slot = 0; slot < header->size; slot++) {
+    header->used += slots[slot].length;
+    std::memcpy(page + page_size - header->used, copy.data() + slots[slot].offset, slots[slot].length);
+    slots[slot].offset = static_cast<uint16_t>(page_size - header->used);
+  }
 }
@@ -0,0 +1,102 @@
+#include <db/Metrics.hpp>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numeric>
+
+using namespace db;
+
+size_t LatencyHistogram::bucketOf(std::chrono::nanoseconds latency) {
+    auto ns = static_cast<uint64_t>(std::max<std::chrono::nanoseconds::rep>(latency.count(), 1));
+    return std::min<size_t>(std::bit_width(ns) - 1, NUM_BUCKETS - 1);
+}
+
+size_t LatencyHistogram::count() const { return std::accumulate(buckets.begin(), buckets.end(), size_t{0}); }
+
+std::chrono::nanoseconds LatencyHistogram::percentile(double ratio) const {
+    size_t total = count();
+    if (total == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+    // The rank of the operation at the percentile, counting from 1
+    auto rank = std::max<size_t>(1, static_cast<size_t>(std::ceil(ratio * static_cast<double>(total))));
+    size_t seen = 0;
+    size_t i = 0;
+    for (; i < NUM_BUCKETS - 1; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            break;
+        }
+    }
+    return std::chrono::nanoseconds(int64_t{2} << i);
+}
+
+LatencyHistogram &LatencyHistogram::operator+=(const LatencyHistogram &other) {
+    for (size_t i = 0; i < NUM_BUCKETS; i++) {
+        buckets[i] += other.buckets[i];
+    }
+    return *this;
+}
+
+IoMetrics &IoMetrics::operator+=(const IoMetrics &other) {
+    hits += other.hits;
+    misses += other.misses;
+    prefetches += other.prefetches;
+    evictions += other.evictions;
+    dirty_evictions += other.dirty_evictions;
+    pages_read += other.pages_read;
+    pages_written += other.pages_written;
+    bytes_read += other.bytes_read;
+    bytes_written += other.bytes_written;
+    read_latency += other.read_latency;
+    write_latency += other.write_latency;
+    return *this;
+}
+
+void IoCounters::recordEviction(bool dirty) {
+    evictions.fetch_add(1, std::memory_order_relaxed);
+    if (dirty) {
+        dirty_evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void IoCounters::recordRead(size_t pages, size_t bytes, std::chrono::nanoseconds latency) {
+    pages_read.fetch_add(pages, std::memory_order_relaxed);
+    bytes_read.fetch_add(bytes, std::memory_order_relaxed);
+    read_latency[LatencyHistogram::bucketOf(latency)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void IoCounters::recordWrite(size_t pages, size_t bytes, std::chrono::nanoseconds latency) {
+    pages_written.fetch_add(pages, std::memory_order_relaxed);
+    bytes_written.fetch_add(bytes, std::memory_order_relaxed);
+    write_latency[LatencyHistogram::bucketOf(latency)].fetch_add(1, std::memory_order_relaxed);
+}
+
+IoMetrics IoCounters::snapshot() const {
+    IoMetrics metrics;
+    metrics.hits = hits.load(std::memory_order_relaxed);
+    metrics.misses = misses.load(std::memory_order_relaxed);
+    metrics.prefetches = prefetches.load(std::memory_order_relaxed);
+    metrics.evictions = evictions.load(std::memory_order_relaxed);
+    metrics.dirty_evictions = dirty_evictions.load(std::memory_order_relaxed);
+    metrics.pages_read = pages_read.load(std::memory_order_relaxed);
+    metrics.pages_written = pages_written.load(std::memory_order_relaxed);
+    metrics.bytes_read = bytes_read.load(std::memory_order_relaxed);
+    metrics.bytes_written = bytes_written.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < LatencyHistogram::NUM_BUCKETS; i++) {
+        metrics.read_latency.buckets[i] = read_latency[i].load(std::memory_order_relaxed);
+        metrics.write_latency.buckets[i] = write_latency[i].load(std::memory_order_relaxed);
+    }
+    return metrics;
+}
+
+void IoCounters::reset() {
+    for (auto *counter: {&hits, &misses, &prefetches, &evictions, &dirty_evictions, &pages_read, &pages_written,
+                         &bytes_read, &bytes_written}) {
+        counter->store(0, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < LatencyHistogram::NUM_BUCKETS; i++) {
+        read_latency[i].store(0, std::memory_order_relaxed);
+        write_latency[i].store(0, std::memory_order_relaxed);
+    }
+}
@@ -1,4 +1,5 @@
 #include <db/Query.hpp>
+#include <numeric>
 
 using namespace db;
 
@@ -9,17 +10,18 @@ void db::projection(const DbFile &in, DbFile &out, const std::vector<std::string
   for (const std::string &field_name : field_names) {
     indices.push_back(td.index_of(field_name));
   }
-  for (const Tuple &t : in) {
+  in.scanColumns(indices, [&](const TupleView &t) {
     std::vector<field_t> fields;
+    fields.reserve(indices.size());
     for (size_t i : indices) {
       fields.push_back(t.get_field(i));
     }
     Tuple new_tuple(fields);
     out.insertTuple(new_tuple);
-  }
+  });
 }
 
-bool eval(const field_t &f1, const field_t &f2, PredicateOp op) {
+template <typename T> static bool compare(const T &f1, const T &f2, PredicateOp op) {
   switch (op) {
   case PredicateOp::EQ:
     return f1 == f2;
@@ -37,21 +39,77 @@ bool eval(const field_t &f1, const field_t &f2, PredicateOp op) {
   return false;
 }
 
+bool eval(const field_t &f1, const field_t &f2, PredicateOp op) { return compare(f1, f2, op); }
+
+/**
+ * Compares a field of a tuple with a value, reading the field in place when the value has its type.
+ */
+static bool eval(const TupleView &t, size_t field, const field_t &value, PredicateOp op) {
+  if (const int *v = std::get_if<int>(&value); v && t.field_type(field) == type_t::INT) {
+    return compare(t.get_int(field), *v, op);
+  }
+  if (const double *v = std::get_if<double>(&value); v && t.field_type(field) == type_t::DOUBLE) {
+    return compare(t.get_double(field), *v, op);
+  }
+  if (const std::string *v = std::get_if<std::string>(&value);
+      v && (t.field_type(field) == type_t::CHAR || t.field_type(field) == type_t::VARCHAR)) {
+    return compare(t.get_string(field), std::string_view(*v), op);
+  }
+  return compare(t.get_field(field), value, op);
+}
+
+/**
+ * Returns the operation that gives the same result with its operands swapped.
+ */
+static PredicateOp swapped(PredicateOp op) {
+  switch (op) {
+  case PredicateOp::LT:
+    return PredicateOp::GT;
+  case PredicateOp::LE:
+    return PredicateOp::GE;
+  case PredicateOp::GT:
+    return PredicateOp::LT;
+  case PredicateOp::GE:
+    return PredicateOp::LE;
+  default:
+    return op;
+  }
+}
+
 void db::filter(const DbFile &in, DbFile &out, const std::vector<FilterPredicate> &pred) {
   // TODO: Implement this function
-  for (const Tuple &t : in) {
-    bool keep = true;
-    for (const FilterPredicate &p : pred) {
-      size_t field = in.getTupleDesc().index_of(p.field_name);
-      keep = eval(t.get_field(field), p.value, p.op);
-      if (!keep) {
-        break;
+  std::vector<size_t> fields;
+  for (const FilterPredicate &p : pred) {
+    fields.push_back(in.getTupleDesc().index_of(p.field_name));
+  }
+  auto matches = [&](const TupleView &t) {
+    for (size_t i = 0; i < pred.size(); i++) {
+      if (!eval(t, fields[i], pred[i].value, pred[i].op)) {
+        return false;
       }
     }
-    if (keep) {
-      out.insertTuple(t);
-    }
+    return true;
+  };
+  if (in.supportsRowFetch()) {
+    // Find the matching rows from the fields of the predicates, then read the other fields at those rows only
+    std::vector<size_t> rows;
+    size_t row = 0;
+    in.scanColumns(fields, [&](const TupleView &t) {
+      if (matches(t)) {
+        rows.push_back(row);
+      }
+      row++;
+    });
+    std::vector<size_t> all(in.getTupleDesc().size());
+    std::iota(all.begin(), all.end(), 0);
+    in.scanColumns(all, rows, [&](const TupleView &t) { out.insertTuple(t.materialize()); });
+    return;
   }
+  in.scan([&](const TupleView &t) {
+    if (matches(t)) {
+      out.insertTuple(t.materialize());
+    }
+  });
 }
 
 void db::aggregate(const DbFile &in, DbFile &out, const Aggregate &agg) {
@@ -61,10 +119,13 @@ void db::aggregate(const DbFile &in, DbFile &out, const Aggregate &agg) {
   const TupleDesc &td = in.getTupleDesc();
   size_t group_index = agg.group.has_value() ? td.index_of(agg.group.value()) : -1;
   size_t field_index = td.index_of(agg.field);
-  for (const Tuple &t : in) {
-    const field_t &key = agg.group.has_value() ? t.get_field(group_index) : "";
-    const field_t &f = t.get_field(field_index);
-    int value = get<int>(f);
+  std::vector<size_t> fields{field_index};
+  if (agg.group.has_value()) {
+    fields.push_back(group_index);
+  }
+  in.scanColumns(fields, [&](const TupleView &t) {
+    field_t key = agg.group.has_value() ? t.get_field(group_index) : "";
+    int value = t.get_int(field_index);
     if (values.find(key) == values.end()) {
       counts[key] = 1;
       values[key] = value;
@@ -80,7 +141,7 @@ void db::aggregate(const DbFile &in, DbFile &out, const Aggregate &agg) {
     } else if (agg.op == AggregateOp::MAX) {
       values[key] = std::max(values[key], value);
     }
-  }
+  });
   for (const auto &[key, value] : values) {
     std::vector<field_t> fields;
     if (agg.group.has_value()) {
@@ -104,11 +165,12 @@ void db::join(const DbFile &left, const DbFile &right, DbFile &out, const JoinPr
   const TupleDesc &right_td = right.getTupleDesc();
   size_t left_index = left_td.index_of(pred.left);
   size_t right_index = right_td.index_of(pred.right);
-  for (auto it1 = left.begin(); it1 != left.end(); ++it1) {
-    for (auto it2 = right.begin(); it2 != right.end(); ++it2) {
-      const auto &left_t = left.getTuple(it1);
-      const auto &right_t = right.getTuple(it2);
-      if (eval(left_t.get_field(left_index), right_t.get_field(right_index), pred.op)) {
+  // The right field is compared with the key of the left tuple, so the operation is swapped
+  PredicateOp op = swapped(pred.op);
+  left.scan([&](const TupleView &left_t) {
+    field_t key = left_t.get_field(left_index);
+    right.scan([&](const TupleView &right_t) {
+      if (eval(right_t, right_index, key, op)) {
         std::vector<field_t> fields;
         for (size_t i = 0; i < left_td.size(); i++) {
           fields.push_back(left_t.get_field(i));
@@ -121,6 +183,6 @@ void db::join(const DbFile &left, const DbFile &right, DbFile &out, const JoinPr
         Tuple new_tuple(fields);
         out.insertTuple(new_tuple);
       }
-    }
-  }
+    });
+  });
 }
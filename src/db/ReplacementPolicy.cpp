@@ -0,0 +1,170 @@
+#include <db/ReplacementPolicy.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace db;
+
+LruPolicy::LruPolicy(size_t num_frames) : pos_to_lru(num_frames) {}
+
+void LruPolicy::insert(size_t pos, const PageId &, AccessHint hint) {
+    if (hint == AccessHint::SEQUENTIAL) {
+        pos_to_lru[pos] = lru_list.insert(lru_list.end(), pos);
+    } else {
+        pos_to_lru[pos] = lru_list.insert(lru_list.begin(), pos);
+    }
+}
+
+void LruPolicy::touch(size_t pos, AccessHint hint) {
+    if (hint == AccessHint::NORMAL) {
+        lru_list.splice(lru_list.begin(), lru_list, pos_to_lru[pos]);
+    }
+}
+
+void LruPolicy::erase(size_t pos) {
+    lru_list.erase(pos_to_lru[pos]);
+}
+
+std::optional<size_t> LruPolicy::victim(const std::function<bool(size_t)> &evictable) {
+    for (auto it = lru_list.rbegin(); it != lru_list.rend(); ++it) {
+        if (evictable(*it)) {
+            return *it;
+        }
+    }
+    return std::nullopt;
+}
+
+void LruPolicy::relocate(const std::vector<size_t> &new_pos, size_t num_frames) {
+    pos_to_lru.assign(num_frames, {});
+    for (auto it = lru_list.begin(); it != lru_list.end(); ++it) {
+        *it = new_pos[*it];
+        pos_to_lru[*it] = it;
+    }
+}
+
+ClockPolicy::ClockPolicy(size_t num_frames) : state(num_frames, FREE) {}
+
+void ClockPolicy::insert(size_t pos, const PageId &, AccessHint hint) {
+    state[pos] = hint == AccessHint::SEQUENTIAL ? UNREFERENCED : REFERENCED;
+}
+
+void ClockPolicy::erase(size_t pos) {
+    state[pos] = FREE;
+}
+
+std::optional<size_t> ClockPolicy::victim(const std::function<bool(size_t)> &evictable) {
+    // Two full sweeps are enough: the first one clears every reference bit it passes
+    for (size_t i = 0; i < 2 * state.size(); i++) {
+        size_t pos = hand;
+        hand = (hand + 1) % state.size();
+        if (state[pos] == UNREFERENCED && evictable(pos)) {
+            return pos;
+        }
+        if (state[pos] == REFERENCED) {
+            state[pos] = UNREFERENCED;
+        }
+    }
+    return std::nullopt;
+}
+
+void ClockPolicy::relocate(const std::vector<size_t> &new_pos, size_t num_frames) {
+    std::vector<uint8_t> new_state(num_frames, FREE);
+    for (size_t pos = 0; pos < state.size(); pos++) {
+        if (state[pos] != FREE) {
+            new_state[new_pos[pos]] = state[pos];
+        }
+    }
+    state = std::move(new_state);
+    hand = 0;
+}
+
+TwoQueuePolicy::TwoQueuePolicy(size_t num_frames) : frames(num_frames) {}
+
+size_t TwoQueuePolicy::maxA1in() const { return std::max<size_t>(1, frames.size() / 4); }
+
+size_t TwoQueuePolicy::maxA1out() const { return std::max<size_t>(1, frames.size() / 2); }
+
+void TwoQueuePolicy::insert(size_t pos, const PageId &pid, AccessHint hint) {
+    Frame &frame = frames[pos];
+    frame.key = pid.packed();
+    frame.sequential = hint == AccessHint::SEQUENTIAL;
+    if (frame.sequential) {
+        frame.queue = A1IN;
+        frame.it = a1in.insert(a1in.end(), pos);
+    } else if (auto ghost = ghosts.find(frame.key); ghost != ghosts.end()) {
+        // Referenced again after leaving A1in: the page is hot
+        a1out.erase(ghost->second);
+        ghosts.erase(ghost);
+        frame.queue = AM;
+        frame.it = am.insert(am.begin(), pos);
+    } else {
+        frame.queue = A1IN;
+        frame.it = a1in.insert(a1in.begin(), pos);
+    }
+}
+
+void TwoQueuePolicy::touch(size_t pos, AccessHint hint) {
+    // Accesses to pages in A1in are considered correlated and do not change their position
+    Frame &frame = frames[pos];
+    if (hint == AccessHint::NORMAL && frame.queue == AM) {
+        am.splice(am.begin(), am, frame.it);
+    }
+}
+
+void TwoQueuePolicy::erase(size_t pos) {
+    Frame &frame = frames[pos];
+    if (frame.queue == A1IN) {
+        a1in.erase(frame.it);
+        if (!frame.sequential && !ghosts.contains(frame.key)) {
+            ghosts[frame.key] = a1out.insert(a1out.begin(), frame.key);
+            if (a1out.size() > maxA1out()) {
+                ghosts.erase(a1out.back());
+                a1out.pop_back();
+            }
+        }
+    } else if (frame.queue == AM) {
+        am.erase(frame.it);
+    }
+    frame = {};
+}
+
+std::optional<size_t> TwoQueuePolicy::victim(const std::function<bool(size_t)> &evictable) {
+    auto oldest = [&](const std::list<size_t> &queue) -> std::optional<size_t> {
+        for (auto it = queue.rbegin(); it != queue.rend(); ++it) {
+            if (evictable(*it)) {
+                return *it;
+            }
+        }
+        return std::nullopt;
+    };
+    bool from_a1in = a1in.size() > maxA1in() || am.empty() || (!a1in.empty() && frames[a1in.back()].sequential);
+    auto pos = from_a1in ? oldest(a1in) : oldest(am);
+    if (!pos) {
+        pos = from_a1in ? oldest(am) : oldest(a1in);
+    }
+    return pos;
+}
+
+void TwoQueuePolicy::relocate(const std::vector<size_t> &new_pos, size_t num_frames) {
+    std::vector<Frame> new_frames(num_frames);
+    for (auto *queue: {&a1in, &am}) {
+        for (auto it = queue->begin(); it != queue->end(); ++it) {
+            size_t pos = new_pos[*it];
+            new_frames[pos] = frames[*it];
+            new_frames[pos].it = it;
+            *it = pos;
+        }
+    }
+    frames = std::move(new_frames);
+}
+
+std::unique_ptr<ReplacementPolicy> db::makeReplacementPolicy(ReplacementPolicyType type, size_t num_frames) {
+    switch (type) {
+        case ReplacementPolicyType::LRU:
+            return std::make_unique<LruPolicy>(num_frames);
+        case ReplacementPolicyType::CLOCK:
+            return std::make_unique<ClockPolicy>(num_frames);
+        case ReplacementPolicyType::TWO_Q:
+            return std::make_unique<TwoQueuePolicy>(num_frames);
+    }
+    throw std::logic_error("Unknown replacement policy");
+}
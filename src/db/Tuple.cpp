@@ -33,18 +33,12 @@ TupleDesc::TupleDesc(const std::vector<type_t> &types, const std::vector<std::st
     for (size_t i = 0; i < types.size(); i++) {
         offsets.push_back(offset);
         name_to_index[names[i]] = i;
-        switch (types[i]) {
-            case type_t::INT:
-                offset += INT_SIZE;
-                break;
-            case type_t::DOUBLE:
-                offset += DOUBLE_SIZE;
-                break;
-            case type_t::CHAR:
-                offset += CHAR_SIZE;
-                break;
+        if (types[i] == type_t::VARCHAR) {
+            varchars.push_back(i);
         }
+        offset += fieldSize(types[i]);
     }
+    fixed_length = offset;
     if (name_to_index.size() != names.size()) {
         throw std::logic_error("Duplicate name");
     }
@@ -57,7 +51,12 @@ bool TupleDesc::compatible(const Tuple &tuple) const {
     }
 
     for (size_t i = 0; i < tuple.size(); i++) {
-        if (tuple.field_type(i) != types[i]) {
+        if (types[i] == type_t::VARCHAR) {
+            const auto *field = std::get_if<std::string>(&tuple.get_field(i));
+            if (field == nullptr || field->size() > UINT16_MAX) {
+                return false;
+            }
+        } else if (tuple.field_type(i) != types[i]) {
             return false;
         }
     }
@@ -65,6 +64,8 @@ bool TupleDesc::compatible(const Tuple &tuple) const {
     return true;
 }
 
+type_t TupleDesc::field_type(size_t index) const { return types.at(index); }
+
 size_t TupleDesc::index_of(const std::string &name) const {
     // TODO pa1
     return name_to_index.at(name);
@@ -77,23 +78,19 @@ size_t TupleDesc::offset_of(const size_t &index) const {
 
 size_t TupleDesc::length() const {
     // TODO pa1
-    size_t length = 0;
-    for (type_t type: types) {
-        switch (type) {
-            case type_t::INT:
-                length += INT_SIZE;
-                break;
-            case type_t::DOUBLE:
-                length += DOUBLE_SIZE;
-                break;
-            case type_t::CHAR:
-                length += CHAR_SIZE;
-                break;
-        }
+    return fixed_length;
+}
+
+size_t TupleDesc::length(const Tuple &t) const {
+    size_t length = fixed_length;
+    for (size_t i: varchars) {
+        length += std::get<std::string>(t.get_field(i)).size();
     }
     return length;
 }
 
+bool TupleDesc::fixed() const { return varchars.empty(); }
+
 size_t TupleDesc::size() const {
     // TODO pa1
     return types.size();
@@ -103,19 +100,20 @@ Tuple TupleDesc::deserialize(const uint8_t *data) const {
     // TODO pa1
     std::vector<field_t> fields;
     fields.reserve(types.size());
-    for (const type_t &type: types) {
-        switch (type) {
+    for (size_t i = 0; i < types.size(); i++) {
+        const uint8_t *field = data + offsets[i];
+        switch (types[i]) {
             case type_t::INT:
-                fields.emplace_back(*reinterpret_cast<const int *>(data));
-                data += INT_SIZE;
+                decodeField<type_t::INT>(fields, data, field);
                 break;
             case type_t::DOUBLE:
-                fields.emplace_back(*reinterpret_cast<const double *>(data));
-                data += DOUBLE_SIZE;
+                decodeField<type_t::DOUBLE>(fields, data, field);
                 break;
             case type_t::CHAR:
-                fields.emplace_back(std::string(reinterpret_cast<const char *>(data)));
-                data += CHAR_SIZE;
+                decodeField<type_t::CHAR>(fields, data, field);
+                break;
+            case type_t::VARCHAR:
+                decodeField<type_t::VARCHAR>(fields, data, field);
                 break;
         }
     }
@@ -124,21 +122,21 @@ Tuple TupleDesc::deserialize(const uint8_t *data) const {
 
 void TupleDesc::serialize(uint8_t *data, const Tuple &t) const {
     // TODO pa1
+    auto end = static_cast<uint16_t>(fixed_length);
     for (size_t i = 0; i < types.size(); i++) {
-        const type_t &type = types[i];
-        const field_t &field = t.get_field(i);
-        switch (type) {
+        uint8_t *field = data + offsets[i];
+        switch (types[i]) {
             case type_t::INT:
-                *reinterpret_cast<int *>(data) = std::get<int>(field);
-                data += INT_SIZE;
+                FieldCodec<type_t::INT>::encode(data, field, t.get_field(i), end);
                 break;
             case type_t::DOUBLE:
-                *reinterpret_cast<double *>(data) = std::get<double>(field);
-                data += DOUBLE_SIZE;
+                FieldCodec<type_t::DOUBLE>::encode(data, field, t.get_field(i), end);
                 break;
             case type_t::CHAR:
-                strncpy(reinterpret_cast<char *>(data), std::get<std::string>(field).c_str(), CHAR_SIZE);
-                data += CHAR_SIZE;
+                FieldCodec<type_t::CHAR>::encode(data, field, t.get_field(i), end);
+                break;
+            case type_t::VARCHAR:
+                FieldCodec<type_t::VARCHAR>::encode(data, field, t.get_field(i), end);
                 break;
         }
     }
@@ -157,3 +155,37 @@ db::TupleDesc TupleDesc::merge(const TupleDesc &td1, const TupleDesc &td2) {
     }
     return {types, names};
 }
+
+std::string_view TupleView::get_string(size_t i) const {
+    switch (td->types.at(i)) {
+        case type_t::CHAR:
+            return FieldCodec<type_t::CHAR>::read(data, at(i));
+        case type_t::VARCHAR:
+            return FieldCodec<type_t::VARCHAR>::read(data, at(i));
+        default:
+            throw std::logic_error("Field has another type");
+    }
+}
+
+field_t TupleView::get_field(size_t i) const {
+    switch (td->types.at(i)) {
+        case type_t::INT:
+            return get_int(i);
+        case type_t::DOUBLE:
+            return get_double(i);
+        default:
+            return std::string(get_string(i));
+    }
+}
+
+Tuple TupleView::materialize() const {
+    if (capacity == 0) {
+        return td->deserialize(data);
+    }
+    std::vector<field_t> fields;
+    fields.reserve(size());
+    for (size_t i = 0; i < size(); i++) {
+        fields.push_back(get_field(i));
+    }
+    return {fields};
+}
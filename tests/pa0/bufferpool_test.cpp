@@ -2,6 +2,9 @@
 
 #include <db/Database.hpp>
 #include <db/DbFile.hpp>
+#include <filesystem>
+#include <fstream>
+#include <thread>
 
 TEST(BufferPoolTest, getPage) {
     db::Database &db = db::getDatabase();
@@ -203,6 +206,7 @@ TEST(BefferPoolTest, flushFile) {
 TEST(BufferPoolTest, LRU) {
     db::Database &db = db::getDatabase();
     db::BufferPool &bufferPool = db.getBufferPool();
+    bufferPool.setReplacementPolicy(db::ReplacementPolicyType::LRU);
 
     std::string name{"file"};
     db::TupleDesc td;
@@ -249,3 +253,659 @@ TEST(BufferPoolTest, LRU) {
         EXPECT_EQ(writes[i], size + i);
     }
 }
+
+TEST(BufferPoolTest, resize) {
+    db::Database &db = db::getDatabase();
+    db::BufferPool &bufferPool = db.getBufferPool();
+    bufferPool.setReplacementPolicy(db::ReplacementPolicyType::LRU);
+
+    std::string name{"file"};
+    db::TupleDesc td;
+    db.add(std::make_unique<db::DbFile>(name, td));
+    for (size_t i = 0; i < db::DEFAULT_NUM_PAGES; i++) {
+        db::PageId pid{name, i};
+        bufferPool.getPage(pid)[0] = i;
+        bufferPool.markDirty(pid);
+    }
+
+    // grow: all pages stay resident with their contents and dirty state
+    bufferPool.resize(2 * db::DEFAULT_NUM_PAGES);
+    EXPECT_EQ(bufferPool.size(), 2 * db::DEFAULT_NUM_PAGES);
+    for (size_t i = 0; i < db::DEFAULT_NUM_PAGES; i++) {
+        db::PageId pid{name, i};
+        EXPECT_TRUE(bufferPool.contains(pid));
+        EXPECT_TRUE(bufferPool.isDirty(pid));
+        EXPECT_EQ(bufferPool.getPage(pid)[0], i);
+    }
+    for (size_t i = db::DEFAULT_NUM_PAGES; i < 2 * db::DEFAULT_NUM_PAGES; i++) {
+        bufferPool.getPage({name, i});
+    }
+
+    const db::DbFile &file = db.get(name);
+    const auto &reads = file.getReads();
+    const auto &writes = file.getWrites();
+    EXPECT_EQ(reads.size(), 2 * db::DEFAULT_NUM_PAGES);
+    EXPECT_EQ(writes.size(), 0);
+
+    // shrink: the least recently used pages are evicted and the dirty ones are flushed
+    constexpr size_t size = 10;
+    bufferPool.resize(size);
+    EXPECT_EQ(bufferPool.size(), size);
+    EXPECT_EQ(writes.size(), db::DEFAULT_NUM_PAGES);
+    for (size_t i = 0; i < 2 * db::DEFAULT_NUM_PAGES; i++) {
+        EXPECT_EQ(bufferPool.contains({name, i}), i >= 2 * db::DEFAULT_NUM_PAGES - size);
+    }
+    EXPECT_ANY_THROW(bufferPool.resize(0));
+}
+
+TEST(BufferPoolTest, frameSize) {
+    db::Database &db = db::getDatabase();
+    db::BufferPool &bufferPool = db.getBufferPool();
+    EXPECT_EQ(bufferPool.getFrameSize(), db::DEFAULT_PAGE_SIZE);
+
+    std::string name{"file"};
+    std::string large{"large"};
+    std::string small{"small"};
+    std::remove(name.c_str());
+    std::remove(large.c_str());
+    std::remove(small.c_str());
+    db::TupleDesc td;
+    db.add(std::make_unique<db::DbFile>(name, td));
+    for (size_t i = 0; i < 10; i++) {
+        db::PageId pid{name, i};
+        bufferPool.getPage(pid)[db::DEFAULT_PAGE_SIZE - 1] = i;
+        bufferPool.markDirty(pid);
+    }
+
+    // a file with larger pages grows the frames, which cannot move while a page is pinned
+    if (db::MAX_PAGE_SIZE > db::DEFAULT_PAGE_SIZE) {
+        db::PageGuard guard = bufferPool.pinPage({name, 0});
+        EXPECT_THROW(db.add(std::make_unique<db::DbFile>(large, td, db::MAX_PAGE_SIZE)), std::logic_error);
+    }
+    db.add(std::make_unique<db::DbFile>(large, td, db::MAX_PAGE_SIZE));
+    EXPECT_EQ(bufferPool.getFrameSize(), db::MAX_PAGE_SIZE);
+    EXPECT_EQ(bufferPool.size(), db::DEFAULT_NUM_PAGES);
+    for (size_t i = 0; i < 10; i++) {
+        db::PageId pid{name, i};
+        EXPECT_TRUE(bufferPool.isDirty(pid));
+        EXPECT_EQ(bufferPool.getPage(pid)[db::DEFAULT_PAGE_SIZE - 1], i);
+    }
+
+    // smaller pages fit in the larger frames, and the frames keep their size across a resize
+    db.add(std::make_unique<db::DbFile>(small, td, db::MIN_PAGE_SIZE));
+    bufferPool.resize(db::DEFAULT_NUM_PAGES / 2);
+    EXPECT_EQ(bufferPool.getFrameSize(), db::MAX_PAGE_SIZE);
+    bufferPool.getPage({large, 0})[db::MAX_PAGE_SIZE - 1] = 1;
+    bufferPool.markDirty({large, 0});
+    bufferPool.getPage({small, 0})[db::MIN_PAGE_SIZE - 1] = 2;
+    bufferPool.markDirty({small, 0});
+    bufferPool.flushAll();
+    bufferPool.discardFile(large);
+    bufferPool.discardFile(small);
+    EXPECT_EQ(bufferPool.getPage({large, 0})[db::MAX_PAGE_SIZE - 1], 1);
+    EXPECT_EQ(bufferPool.getPage({small, 0})[db::MIN_PAGE_SIZE - 1], 2);
+    db.remove(large);
+    db.remove(small);
+    std::remove(large.c_str());
+    std::remove(small.c_str());
+}
+
+TEST(BufferPoolTest, CLOCK) {
+    db::Database &db = db::getDatabase();
+    db::BufferPool &bufferPool = db.getBufferPool();
+
+    std::string name{"file"};
+    db::TupleDesc td;
+    db.add(std::make_unique<db::DbFile>(name, td));
+    for (size_t i = 0; i < db::DEFAULT_NUM_PAGES; i++) {
+        bufferPool.getPage({name, i});
+    }
+
+    // every page is referenced: the hand clears all bits and evicts the first page it started from
+    bufferPool.getPage({name, db::DEFAULT_NUM_PAGES});
+    EXPECT_FALSE(bufferPool.contains({name, 0}));
+
+    // page 1 gets a second chance, page 2 is evicted instead
+    bufferPool.getPage({name, 1});
+    bufferPool.getPage({name, db::DEFAULT_NUM_PAGES + 1});
+    EXPECT_TRUE(bufferPool.contains({name, 1}));
+    EXPECT_FALSE(bufferPool.contains({name, 2}));
+    EXPECT_TRUE(bufferPool.contains({name, db::DEFAULT_NUM_PAGES}));
+}
+
+TEST(BufferPoolTest, sequentialHint) {
+    db::Database &db = db::getDatabase();
+    db::BufferPool &bufferPool = db.getBufferPool();
+    bufferPool.setReplacementPolicy(db::ReplacementPolicyType::LRU);
+
+    std::string name{"file"};
+    db::TupleDesc td;
+    db.add(std::make_unique<db::DbFile>(name, td));
+    for (size_t i = 0; i < db::DEFAULT_NUM_PAGES; i++) {
+        bufferPool.getPage({name, i});
+    }
+
+    // a sequential scan takes a single frame and keeps recycling it
+    for (size_t i = 0; i < 2 * db::DEFAULT_NUM_PAGES; i++) {
+        bufferPool.getPage({name, 2 * db::DEFAULT_NUM_PAGES + i}, db::AccessHint::SEQUENTIAL);
+    }
+    EXPECT_FALSE(bufferPool.contains({name, 0}));
+    for (size_t i = 1; i < db::DEFAULT_NUM_PAGES; i++) {
+        EXPECT_TRUE(bufferPool.contains({name, i}));
+    }
+}
+
+TEST(BufferPoolTest, TwoQueue) {
+    db::Database &db = db::getDatabase();
+    db::BufferPool &bufferPool = db.getBufferPool();
+    bufferPool.setReplacementPolicy(db::ReplacementPolicyType::TWO_Q);
+
+    std::string name{"file"};
+    db::TupleDesc td;
+    db.add(std::make_unique<db::DbFile>(name, td));
+    constexpr size_t hot = 10;
+    for (size_t i = 0; i < db::DEFAULT_NUM_PAGES + hot; i++) {
+        bufferPool.getPage({name, i});
+    }
+    // pages [0, hot) were evicted from A1in, reading them again makes them hot
+    for (size_t i = 0; i < hot; i++) {
+        EXPECT_FALSE(bufferPool.contains({name, i}));
+        bufferPool.getPage({name, i});
+    }
+
+    // a scan without hints goes through A1in and leaves the hot pages alone
+    for (size_t i = 0; i < 2 * db::DEFAULT_NUM_PAGES; i++) {
+        bufferPool.getPage({name, 2 * db::DEFAULT_NUM_PAGES + i});
+    }
+    for (size_t i = 0; i < hot; i++) {
+        EXPECT_TRUE(bufferPool.contains({name, i}));
+    }
+}
+
+TEST(BufferPoolTest, hitsAndMisses) {
+    db::Database &db = db::getDatabase();
+    db::BufferPool &bufferPool = db.getBufferPool();
+
+    std::string name{"file"};
+    db::TupleDesc td;
+    db.add(std::make_unique<db::DbFile>(name, td));
+    bufferPool.resetStats();
+    for (size_t i = 0; i < db::DEFAULT_NUM_PAGES; i++) {
+        bufferPool.getPage({name, i});
+        bufferPool.getPage({name, i});
+    }
+    EXPECT_EQ(bufferPool.getHits(), db::DEFAULT_NUM_PAGES);
+    EXPECT_EQ(bufferPool.getMisses(), db::DEFAULT_NUM_PAGES);
+    bufferPool.resetStats();
+    EXPECT_EQ(bufferPool.getHits(), 0);
+    EXPECT_EQ(bufferPool.getMisses(), 0);
+}
+
+TEST(BufferPoolTest, pinPage) {
+    db::Database &db = db::getDatabase();
+    db::BufferPool &bufferPool = db.getBufferPool();
+
+    std::string name{"file"};
+    db::TupleDesc td;
+    db.add(std::make_unique<db::DbFile>(name, td));
+    {
+        db::PageGuard guard = bufferPool.pinPage({name, 0});
+        db::Page *page = &*guard;
+        EXPECT_TRUE(bufferPool.isPinned({name, 0}));
+        EXPECT_ANY_THROW(bufferPool.discardPage({name, 0}));
+
+        // the pinned page survives a scan of many other pages
+        for (size_t i = 1; i <= 2 * db::DEFAULT_NUM_PAGES; i++) {
+            bufferPool.getPage({name, i});
+        }
+        EXPECT_TRUE(bufferPool.contains({name, 0}));
+        EXPECT_EQ(page, &bufferPool.getPage({name, 0}));
+        EXPECT_FALSE(bufferPool.isDirty({name, 0}));
+    }
+    EXPECT_FALSE(bufferPool.isPinned({name, 0}));
+
+    {
+        db::PageGuard guard = bufferPool.pinPage({name, 1}, db::PageIntent::WRITE);
+        (*guard)[0] = 1;
+    }
+    EXPECT_TRUE(bufferPool.isDirty({name, 1}));
+
+    db::PageGuard guard = bufferPool.pinPage({name, 2});
+    guard.markDirty();
+    EXPECT_FALSE(bufferPool.isDirty({name, 2}));
+    guard.release();
+    EXPECT_TRUE(bufferPool.isDirty({name, 2}));
+    EXPECT_FALSE(guard);
+}
+
+TEST(BufferPoolTest, allPinned) {
+    db::Database &db = db::getDatabase();
+    db::BufferPool &bufferPool = db.getBufferPool();
+
+    std::string name{"file"};
+    db::TupleDesc td;
+    db.add(std::make_unique<db::DbFile>(name, td));
+    std::vector<db::PageGuard> guards;
+    for (size_t i = 0; i < db::DEFAULT_NUM_PAGES; i++) {
+        guards.push_back(bufferPool.pinPage({name, i}));
+    }
+    EXPECT_ANY_THROW(bufferPool.getPage({name, db::DEFAULT_NUM_PAGES}));
+    EXPECT_ANY_THROW(bufferPool.resize(2 * db::DEFAULT_NUM_PAGES));
+    guards.pop_back();
+    bufferPool.getPage({name, db::DEFAULT_NUM_PAGES});
+    EXPECT_FALSE(bufferPool.contains({name, db::DEFAULT_NUM_PAGES - 1}));
+}
+
+TEST(BufferPoolTest, shards) {
+    db::Database &db = db::getDatabase();
+    db::BufferPool &bufferPool = db.getBufferPool();
+    constexpr size_t num_shards = 2;
+    bufferPool.setNumShards(num_shards);
+    EXPECT_EQ(bufferPool.getNumShards(), num_shards);
+    EXPECT_EQ(bufferPool.size(), db::DEFAULT_NUM_PAGES);
+
+    std::string name{"file"};
+    db::TupleDesc td;
+    db.add(std::make_unique<db::DbFile>(name, td));
+    for (size_t i = 0; i < db::DEFAULT_NUM_PAGES; i++) {
+        db::PageId pid{name, i};
+        bufferPool.getPage(pid)[0] = i;
+        bufferPool.markDirty(pid);
+    }
+    // consecutive pages alternate between the two shards, so every page of a pool-sized range fits
+    for (size_t i = 0; i < db::DEFAULT_NUM_PAGES; i++) {
+        EXPECT_TRUE(bufferPool.contains({name, i}));
+        EXPECT_EQ(bufferPool.getPage({name, i})[0], i);
+    }
+
+    // repartitioning flushes everything and starts over
+    bufferPool.setNumShards(5);
+    const db::DbFile &file = db.get(name);
+    EXPECT_EQ(file.getWrites().size(), db::DEFAULT_NUM_PAGES);
+    EXPECT_FALSE(bufferPool.contains({name, 0}));
+    EXPECT_EQ(bufferPool.getPage({name, 1})[0], 1);
+
+    // every shard keeps at least one frame
+    bufferPool.resize(5);
+    EXPECT_EQ(bufferPool.size(), 5);
+    EXPECT_TRUE(bufferPool.contains({name, 1}));
+    EXPECT_ANY_THROW(bufferPool.resize(4));
+    EXPECT_ANY_THROW(bufferPool.setNumShards(6));
+    EXPECT_ANY_THROW(bufferPool.setNumShards(0));
+}
+
+TEST(BufferPoolTest, concurrentMiss) {
+    db::Database &db = db::getDatabase();
+    db::BufferPool &bufferPool = db.getBufferPool();
+    bufferPool.setNumShards(4);
+
+    std::string name{"file"};
+    db::TupleDesc td;
+    db.add(std::make_unique<db::DbFile>(name, td));
+    constexpr size_t num_threads = 8;
+    constexpr size_t num_pages = 20;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; t++) {
+        threads.emplace_back([&] {
+            for (size_t i = 0; i < num_pages; i++) {
+                db::PageGuard guard = bufferPool.pinPage({name, i});
+                EXPECT_TRUE(guard);
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    // every page was read from disk exactly once, no matter how many threads faulted it
+    std::vector<size_t> reads = db.get(name).getReads();
+    std::sort(reads.begin(), reads.end());
+    EXPECT_EQ(reads.size(), num_pages);
+    for (size_t i = 0; i < num_pages; i++) {
+        EXPECT_EQ(reads[i], i);
+    }
+    EXPECT_EQ(bufferPool.getMisses(), num_pages);
+    EXPECT_EQ(bufferPool.getHits(), (num_threads - 1) * num_pages);
+    for (size_t i = 0; i < num_pages; i++) {
+        EXPECT_FALSE(bufferPool.isPinned({name, i}));
+    }
+}
+
+TEST(BufferPoolTest, concurrentDirtyEviction) {
+    db::Database &db = db::getDatabase();
+    db::BufferPool &bufferPool = db.getBufferPool();
+    bufferPool.resize(8);
+
+    std::string name{"file"};
+    std::remove(name.c_str());
+    db::TupleDesc td;
+    db.add(std::make_unique<db::DbFile>(name, td));
+    constexpr size_t num_threads = 4;
+    constexpr size_t num_pages = 32;
+    constexpr size_t rounds = 3;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t] {
+            for (size_t round = 0; round < rounds; round++) {
+                for (size_t i = 0; i < num_pages; i++) {
+                    db::PageGuard guard = bufferPool.pinPage({name, t * num_pages + i}, db::PageIntent::WRITE);
+                    (*guard)[0] = t * num_pages + i;
+                    (*guard)[1] = round;
+                }
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    // dirty victims are written without the latch, and every page comes back with its last contents
+    EXPECT_GT(bufferPool.getDirtyEvictions(), 0);
+    for (size_t i = 0; i < num_threads * num_pages; i++) {
+        db::PageGuard guard = bufferPool.pinPage({name, i});
+        EXPECT_EQ((*guard)[0], i);
+        EXPECT_EQ((*guard)[1], rounds - 1);
+    }
+}
+
+TEST(BufferPoolTest, backgroundFlush) {
+    db::Database &db = db::getDatabase();
+    db::BufferPool &bufferPool = db.getBufferPool();
+
+    std::string name{"file"};
+    db::TupleDesc td;
+    db.add(std::make_unique<db::DbFile>(name, td));
+    for (size_t i = 0; i < db::DEFAULT_NUM_PAGES; i++) {
+        bufferPool.pinPage({name, i}, db::PageIntent::WRITE);
+    }
+
+    // the flusher writes dirty pages until half of the frames are clean
+    bufferPool.startFlusher({0.5, 256, std::chrono::milliseconds(1)});
+    EXPECT_TRUE(bufferPool.isFlusherRunning());
+    auto num_dirty = [&] {
+        size_t count = 0;
+        for (size_t i = 0; i < db::DEFAULT_NUM_PAGES; i++) {
+            count += bufferPool.isDirty({name, i});
+        }
+        return count;
+    };
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (num_dirty() > db::DEFAULT_NUM_PAGES / 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    bufferPool.stopFlusher();
+    EXPECT_FALSE(bufferPool.isFlusherRunning());
+    EXPECT_EQ(num_dirty(), db::DEFAULT_NUM_PAGES / 2);
+
+    // the batch is written in page order
+    const auto &writes = db.get(name).getWrites();
+    EXPECT_EQ(writes.size(), db::DEFAULT_NUM_PAGES / 2);
+    EXPECT_TRUE(std::is_sorted(writes.begin(), writes.end()));
+    for (size_t page: writes) {
+        EXPECT_FALSE(bufferPool.isDirty({name, page}));
+    }
+
+    // without the flusher, a miss has to write its dirty victim first
+    for (size_t i = 0; i < db::DEFAULT_NUM_PAGES; i++) {
+        bufferPool.markDirty({name, i});
+    }
+    bufferPool.resetStats();
+    bufferPool.getPage({name, db::DEFAULT_NUM_PAGES});
+    EXPECT_EQ(bufferPool.getDirtyEvictions(), 1);
+    EXPECT_ANY_THROW(bufferPool.startFlusher({2, 256}));
+}
+
+TEST(BufferPoolTest, readAhead) {
+    db::Database &db = db::getDatabase();
+    db::BufferPool &bufferPool = db.getBufferPool();
+
+    constexpr size_t size = 40;
+    constexpr size_t distance = 8;
+    std::string name{"readahead.db"};
+    std::ofstream(name, std::ios::trunc).close();
+    std::filesystem::resize_file(name, size * db::DEFAULT_PAGE_SIZE);
+    db::TupleDesc td;
+    db.add(std::make_unique<db::DbFile>(name, td));
+    auto wait_for_prefetches = [&](size_t count) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (bufferPool.getPrefetches() < count && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+
+    // disabled by default
+    bufferPool.prefetch({name, 1}, distance);
+    bufferPool.getPage({name, 0}, db::AccessHint::SEQUENTIAL);
+    EXPECT_FALSE(bufferPool.contains({name, 1}));
+    bufferPool.discardPage({name, 0});
+
+    // a hinted access starts reading ahead right away
+    bufferPool.setReadAhead(distance);
+    EXPECT_EQ(bufferPool.getReadAhead(), distance);
+    bufferPool.resetStats();
+    bufferPool.getPage({name, 0}, db::AccessHint::SEQUENTIAL);
+    wait_for_prefetches(distance);
+    for (size_t i = 1; i <= distance; i++) {
+        EXPECT_TRUE(bufferPool.contains({name, i}));
+    }
+    EXPECT_FALSE(bufferPool.contains({name, distance + 1}));
+
+    // the scan keeps the window ahead of it, every page is read exactly once and none past the end of the file
+    for (size_t i = 1; i < size; i++) {
+        bufferPool.getPage({name, i}, db::AccessHint::SEQUENTIAL);
+    }
+    bufferPool.setReadAhead(0);
+    EXPECT_EQ(bufferPool.getMisses() + bufferPool.getPrefetches(), size);
+    std::vector<size_t> reads = db.get(name).getReads();
+    std::sort(reads.begin(), reads.end());
+    EXPECT_EQ(reads.size(), size + 1);
+    for (size_t i = 1; i < reads.size(); i++) {
+        EXPECT_EQ(reads[i], i - 1);
+    }
+
+    // without a hint, the second of two consecutive pages starts the read-ahead
+    for (size_t i = 0; i < size; i++) {
+        bufferPool.discardPage({name, i});
+    }
+    bufferPool.setReadAhead(distance);
+    bufferPool.resetStats();
+    bufferPool.getPage({name, 0});
+    bufferPool.getPage({name, 10});
+    bufferPool.getPage({name, 11});
+    wait_for_prefetches(distance);
+    bufferPool.setReadAhead(0);
+    EXPECT_EQ(bufferPool.getPrefetches(), distance);
+    EXPECT_FALSE(bufferPool.contains({name, 1}));
+    for (size_t i = 12; i < 12 + distance; i++) {
+        EXPECT_TRUE(bufferPool.contains({name, i}));
+    }
+    db.remove(name);
+    std::remove(name.c_str());
+}
+
+TEST(BufferPoolTest, metrics) {
+    db::Database &db = db::getDatabase();
+    db::BufferPool &bufferPool = db.getBufferPool();
+
+    constexpr size_t size = db::DEFAULT_NUM_PAGES + 1;
+    std::string name{"metrics.db"};
+    std::ofstream(name, std::ios::trunc).close();
+    std::filesystem::resize_file(name, size * db::DEFAULT_PAGE_SIZE);
+    db::TupleDesc td;
+    db.add(std::make_unique<db::DbFile>(name, td));
+    db::DbFile &file = db.get(name);
+    bufferPool.resetStats();
+
+    for (size_t i = 0; i < db::DEFAULT_NUM_PAGES; i++) {
+        bufferPool.getPage({name, i});
+        bufferPool.markDirty({name, i});
+    }
+    bufferPool.getPage({name, 0});
+    bufferPool.getPage({name, size - 1});
+
+    for (const db::IoMetrics &metrics: {bufferPool.getMetrics(), file.getMetrics()}) {
+        EXPECT_EQ(metrics.hits, 1);
+        EXPECT_EQ(metrics.misses, size);
+        EXPECT_EQ(metrics.evictions, 1);
+        EXPECT_EQ(metrics.dirty_evictions, 1);
+        EXPECT_EQ(metrics.pages_read, size);
+        EXPECT_EQ(metrics.bytes_read, size * db::DEFAULT_PAGE_SIZE);
+        EXPECT_EQ(metrics.pages_written, 1);
+        EXPECT_EQ(metrics.bytes_written, db::DEFAULT_PAGE_SIZE);
+        EXPECT_EQ(metrics.read_latency.count(), size);
+        EXPECT_EQ(metrics.write_latency.count(), 1);
+        EXPECT_GT(metrics.read_latency.percentile(0.5).count(), 0);
+        EXPECT_LE(metrics.read_latency.percentile(0.5), metrics.read_latency.percentile(1));
+    }
+
+    // The pool and the files are reset separately
+    bufferPool.resetStats();
+    EXPECT_EQ(bufferPool.getMetrics().misses, 0);
+    EXPECT_EQ(bufferPool.getMetrics().read_latency.count(), 0);
+    EXPECT_EQ(file.getMetrics().misses, size);
+    file.resetMetrics();
+    EXPECT_EQ(file.getMetrics().misses, 0);
+    EXPECT_EQ(file.getMetrics().write_latency.count(), 0);
+    EXPECT_TRUE(file.getReads().empty());
+    EXPECT_TRUE(file.getWrites().empty());
+    db.remove(name);
+    std::remove(name.c_str());
+}
+
+TEST(BufferPoolTest, traceLimit) {
+    db::Database &db = db::getDatabase();
+    db::BufferPool &bufferPool = db.getBufferPool();
+
+    std::string name{"trace.db"};
+    db::TupleDesc td;
+    db.add(std::make_unique<db::DbFile>(name, td));
+    db::DbFile &file = db.get(name);
+    file.resetMetrics();
+
+    // Only the first accesses are traced, but all of them are counted
+    file.setTraceLimit(10);
+    for (size_t i = 0; i < 20; i++) {
+        bufferPool.getPage({name, i});
+    }
+    const auto &reads = file.getReads();
+    EXPECT_EQ(reads.size(), 10);
+    for (size_t i = 0; i < reads.size(); i++) {
+        EXPECT_EQ(reads[i], i);
+    }
+    EXPECT_EQ(file.getMetrics().pages_read, 20);
+
+    file.setTraceLimit(5);
+    EXPECT_EQ(file.getReads().size(), 5);
+    file.setTraceLimit(0);
+    EXPECT_TRUE(file.getReads().empty());
+    bufferPool.getPage({name, 20});
+    EXPECT_TRUE(file.getReads().empty());
+    EXPECT_EQ(file.getMetrics().pages_read, 21);
+
+    // Removing the file drops its pages from the pool
+    db::PageId pid{name, 0};
+    db.remove(name);
+    EXPECT_FALSE(bufferPool.contains(pid));
+    std::remove(name.c_str());
+}
+
+TEST(BufferPoolTest, bulkFlush) {
+    db::Database &db = db::getDatabase();
+    db::BufferPool &bufferPool = db.getBufferPool();
+
+    std::string name{"bulk.db"};
+    db::TupleDesc td;
+    db.add(std::make_unique<db::DbFile>(name, td));
+    db::DbFile &file = db.get(name);
+    file.resetMetrics();
+    // Dirty every page but one, in no particular order
+    for (size_t i = 0; i < db::DEFAULT_NUM_PAGES; i++) {
+        size_t page = i * 7 % db::DEFAULT_NUM_PAGES;
+        bufferPool.getPage({name, page})[0] = static_cast<uint8_t>(page);
+        if (page != 20) {
+            bufferPool.markDirty({name, page});
+        }
+    }
+
+    // The pages are written in order, with one call per run of adjacent pages
+    bufferPool.flushFile(name, true);
+    const auto &writes = file.getWrites();
+    EXPECT_EQ(writes.size(), db::DEFAULT_NUM_PAGES - 1);
+    EXPECT_TRUE(std::is_sorted(writes.begin(), writes.end()));
+    EXPECT_EQ(file.getMetrics().write_latency.count(), 2);
+    for (size_t i = 0; i < db::DEFAULT_NUM_PAGES; i++) {
+        EXPECT_FALSE(bufferPool.isDirty({name, i}));
+    }
+
+    bufferPool.markDirty({name, 20});
+    bufferPool.markDirty({name, 21});
+    bufferPool.flushAll();
+    EXPECT_EQ(writes.size(), db::DEFAULT_NUM_PAGES + 1);
+    EXPECT_EQ(file.getMetrics().write_latency.count(), 3);
+
+    db::Page page;
+    file.readPage(page, 30);
+    EXPECT_EQ(page[0], 30);
+    db.remove(name);
+    std::remove(name.c_str());
+}
+
+TEST(BufferPoolTest, directIo) {
+    db::Database &db = db::getDatabase();
+    db::BufferPool &bufferPool = db.getBufferPool();
+
+    std::string name{"direct.db"};
+    std::remove(name.c_str());
+    db::TupleDesc td;
+    db.add(std::make_unique<db::DbFile>(name, td));
+    db::DbFile &file = db.get(name);
+    try {
+        file.setDirectIo(true);
+    } catch (const std::runtime_error &) {
+        db.remove(name);
+        std::remove(name.c_str());
+        GTEST_SKIP() << "The file system does not support direct I/O";
+    }
+    EXPECT_TRUE(file.isDirectIo());
+
+    // Pages go through the aligned frames of the pool as they are
+    for (size_t i = 0; i < 8; i++) {
+        db::Page &page = bufferPool.getPage({name, i});
+        std::fill_n(page.begin(), db::DEFAULT_PAGE_SIZE, static_cast<uint8_t>(i + 1));
+        bufferPool.markDirty({name, i});
+    }
+    bufferPool.flushFile(name);
+    bufferPool.discardFile(name);
+    for (size_t i = 0; i < 8; i++) {
+        EXPECT_EQ(bufferPool.getPage({name, i})[100], i + 1);
+    }
+
+    // Unaligned buffers go through a bounce buffer, except in requests
+    alignas(db::DIRECT_IO_ALIGNMENT) struct {
+        uint8_t pad;
+        db::Page page;
+    } unaligned{};
+    file.readPage(unaligned.page, 3);
+    EXPECT_EQ(unaligned.page[db::DEFAULT_PAGE_SIZE - 1], 4);
+    unaligned.page.fill(9);
+    file.writePage(unaligned.page, 8);
+    file.writePages({&unaligned.page, &unaligned.page}, 9);
+    EXPECT_THROW(file.readRequest({&unaligned.page}, 0), std::logic_error);
+    EXPECT_THROW(file.writeRequest({&unaligned.page}, 0), std::logic_error);
+    db::Page page;
+    file.readPage(page, 10);
+    EXPECT_EQ(page[0], 9);
+
+    // The short page at the end of a truncated file reads as zeros past the end
+    std::filesystem::resize_file(name, 10 * db::DEFAULT_PAGE_SIZE + db::DEFAULT_PAGE_SIZE / 2);
+    file.readPage(page, 10);
+    EXPECT_EQ(page[db::DEFAULT_PAGE_SIZE / 2 - 1], 9);
+    EXPECT_EQ(page[db::DEFAULT_PAGE_SIZE / 2], 0);
+    file.readPage(page, 11);
+    EXPECT_EQ(page, db::Page{});
+
+    file.setDirectIo(false);
+    EXPECT_FALSE(file.isDirectIo());
+    db.remove(name);
+    std::remove(name.c_str());
+}
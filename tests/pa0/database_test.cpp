@@ -2,6 +2,7 @@
 
 #include <db/Database.hpp>
 #include <db/DbFile.hpp>
+#include <sys/xattr.h>
 
 TEST(DatabaseTest, AddDbFile) {
     db::Database &db = db::getDatabase();
@@ -116,3 +117,71 @@ TEST(DatabaseTest, MultipleOperations) {
     db.add(std::move(file));
     EXPECT_EQ(expected, &db.get(name2));
 }
+
+TEST(DatabaseTest, FileIds) {
+    db::Database &db = db::getDatabase();
+    db::TupleDesc td;
+    db.add(std::make_unique<db::DbFile>("test1", td));
+    db.add(std::make_unique<db::DbFile>("test2", td));
+    db::file_id_t id1 = db.getId("test1");
+    db::file_id_t id2 = db.getId("test2");
+    EXPECT_NE(id1, id2);
+    EXPECT_EQ(&db.get(id1), &db.get("test1"));
+    EXPECT_EQ(db.get(id2).getId(), id2);
+    EXPECT_EQ(db::PageId("test2", 7), db::PageId(id2, 7));
+    EXPECT_ANY_THROW(db::PageId("test3", 0));
+
+    // ids are not reused after a file is removed
+    db.remove("test1");
+    EXPECT_ANY_THROW(db.get(id1));
+    db.add(std::make_unique<db::DbFile>("test1", td));
+    EXPECT_NE(db.getId("test1"), id1);
+    EXPECT_NE(db.getId("test1"), id2);
+}
+
+TEST(DatabaseTest, Configure) {
+    db::configureDatabase({2 * db::DEFAULT_NUM_PAGES, false});
+    db::Database &db = db::getDatabase();
+    EXPECT_EQ(db.getBufferPool().size(), 2 * db::DEFAULT_NUM_PAGES);
+    EXPECT_THROW(db::configureDatabase({}), std::logic_error);
+}
+
+TEST(DatabaseTest, PageSize) {
+    db::TupleDesc td;
+    std::string name = "pagesize.db";
+    std::remove(name.c_str());
+    EXPECT_EQ(db::DbFile(name, td).getPageSize(), db::DEFAULT_PAGE_SIZE);
+    EXPECT_THROW(db::DbFile(name, td, db::MIN_PAGE_SIZE + 1), std::logic_error);
+    EXPECT_THROW(db::DbFile(name, td, db::MAX_PAGE_SIZE * 2), std::logic_error);
+
+    uint32_t page_size = 0;
+    if (getxattr(name.c_str(), "user.db.page_size", &page_size, sizeof(page_size)) != sizeof(page_size)) {
+        std::remove(name.c_str());
+        GTEST_SKIP() << "The file system does not support extended attributes";
+    }
+    EXPECT_EQ(page_size, db::DEFAULT_PAGE_SIZE);
+
+    // A file keeps the page size it was created with, whatever page size it is opened with
+    std::remove(name.c_str());
+    {
+        db::DbFile file(name, td, db::MAX_PAGE_SIZE);
+        db::Page page{};
+        file.writePage(page, 0);
+    }
+    {
+        db::DbFile file(name, td, db::MIN_PAGE_SIZE);
+        EXPECT_EQ(file.getPageSize(), db::MAX_PAGE_SIZE);
+        EXPECT_EQ(file.getNumPages(), 1);
+    }
+
+    // A file recorded with a page size larger than this build supports is rejected
+    page_size = db::MAX_PAGE_SIZE * 2;
+    setxattr(name.c_str(), "user.db.page_size", &page_size, sizeof(page_size), 0);
+    EXPECT_THROW(db::DbFile(name, td), std::runtime_error);
+
+    // Only a new file records its page size: opening a file written without it leaves the file as it is
+    removexattr(name.c_str(), "user.db.page_size");
+    EXPECT_EQ(db::DbFile(name, td, db::MIN_PAGE_SIZE).getPageSize(), db::MIN_PAGE_SIZE);
+    EXPECT_EQ(getxattr(name.c_str(), "user.db.page_size", &page_size, sizeof(page_size)), -1);
+    std::remove(name.c_str());
+}
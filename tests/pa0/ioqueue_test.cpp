@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <db/DbFile.hpp>
+#include <db/IoQueue.hpp>
+#include <algorithm>
+
+static void readWrite(db::IoBackend backend) {
+    std::string name{"ioqueue.db"};
+    std::remove(name.c_str());
+    db::TupleDesc td;
+    db::DbFile file(name, td);
+    auto queue = db::makeIoQueue(4, backend);
+    EXPECT_EQ(queue->depth(), 4u);
+
+    // Write 8 pages with 4 requests of 2 pages, then read them back with one request per page
+    constexpr size_t num_pages = 8;
+    std::vector<db::Page> pages(num_pages);
+    std::vector<db::IoRequest> requests;
+    for (size_t i = 0; i < num_pages; i++) {
+        pages[i].fill(static_cast<uint8_t>(i + 1));
+    }
+    for (size_t i = 0; i < num_pages; i += 2) {
+        requests.push_back(file.writeRequest({&pages[i], &pages[i + 1]}, i));
+    }
+    for (auto &request: requests) {
+        queue->prepare(request);
+    }
+    EXPECT_EQ(queue->pending(), 4u);
+    EXPECT_THROW(queue->prepare(requests[0]), std::logic_error);
+    queue->submit();
+    for (size_t i = 0; i < requests.size(); i++) {
+        file.complete(queue->wait());
+    }
+    EXPECT_EQ(queue->pending(), 0u);
+    EXPECT_THROW(queue->wait(), std::logic_error);
+    EXPECT_EQ(file.getMetrics().pages_written, num_pages);
+    EXPECT_EQ(file.getMetrics().write_latency.count(), 4u);
+
+    std::vector<db::Page> copies(num_pages + 1);
+    requests.clear();
+    for (size_t i = 0; i <= num_pages; i++) {
+        requests.push_back(file.readRequest({&copies[i]}, i));
+    }
+    size_t completed = 0;
+    for (auto &request: requests) {
+        if (queue->pending() == queue->depth()) {
+            file.complete(queue->wait());
+            completed++;
+        }
+        queue->prepare(request);
+    }
+    for (; completed < requests.size(); completed++) {
+        file.complete(queue->wait());
+    }
+    // A page is read into the first bytes of its frame
+    for (size_t i = 0; i < num_pages; i++) {
+        EXPECT_TRUE(std::equal(pages[i].begin(), pages[i].begin() + file.getPageSize(), copies[i].begin()));
+    }
+    // The page past the end of the file reads as zeros
+    EXPECT_EQ(requests[num_pages].result, 0);
+    EXPECT_EQ(copies[num_pages], db::Page{});
+    EXPECT_EQ(file.getReads().size(), num_pages + 1);
+
+    // Failed requests complete with a negated errno value
+    db::IoRequest bad;
+    bad.buffers = {{copies[0].data(), file.getPageSize()}};
+    queue->prepare(bad);
+    EXPECT_EQ(&queue->wait(), &bad);
+    EXPECT_EQ(bad.result, -EBADF);
+    std::remove(name.c_str());
+}
+
+TEST(IoQueueTest, uring) {
+    try {
+        db::makeIoQueue(1, db::IoBackend::URING);
+    } catch (const std::runtime_error &) {
+        GTEST_SKIP() << "io_uring is not supported";
+    }
+    readWrite(db::IoBackend::URING);
+}
+
+TEST(IoQueueTest, threads) {
+    readWrite(db::IoBackend::THREADS);
+}
+
+TEST(IoQueueTest, invalidDepth) {
+    EXPECT_THROW(db::makeIoQueue(0, db::IoBackend::THREADS), std::logic_error);
+}
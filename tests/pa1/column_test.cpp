@@ -0,0 +1,212 @@
+#include <db/ColumnFile.hpp>
+#include <db/Database.hpp>
+#include <db/HeapFile.hpp>
+#include <db/Query.hpp>
+#include <gtest/gtest.h>
+#include <thread>
+
+static db::TupleDesc columnTupleDesc() {
+  return {{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE, db::type_t::VARCHAR, db::type_t::INT},
+          {"id", "name", "price", "note", "status"}};
+}
+
+static const std::vector<db::ColumnEncoding> column_encodings{db::ColumnEncoding::PLAIN, db::ColumnEncoding::RUN_LENGTH,
+                                                              db::ColumnEncoding::PLAIN, db::ColumnEncoding::PLAIN,
+                                                              db::ColumnEncoding::RUN_LENGTH};
+
+static db::Tuple columnTuple(int i) {
+  return {{i, i < 1500 ? "first" : "second", i * 0.5, std::string(i % 50, 'x'), i / 1000}};
+}
+
+static void expectColumnTuple(const db::Tuple &t, int i) {
+  db::Tuple expected = columnTuple(i);
+  ASSERT_EQ(t.size(), expected.size());
+  for (size_t field = 0; field < t.size(); field++) {
+    EXPECT_EQ(t.get_field(field), expected.get_field(field));
+  }
+}
+
+TEST(ColumnFileTest, InsertScan) {
+  const char *name = "columnfile";
+  std::remove(name);
+  db::getDatabase().add(
+      std::make_unique<db::ColumnFile>(name, columnTupleDesc(), column_encodings, db::MIN_PAGE_SIZE));
+  auto &file = dynamic_cast<db::ColumnFile &>(db::getDatabase().get(name));
+  EXPECT_EQ(file.begin(), file.end());
+  constexpr int rows = 3000;
+  for (int i = 0; i < rows; ++i) {
+    file.insertTuple(columnTuple(i));
+  }
+  EXPECT_EQ(file.getNumRows(), rows);
+  // 1016 ints fit in a page of 4 KB, and each run of equal values is stored once
+  EXPECT_EQ(file.getColumnPages(0), 3);
+  EXPECT_EQ(file.getColumnPages(1), 1);
+  EXPECT_EQ(file.getColumnPages(4), 1);
+  EXPECT_EQ(file.getEncoding(1), db::ColumnEncoding::RUN_LENGTH);
+
+  int i = 0;
+  for (const auto &t : file) {
+    expectColumnTuple(t, i);
+    ++i;
+  }
+  EXPECT_EQ(i, rows);
+
+  i = 0;
+  file.scan([&](const db::TupleView &t) {
+    expectColumnTuple(t.materialize(), i);
+    ++i;
+  });
+  EXPECT_EQ(i, rows);
+
+  // A scan of one column only pins the pages of that column, and leaves the other fields empty
+  file.resetMetrics();
+  i = 0;
+  file.scanColumns({2}, [&](const db::TupleView &t) {
+    EXPECT_EQ(t.get_double(2), i * 0.5);
+    EXPECT_EQ(t.get_int(0), 0);
+    EXPECT_EQ(t.get_string(3), "");
+    ++i;
+  });
+  EXPECT_EQ(i, rows);
+  db::IoMetrics metrics = file.getMetrics();
+  EXPECT_EQ(metrics.hits + metrics.misses, file.getColumnPages(2));
+
+  // Selected rows only pin the pages that hold them
+  EXPECT_TRUE(file.supportsRowFetch());
+  file.resetMetrics();
+  std::vector<size_t> selected{5, 1499, 1500, 2999};
+  std::vector<size_t> seen;
+  file.scanColumns({3, 1}, selected, [&](const db::TupleView &t) {
+    seen.push_back(t.get_string(3).size());
+    EXPECT_EQ(t.get_string(1), seen.size() <= 2 ? "first" : "second");
+  });
+  EXPECT_EQ(seen, (std::vector<size_t>{5, 1499 % 50, 1500 % 50, 2999 % 50}));
+  metrics = file.getMetrics();
+  EXPECT_LT(metrics.hits + metrics.misses, file.getColumnPages(1) + file.getColumnPages(3));
+  EXPECT_THROW(file.scanColumns({0}, std::vector<size_t>{rows}, [](const db::TupleView &) {}), std::runtime_error);
+  EXPECT_THROW(file.deleteTuple(file.begin()), std::runtime_error);
+}
+
+TEST(ColumnFileTest, Reopen) {
+  const char *name = "columnfile";
+  std::remove(name);
+  db::getDatabase().add(std::make_unique<db::ColumnFile>(name, columnTupleDesc(), column_encodings));
+  auto *file = &db::getDatabase().get(name);
+  constexpr int rows = 2000;
+  for (int i = 0; i < rows; ++i) {
+    file->insertTuple(columnTuple(i));
+  }
+  db::getDatabase().remove(name).reset();
+
+  // The map of the columns is rebuilt from the pages, with the encodings the file was written with
+  EXPECT_THROW(db::ColumnFile(name, columnTupleDesc()), std::runtime_error);
+  EXPECT_THROW(db::ColumnFile(name, columnTupleDesc(), {db::ColumnEncoding::PLAIN}), std::logic_error);
+  db::getDatabase().add(std::make_unique<db::ColumnFile>(name, columnTupleDesc(), column_encodings));
+  file = &db::getDatabase().get(name);
+  EXPECT_EQ(dynamic_cast<db::ColumnFile &>(*file).getNumRows(), rows);
+  file->insertTuple(columnTuple(rows));
+  int i = 0;
+  for (const auto &t : *file) {
+    expectColumnTuple(t, i);
+    ++i;
+  }
+  EXPECT_EQ(i, rows + 1);
+
+  // A field that does not fit in a page is refused before anything is appended
+  EXPECT_THROW(file->insertTuple({{0, "name", 0.0, std::string(db::DEFAULT_PAGE_SIZE - 20, 'x'), 0}}),
+               std::runtime_error);
+  EXPECT_THROW(file->insertTuple({{0, "name", 0.0, 1, 0}}), std::runtime_error);
+  EXPECT_EQ(dynamic_cast<db::ColumnFile &>(*file).getNumRows(), rows + 1);
+}
+
+TEST(ColumnFileTest, ScanDuringInserts) {
+  const char *name = "columnfile";
+  std::remove(name);
+  db::getDatabase().add(std::make_unique<db::ColumnFile>(name, columnTupleDesc(), column_encodings));
+  auto &file = dynamic_cast<db::ColumnFile &>(db::getDatabase().get(name));
+
+  // Scans that run during inserts see a prefix of the rows, while the columns grow new pages
+  constexpr int rows = 3000;
+  std::thread inserter([&] {
+    for (int i = 0; i < rows; ++i) {
+      file.insertTuple(columnTuple(i));
+    }
+  });
+  size_t seen = 0;
+  while (seen < rows) {
+    int i = 0;
+    file.scanColumns({0, 3}, [&](const db::TupleView &t) {
+      EXPECT_EQ(t.get_int(0), i);
+      EXPECT_EQ(t.get_string(3).size(), i % 50);
+      ++i;
+    });
+    EXPECT_GE(i, seen);
+    seen = i;
+  }
+  inserter.join();
+  EXPECT_EQ(file.getNumRows(), rows);
+}
+
+TEST(ColumnFileTest, ManyColumns) {
+  // More columns than the BufferPool has frames, which are read without pinning a page of each at once
+  constexpr int columns = static_cast<int>(db::DEFAULT_NUM_PAGES) + 10;
+  std::vector<db::type_t> types(columns, db::type_t::INT);
+  std::vector<std::string> names;
+  for (int field = 0; field < columns; field++) {
+    names.push_back("c" + std::to_string(field));
+  }
+  db::TupleDesc td(types, names);
+  const char *name = "columnfile";
+  const char *out_name = "heapfile.out";
+  std::remove(name);
+  std::remove(out_name);
+  db::getDatabase().add(std::make_unique<db::ColumnFile>(name, td));
+  auto &file = dynamic_cast<db::ColumnFile &>(db::getDatabase().get(name));
+  constexpr int rows = 10;
+  for (int i = 0; i < rows; ++i) {
+    std::vector<db::field_t> fields;
+    for (int field = 0; field < columns; field++) {
+      fields.emplace_back(i * columns + field);
+    }
+    file.insertTuple(db::Tuple(fields));
+  }
+  EXPECT_EQ(file.getNumPages(), static_cast<size_t>(columns));
+
+  int i = 0;
+  file.scan([&](const db::TupleView &t) {
+    EXPECT_EQ(t.get_int(0), i * columns);
+    EXPECT_EQ(t.get_int(columns - 1), i * columns + columns - 1);
+    ++i;
+  });
+  EXPECT_EQ(i, rows);
+  auto it = file.begin();
+  file.next(it);
+  EXPECT_EQ(std::get<int>(file.getTuple(it).get_field(columns - 1)), 2 * columns - 1);
+
+  db::getDatabase().add(std::make_unique<db::HeapFile>(out_name, td));
+  auto &out = db::getDatabase().get(out_name);
+  db::filter(file, out, {{"c0", db::PredicateOp::GE, 5 * columns}});
+  i = 5;
+  for (const auto &t : out) {
+    EXPECT_EQ(std::get<int>(t.get_field(columns - 1)), i * columns + columns - 1);
+    ++i;
+  }
+  EXPECT_EQ(i, rows);
+  db::getDatabase().remove(out_name);
+  std::remove(out_name);
+
+  std::string last = "c" + std::to_string(columns - 1);
+  db::TupleDesc projected({db::type_t::INT, db::type_t::INT}, {"c1", last});
+  db::getDatabase().add(std::make_unique<db::HeapFile>(out_name, projected));
+  auto &projection = db::getDatabase().get(out_name);
+  db::projection(file, projection, {"c1", last});
+  i = 0;
+  for (const auto &t : projection) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), i * columns + 1);
+    EXPECT_EQ(std::get<int>(t.get_field(1)), i * columns + columns - 1);
+    ++i;
+  }
+  EXPECT_EQ(i, rows);
+  db::getDatabase().remove(out_name);
+  std::remove(out_name);
+}
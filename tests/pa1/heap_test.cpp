@@ -1,7 +1,16 @@
+#include <db/Compression.hpp>
 #include <db/Database.hpp>
 #include <db/HeapPage.hpp>
 #include <db/HeapFile.hpp>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
 #include <gtest/gtest.h>
+#include <thread>
+
+// The slots of a row page of the size of new files, for an INT, a CHAR and a DOUBLE: 53 in a page of 4 KB
+constexpr size_t ROW_CAPACITY = db::DEFAULT_PAGE_SIZE * 8 / ((db::INT_SIZE + db::CHAR_SIZE + db::DOUBLE_SIZE) * 8 + 1);
 
 TEST(HeapPageTest, EmptyPage) {
   db::Page page{};
@@ -12,9 +21,9 @@ TEST(HeapPageTest, EmptyPage) {
 
 TEST(HeapPageTest, FullHeader) {
   db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
-  // A page can fit 53 tuples, but the header has 56 bits. The last 3 bits are not used.
+  // A page of 4 KB can fit 53 tuples, but the header has 56 bits. The last 3 bits are not used.
   db::Page full_page1{0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0b11111000}; // full header
-  db::HeapPage hp1(full_page1, td);
+  db::HeapPage hp1(full_page1, td, db::PageLayout::ROW, db::MIN_PAGE_SIZE);
   constexpr size_t capacity = 53;
   size_t count = 0;
   size_t slot = hp1.begin();
@@ -25,7 +34,7 @@ TEST(HeapPageTest, FullHeader) {
   EXPECT_EQ(count, capacity);
 
   db::Page full_page2{0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff}; // the last 3 bits (padding) should not affect the size
-  db::HeapPage hp2(full_page2, td);
+  db::HeapPage hp2(full_page2, td, db::PageLayout::ROW, db::MIN_PAGE_SIZE);
   count = 0;
   slot = hp2.begin();
   while (slot != hp2.end()) {
@@ -55,7 +64,7 @@ TEST(HeapPageTest, InsertTuple) {
   db::HeapPage hp(page, td);
   hp.insertTuple({{660, "Hello CS660!", 0.0}});
   EXPECT_NE(hp.begin(), hp.end());
-  int capacity = 53;
+  int capacity = ROW_CAPACITY;
   for (int i = 1; i < capacity; i++) {
     hp.insertTuple({{i, "Hello CS660!", 0.0}});
   }
@@ -117,9 +126,9 @@ TEST(HeapPageTest, GetTuple) {
       0x00, 0x00, 0x01, 0x00, // int ...
   };
   db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
-  db::HeapPage hp(page, td);
+  db::HeapPage hp(page, td, db::PageLayout::ROW, db::MIN_PAGE_SIZE);
   EXPECT_NE(hp.begin(), hp.end());
-  EXPECT_EQ(hp.end(), db::DEFAULT_PAGE_SIZE / (db::INT_SIZE + db::CHAR_SIZE + db::DOUBLE_SIZE));
+  EXPECT_EQ(hp.end(), db::MIN_PAGE_SIZE / (db::INT_SIZE + db::CHAR_SIZE + db::DOUBLE_SIZE));
 
   size_t slot = hp.begin();
   const auto &t1 = hp.getTuple(slot);
@@ -138,6 +147,166 @@ TEST(HeapPageTest, GetTuple) {
   EXPECT_EQ(count, 20);
 }
 
+TEST(HeapPageTest, NarrowSlots) {
+  db::Page page{};
+  db::TupleDesc td({db::type_t::INT}, {"id"});
+  db::HeapPage hp(page, td);
+  // 4 bytes and a header bit per slot: the slots span several header words and end inside one
+  constexpr size_t capacity = db::DEFAULT_PAGE_SIZE * 8 / 33;
+  ASSERT_EQ(hp.end(), capacity);
+  for (int i = 0; i < capacity; i++) {
+    EXPECT_TRUE(hp.insertTuple({{i}}));
+  }
+  EXPECT_TRUE(hp.full());
+  EXPECT_FALSE(hp.insertTuple({{-1}}));
+  EXPECT_EQ(hp.count(), capacity);
+
+  // Deleted slots are found again by the scan and refilled in order
+  std::vector<size_t> deleted{0, 63, 64, 127, 500, capacity - 1};
+  for (size_t slot : deleted) {
+    hp.deleteTuple(slot);
+  }
+  EXPECT_EQ(hp.count(), capacity - deleted.size());
+  std::vector<size_t> visited;
+  hp.forEach([&](size_t slot) { visited.push_back(slot); });
+  std::vector<size_t> scanned;
+  for (size_t slot = hp.begin(); slot != hp.end(); hp.next(slot)) {
+    scanned.push_back(slot);
+  }
+  EXPECT_EQ(visited, scanned);
+  EXPECT_EQ(visited.size(), capacity - deleted.size());
+  EXPECT_EQ(hp.begin(), 1);
+  for (size_t slot : deleted) {
+    EXPECT_TRUE(hp.empty(slot));
+  }
+  for (size_t slot : deleted) {
+    EXPECT_TRUE(hp.insertTuple({{static_cast<int>(slot)}}));
+    EXPECT_EQ(std::get<int>(hp.getTuple(slot).get_field(0)), slot);
+  }
+  EXPECT_TRUE(hp.full());
+}
+
+TEST(HeapPageTest, Slotted) {
+  db::Page page{};
+  db::TupleDesc td({db::type_t::INT, db::type_t::VARCHAR}, {"id", "name"});
+  db::HeapPage hp(page, td);
+  EXPECT_EQ(hp.begin(), hp.end());
+
+  // Records take the length of their strings, and the page fills up when the next smallest one does not fit
+  size_t count = 0;
+  while (hp.insertTuple({{static_cast<int>(count), std::string(count % 10, 'a')}})) {
+    count++;
+  }
+  EXPECT_GT(count, db::DEFAULT_PAGE_SIZE / (db::INT_SIZE + db::CHAR_SIZE));
+  EXPECT_EQ(hp.count(), count);
+  EXPECT_EQ(hp.end(), count);
+
+  // Deleted records leave their slots free, and a longer record is placed once the holes are packed
+  for (size_t slot = 0; slot < 20; slot++) {
+    hp.deleteTuple(slot);
+  }
+  EXPECT_ANY_THROW(hp.deleteTuple(0));
+  EXPECT_ANY_THROW(hp.deleteTuple(count));
+  EXPECT_EQ(hp.begin(), 20);
+  std::string long_name(60, 'b');
+  EXPECT_TRUE(hp.insertTuple({{-1, long_name}}));
+  EXPECT_EQ(std::get<std::string>(hp.getTuple(0).get_field(1)), long_name);
+  EXPECT_EQ(hp.end(), count);
+  for (size_t slot = 20; slot < count; slot++) {
+    db::Tuple t = hp.getTuple(slot);
+    EXPECT_EQ(std::get<int>(t.get_field(0)), slot);
+    EXPECT_EQ(std::get<std::string>(t.get_field(1)), std::string(slot % 10, 'a'));
+  }
+  while (hp.insertTuple({{-2, ""}})) {
+  }
+  EXPECT_TRUE(hp.full());
+}
+
+TEST(HeapPageTest, FreeHint) {
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::Page page{};
+  db::HeapPage hp(page, td);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(hp.insertTuple({{i, "Hello", 3.14}}));
+  }
+  EXPECT_EQ(hp.freeHint(), 10);
+  hp.deleteTuple(3);
+  EXPECT_EQ(hp.freeHint(), 3);
+
+  // A new wrapper searches for a free slot from the hint it is given
+  db::HeapPage next(page, td, db::PageLayout::ROW, db::DEFAULT_PAGE_SIZE, hp.freeHint());
+  EXPECT_TRUE(next.insertTuple({{-1, "Hello", 3.14}}));
+  EXPECT_FALSE(next.empty(3));
+  EXPECT_EQ(next.freeHint(), 4);
+  EXPECT_TRUE(next.insertTuple({{-2, "Hello", 3.14}}));
+  EXPECT_FALSE(next.empty(10));
+  EXPECT_EQ(next.freeHint(), 11);
+
+  // The slots before the hint are not searched
+  next.deleteTuple(3);
+  db::HeapPage skip(page, td, db::PageLayout::ROW, db::DEFAULT_PAGE_SIZE, 5);
+  EXPECT_TRUE(skip.insertTuple({{-3, "Hello", 3.14}}));
+  EXPECT_TRUE(skip.empty(3));
+  EXPECT_FALSE(skip.empty(11));
+}
+
+TEST(HeapPageTest, Pax) {
+  db::Page page{};
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::HeapPage hp(page, td, db::PageLayout::PAX);
+  EXPECT_EQ(hp.begin(), hp.end());
+
+  // The capacity is even, and at most one slot less than a row page
+  constexpr size_t capacity = ROW_CAPACITY / 2 * 2;
+  ASSERT_EQ(hp.end(), capacity);
+  for (int i = 0; i < capacity; i++) {
+    EXPECT_TRUE(hp.insertTuple({{i, "Hello " + std::to_string(i), i * 0.5}}));
+  }
+  EXPECT_TRUE(hp.full());
+  EXPECT_FALSE(hp.insertTuple({{-1, "Hello", 0.0}}));
+  for (size_t slot = 0; slot < capacity; slot++) {
+    db::Tuple t = hp.getTuple(slot);
+    EXPECT_EQ(std::get<int>(t.get_field(0)), slot);
+    EXPECT_EQ(std::get<std::string>(t.get_field(1)), "Hello " + std::to_string(slot));
+    EXPECT_EQ(std::get<double>(t.get_field(2)), slot * 0.5);
+    EXPECT_EQ(hp.getView(slot).get_string(1), "Hello " + std::to_string(slot));
+  }
+
+  // Each INT or DOUBLE field is an aligned array indexed by slot
+  std::span<const int> ids = hp.column<int>(0);
+  std::span<const double> prices = hp.column<double>(2);
+  ASSERT_EQ(ids.size(), capacity);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(ids.data()) % db::MINIPAGE_ALIGNMENT, 0);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(prices.data()) % db::MINIPAGE_ALIGNMENT, 0);
+  for (size_t slot = 0; slot < capacity; slot++) {
+    EXPECT_EQ(ids[slot], slot);
+    EXPECT_EQ(prices[slot], slot * 0.5);
+  }
+  EXPECT_THROW(hp.column<int>(1), std::logic_error);
+  EXPECT_THROW(hp.column<double>(0), std::logic_error);
+  db::Page row_page{};
+  EXPECT_THROW(db::HeapPage(row_page, td).column<int>(0), std::logic_error);
+
+  // Deleted slots are reused like in a row page
+  hp.deleteTuple(10);
+  EXPECT_TRUE(hp.empty(10));
+  EXPECT_TRUE(hp.insertTuple({{-10, "Bye", 1.0}}));
+  EXPECT_EQ(ids[10], -10);
+  EXPECT_EQ(hp.getView(10).get_string(1), "Bye");
+
+  // A page filled at once holds the same bytes as one filled a tuple at a time
+  std::vector<db::Tuple> tuples;
+  for (size_t slot = 0; slot < capacity; slot++) {
+    tuples.push_back(hp.getTuple(slot));
+  }
+  db::Page filled{};
+  EXPECT_EQ(db::HeapPage(filled, td, db::PageLayout::PAX).fill(tuples), capacity);
+  EXPECT_EQ(filled, page);
+
+  db::TupleDesc varchar({db::type_t::INT, db::type_t::VARCHAR}, {"id", "name"});
+  EXPECT_THROW(db::HeapPage(row_page, varchar, db::PageLayout::PAX), std::logic_error);
+}
+
 TEST(HeapFileTest, InsertTuple) {
   std::vector<db::type_t> types{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE};
   std::vector<std::string> names{"id", "name", "price"};
@@ -148,7 +317,7 @@ TEST(HeapFileTest, InsertTuple) {
   db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
   auto &file = db::getDatabase().get(name);
   EXPECT_EQ(file.begin(), file.end());
-  constexpr size_t capacity = 53;
+  constexpr size_t capacity = ROW_CAPACITY;
   for (int i = 0; i < capacity * 3; ++i) {
     file.insertTuple({{i, "Hello", 3.14}});
   }
@@ -176,7 +345,7 @@ TEST(HeapFileTest, EmptyPage) {
   std::remove(name);
   db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
   auto &file = db::getDatabase().get(name);
-  constexpr size_t capacity = 53;
+  constexpr size_t capacity = ROW_CAPACITY;
   for (int i = 0; i < capacity; ++i) {
     file.insertTuple({{i, "Hello", 3.14}});
     EXPECT_EQ(file.getNumPages(), 1);
@@ -200,3 +369,587 @@ TEST(HeapFileTest, EmptyPage) {
     i++;
   }
 }
+
+TEST(HeapFileTest, Mapped) {
+  std::vector<db::type_t> types{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE};
+  std::vector<std::string> names{"id", "name", "price"};
+  db::TupleDesc td(types, names);
+
+  const char *name = "heapfile";
+  std::remove(name);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  auto &file = db::getDatabase().get(name);
+  auto &bufferPool = db::getDatabase().getBufferPool();
+  constexpr size_t capacity = ROW_CAPACITY;
+  for (int i = 0; i < capacity * 3; ++i) {
+    file.insertTuple({{i, "Hello", 3.14}});
+  }
+
+  // Mapping flushes the dirty pages and takes the file out of the pool
+  file.map();
+  EXPECT_TRUE(file.isMapped());
+  for (size_t page = 0; page < file.getNumPages(); ++page) {
+    EXPECT_FALSE(bufferPool.contains({name, page}));
+  }
+  bufferPool.resetStats();
+  int i = 0;
+  for (const auto &t : file) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+    i++;
+  }
+  EXPECT_EQ(i, capacity * 3);
+  EXPECT_EQ(bufferPool.getHits() + bufferPool.getMisses(), 0);
+  EXPECT_THROW(file.insertTuple({{i, "Hello", 3.14}}), std::logic_error);
+  EXPECT_THROW(file.deleteTuple(file.begin()), std::logic_error);
+
+  file.unmap();
+  EXPECT_FALSE(file.isMapped());
+  file.insertTuple({{i, "Hello", 3.14}});
+  i = 0;
+  for (const auto &t : file) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+    i++;
+  }
+  EXPECT_EQ(i, capacity * 3 + 1);
+}
+
+TEST(HeapFileTest, Compressed) {
+  std::vector<db::type_t> types{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE};
+  std::vector<std::string> names{"id", "name", "price"};
+  db::TupleDesc td(types, names);
+
+  const char *name = "heapfile";
+  std::remove(name);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  auto &file = db::getDatabase().get(name);
+  auto &bufferPool = db::getDatabase().getBufferPool();
+  constexpr size_t capacity = ROW_CAPACITY;
+  for (int i = 0; i < capacity * 3; ++i) {
+    file.insertTuple({{i, "Hello", 3.14}});
+  }
+
+  // Converting flushes the dirty pages, and the zero-padded names shrink to a fraction of the pages
+  file.setCompression(true);
+  EXPECT_TRUE(file.isCompressed());
+  EXPECT_LT(file.getStoredSize(), file.getNumPages() * db::DEFAULT_PAGE_SIZE / 4);
+  EXPECT_THROW(file.map(), std::logic_error);
+  EXPECT_THROW(file.setDirectIo(true), std::logic_error);
+
+  // Pages are compressed when they are written back and decompressed when they are read again
+  file.insertTuple({{static_cast<int>(capacity * 3), "Hello", 3.14}});
+  bufferPool.flushFile(name);
+  bufferPool.discardFile(name);
+  int i = 0;
+  for (const auto &t : file) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+    EXPECT_EQ(std::get<std::string>(t.get_field(1)), "Hello");
+    i++;
+  }
+  EXPECT_EQ(i, capacity * 3 + 1);
+
+  // The page offsets are rebuilt when the file is opened again
+  auto removed = db::getDatabase().remove(name);
+  removed.reset();
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  auto &reopened = db::getDatabase().get(name);
+  EXPECT_TRUE(reopened.isCompressed());
+  EXPECT_EQ(reopened.getNumPages(), 4);
+  reopened.setCompression(false);
+  EXPECT_FALSE(reopened.isCompressed());
+  EXPECT_EQ(reopened.getStoredSize(), 4 * db::DEFAULT_PAGE_SIZE);
+  i = 0;
+  for (const auto &t : reopened) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+    i++;
+  }
+  EXPECT_EQ(i, capacity * 3 + 1);
+}
+
+TEST(HeapFileTest, CompressBlock) {
+  std::vector<uint8_t> block(db::DEFAULT_PAGE_SIZE);
+  for (size_t i = 0; i < block.size(); ++i) {
+    block[i] = i % 100 < 50 ? static_cast<uint8_t>(i * 7919 >> 3) : 0;
+  }
+  std::vector<uint8_t> compressed(block.size());
+  size_t size = db::compress(block.data(), block.size(), compressed.data(), compressed.size());
+  ASSERT_GT(size, 0);
+  EXPECT_LT(size, block.size());
+  std::vector<uint8_t> decompressed(block.size());
+  db::decompress(compressed.data(), size, decompressed.data(), decompressed.size());
+  EXPECT_EQ(decompressed, block);
+
+  // A block that does not fit the buffer is reported, and a truncated block is rejected
+  EXPECT_EQ(db::compress(block.data(), block.size(), compressed.data(), 16), 0);
+  EXPECT_THROW(db::decompress(compressed.data(), size - 1, decompressed.data(), decompressed.size()),
+               std::runtime_error);
+}
+
+TEST(HeapFileTest, Extents) {
+  std::vector<db::type_t> types{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE};
+  std::vector<std::string> names{"id", "name", "price"};
+  db::TupleDesc td(types, names);
+
+  const char *name = "heapfile";
+  std::remove(name);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  auto &file = db::getDatabase().get(name);
+  EXPECT_EQ(file.getExtentSize(), db::DEFAULT_EXTENT_SIZE);
+  EXPECT_THROW(file.setExtentSize(db::DEFAULT_PAGE_SIZE + 1), std::logic_error);
+  constexpr size_t capacity = ROW_CAPACITY;
+  for (int i = 0; i < capacity * 3; ++i) {
+    file.insertTuple({{i, "Hello", 3.14}});
+  }
+  db::getDatabase().getBufferPool().flushFile(name);
+
+  // The first extent is allocated when the file grows, without changing its size
+  EXPECT_EQ(file.getNumPages(), 3);
+  EXPECT_EQ(file.getStoredSize(), 3 * db::DEFAULT_PAGE_SIZE);
+  if (file.getAllocatedSize() < db::DEFAULT_EXTENT_SIZE) {
+    GTEST_SKIP() << "The file system does not allocate space ahead";
+  }
+  auto removed = db::getDatabase().remove(name);
+  removed.reset();
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  auto &reopened = db::getDatabase().get(name);
+  EXPECT_EQ(reopened.getNumPages(), 3);
+  int i = 0;
+  for (const auto &t : reopened) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+    i++;
+  }
+  EXPECT_EQ(i, capacity * 3);
+}
+
+TEST(HeapFileTest, FreeSpaceMap) {
+  std::vector<db::type_t> types{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE};
+  std::vector<std::string> names{"id", "name", "price"};
+  db::TupleDesc td(types, names);
+
+  const char *name = "heapfile";
+  std::remove(name);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  auto *file = &db::getDatabase().get(name);
+  constexpr size_t capacity = ROW_CAPACITY;
+  for (int i = 0; i < capacity * 3; ++i) {
+    file->insertTuple({{i, "Hello", 3.14}});
+  }
+
+  // Inserts reuse the slots freed on the first pages instead of growing the file
+  auto it = file->begin();
+  for (int i = 0; i < capacity * 3; i += 3) {
+    it.page = i / capacity;
+    it.slot = i % capacity;
+    file->deleteTuple(it);
+  }
+  for (int i = 0; i < capacity; ++i) {
+    file->insertTuple({{-1, "Hello", 3.14}});
+  }
+  EXPECT_EQ(file->getNumPages(), 3);
+  file->insertTuple({{-1, "Hello", 3.14}});
+  EXPECT_EQ(file->getNumPages(), 4);
+
+  // Changes to the map are written to the map file when the file is synced
+  auto stored = [&] {
+    std::ifstream in(std::string(name) + ".fsm", std::ios::binary);
+    uint64_t word = 0;
+    in.read(reinterpret_cast<char *>(&word), sizeof(word));
+    return word;
+  };
+  file->sync();
+  EXPECT_EQ(stored(), 0b1000);
+  it.page = 1;
+  it.slot = 4;
+  file->deleteTuple(it);
+  EXPECT_EQ(stored(), 0b1000);
+  file->sync();
+  EXPECT_EQ(stored(), 0b1010);
+  file->insertTuple({{-1, "Hello", 3.14}});
+
+  // The map is kept with the file, and rebuilt from the pages when it is missing
+  for (bool rebuild : {false, true}) {
+    it.page = 1;
+    it.slot = 7;
+    file->deleteTuple(it);
+    auto removed = db::getDatabase().remove(name);
+    removed.reset();
+    if (rebuild) {
+      std::remove((std::string(name) + ".fsm").c_str());
+    }
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+    file = &db::getDatabase().get(name);
+    file->insertTuple({{-2, "Hello", 3.14}});
+    it.page = 1;
+    it.slot = 7;
+    EXPECT_EQ(std::get<int>(file->getTuple(it).get_field(0)), -2);
+  }
+
+  // A map that cannot be created, here because its name points into a missing directory, is kept in memory
+  db::getDatabase().remove(name).reset();
+  std::string fsm_name = std::string(name) + ".fsm";
+  std::remove(fsm_name.c_str());
+  std::filesystem::create_symlink("missing/heapfile.fsm", fsm_name);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  file = &db::getDatabase().get(name);
+  it.page = 1;
+  it.slot = 7;
+  file->deleteTuple(it);
+  file->insertTuple({{-3, "Hello", 3.14}});
+  EXPECT_EQ(std::get<int>(file->getTuple(it).get_field(0)), -3);
+  EXPECT_FALSE(std::filesystem::exists(fsm_name));
+  std::remove(fsm_name.c_str());
+  size_t count = 0;
+  for (const auto &t : *file) {
+    count++;
+  }
+  EXPECT_EQ(count, capacity * 3 + 1);
+}
+
+TEST(HeapFileTest, BulkInsert) {
+  std::vector<db::type_t> types{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE};
+  std::vector<std::string> names{"id", "name", "price"};
+  db::TupleDesc td(types, names);
+
+  const char *name = "heapfile";
+  std::remove(name);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+  auto &bufferPool = db::getDatabase().getBufferPool();
+  constexpr size_t capacity = ROW_CAPACITY;
+  for (int i = 0; i < 10; ++i) {
+    file.insertTuple({{i, "Hello", 3.14}});
+  }
+
+  std::vector<db::Tuple> tuples;
+  for (int i = 10; i < capacity * 4 + 20; ++i) {
+    tuples.push_back({{i, "Hello", 3.14}});
+  }
+  std::vector<db::Tuple> incompatible{{{0, "Hello", 3.14}}, {{0, 1, 2}}};
+  EXPECT_THROW(file.bulkInsert(incompatible), std::runtime_error);
+
+  // The last page is filled first, then whole pages bypass the pool and only the partial page at the end is cached
+  file.bulkInsert(tuples);
+  EXPECT_EQ(file.getNumPages(), 5);
+  EXPECT_TRUE(bufferPool.contains({name, 0}));
+  EXPECT_FALSE(bufferPool.contains({name, 1}));
+  EXPECT_FALSE(bufferPool.contains({name, 3}));
+  EXPECT_TRUE(bufferPool.contains({name, 4}));
+  int i = 0;
+  for (const auto &t : file) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+    i++;
+  }
+  EXPECT_EQ(i, capacity * 4 + 20);
+
+  // The partial page takes the next insert
+  file.insertTuple({{i, "Hello", 3.14}});
+  EXPECT_EQ(file.getNumPages(), 5);
+}
+
+TEST(HeapFileTest, BulkInsertScan) {
+  std::vector<db::type_t> types{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE};
+  std::vector<std::string> names{"id", "name", "price"};
+  db::TupleDesc td(types, names);
+
+  const char *name = "heapfile";
+  std::remove(name);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+  auto &bufferPool = db::getDatabase().getBufferPool();
+  constexpr size_t capacity = ROW_CAPACITY;
+  constexpr size_t rounds = 8;
+  std::vector<db::Tuple> tuples;
+  for (int i = 0; i < capacity * (db::BULK_LOAD_PAGES - 1) + capacity / 2; ++i) {
+    tuples.push_back({{i, "Hello", 3.14}});
+  }
+
+  // A scan that runs during a load never caches a loaded page before it is written; the file stays smaller than the
+  // pool, so a page cached too early would never be read again
+  bufferPool.resize(rounds * db::BULK_LOAD_PAGES + 1);
+  std::atomic<bool> done = false;
+  std::thread scanner([&] {
+    while (!done) {
+      file.scan([](const db::TupleView &) {});
+    }
+  });
+  size_t loaded = 0;
+  for (int round = 0; round < rounds; ++round) {
+    file.bulkInsert(tuples);
+    loaded += tuples.size();
+    size_t count = 0;
+    file.scan([&](const db::TupleView &) { count++; });
+    EXPECT_EQ(count, loaded);
+  }
+  done = true;
+  scanner.join();
+  EXPECT_LT(file.getNumPages(), bufferPool.size());
+}
+
+TEST(HeapFileTest, Compact) {
+  std::vector<db::type_t> types{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE};
+  std::vector<std::string> names{"id", "name", "price"};
+  db::TupleDesc td(types, names);
+
+  const char *name = "heapfile";
+  std::remove(name);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+  constexpr size_t capacity = ROW_CAPACITY;
+  for (int i = 0; i < capacity * 5; ++i) {
+    file.insertTuple({{i, "Hello", 3.14}});
+  }
+  for (auto it = file.begin(); it != file.end(); file.next(it)) {
+    if (std::get<int>(file.getTuple(it).get_field(0)) % 3 != 0) {
+      file.deleteTuple(it);
+    }
+  }
+
+  // One step moves the last page into the free slots of the first ones, the next steps go as far as they can
+  EXPECT_EQ(file.compact(1), 1);
+  EXPECT_EQ(file.getNumPages(), 4);
+  EXPECT_EQ(file.compact(), 2);
+  EXPECT_EQ(file.getNumPages(), 2);
+  EXPECT_EQ(file.compact(), 0);
+  auto &bufferPool = db::getDatabase().getBufferPool();
+  bufferPool.flushFile(name);
+  EXPECT_EQ(file.getStoredSize(), 2 * db::DEFAULT_PAGE_SIZE);
+
+  // A step that moves nothing leaves the last page clean
+  EXPECT_EQ(file.compact(), 0);
+  EXPECT_FALSE(bufferPool.isDirty({name, 1}));
+
+  std::vector<int> ids;
+  for (const auto &t : file) {
+    ids.push_back(std::get<int>(t.get_field(0)));
+  }
+  std::sort(ids.begin(), ids.end());
+  ASSERT_EQ(ids.size(), (capacity * 5 + 2) / 3);
+  for (int i = 0; i < ids.size(); ++i) {
+    EXPECT_EQ(ids[i], i * 3);
+  }
+
+  // A full page the map lists by mistake is taken off it, and not written back
+  db::getDatabase().remove(name).reset();
+  {
+    std::ofstream out(std::string(name) + ".fsm", std::ios::binary | std::ios::trunc);
+    uint64_t word = 0b11;
+    out.write(reinterpret_cast<const char *>(&word), sizeof(word));
+  }
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  auto &reopened = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+  EXPECT_EQ(reopened.compact(), 0);
+  EXPECT_FALSE(bufferPool.isDirty({name, 0}));
+}
+
+TEST(HeapFileTest, Varchar) {
+  db::TupleDesc td({db::type_t::INT, db::type_t::VARCHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+
+  const char *name = "heapfile";
+  std::remove(name);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+  auto label = [](int i) { return "item " + std::to_string(i) + std::string(i % 100, '.'); };
+  constexpr int count = 2000;
+  for (int i = 0; i < count / 2; ++i) {
+    file.insertTuple({{i, label(i), 3.14}});
+  }
+  std::vector<db::Tuple> tuples;
+  for (int i = count / 2; i < count; ++i) {
+    tuples.push_back({{i, label(i), 3.14}});
+  }
+  file.bulkInsert(tuples);
+  EXPECT_THROW(file.insertTuple({{0, std::string(db::DEFAULT_PAGE_SIZE, 'x'), 3.14}}), std::runtime_error);
+
+  // Strings longer than a CHAR are kept whole
+  int i = 0;
+  for (const auto &t : file) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+    EXPECT_EQ(std::get<std::string>(t.get_field(1)), label(i));
+    i++;
+  }
+  EXPECT_EQ(i, count);
+
+  // Short records are deleted and their space is packed for a long one on the same page
+  size_t pages = file.getNumPages();
+  auto it = file.begin();
+  for (int j = 0; j < 10; j++, file.next(it)) {
+    file.deleteTuple(it);
+  }
+  file.insertTuple({{-1, std::string(200, 'x'), 3.14}});
+  EXPECT_EQ(file.getNumPages(), pages);
+  auto first = file.begin();
+  EXPECT_EQ(first.page, 0);
+  EXPECT_EQ(std::get<int>(file.getTuple(first).get_field(0)), -1);
+}
+
+TEST(HeapFileTest, Scan) {
+  std::vector<db::type_t> types{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE};
+  std::vector<std::string> names{"id", "name", "price"};
+  db::TupleDesc td(types, names);
+
+  const char *name = "heapfile";
+  std::remove(name);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td));
+  auto &file = db::getDatabase().get(name);
+  auto &bufferPool = db::getDatabase().getBufferPool();
+  constexpr size_t capacity = ROW_CAPACITY;
+  for (int i = 0; i < capacity * 3; ++i) {
+    file.insertTuple({{i, "Hello", 3.14}});
+  }
+  auto it = file.begin();
+  for (int i = 0; i < capacity * 3; i += 2) {
+    it.page = i / capacity;
+    it.slot = i % capacity;
+    file.deleteTuple(it);
+  }
+
+  // A scan pins each page once and reads the tuples in place
+  bufferPool.resetStats();
+  int i = 1;
+  file.scan([&](const db::TupleView &t) {
+    EXPECT_EQ(t.get_int(0), i);
+    EXPECT_EQ(t.get_string(1), "Hello");
+    i += 2;
+  });
+  EXPECT_EQ(i, capacity * 3 / 2 * 2 + 1);
+  EXPECT_EQ(bufferPool.getHits() + bufferPool.getMisses(), file.getNumPages());
+
+  // A file that does not fetch rows scans the file for the selected rows
+  EXPECT_FALSE(file.supportsRowFetch());
+  std::vector<size_t> selected{0, 5, capacity};
+  std::vector<int> ids;
+  file.scanColumns({0}, selected, [&](const db::TupleView &t) { ids.push_back(t.get_int(0)); });
+  EXPECT_EQ(ids, (std::vector<int>{1, 11, static_cast<int>(capacity) * 2 + 1}));
+  EXPECT_THROW(file.scanColumns({0}, std::vector<size_t>{capacity * 3}, [](const db::TupleView &) {}),
+               std::runtime_error);
+
+  // An iterator gives a view that lasts as long as its guard
+  db::PageGuard page;
+  auto first = file.begin();
+  db::TupleView view = first.view(page);
+  EXPECT_TRUE(page);
+  EXPECT_EQ(view.get_int(0), 1);
+  EXPECT_EQ(std::get<int>(view.materialize().get_field(0)), 1);
+}
+
+TEST(HeapFileTest, Pax) {
+  std::vector<db::type_t> types{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE};
+  std::vector<std::string> names{"id", "name", "price"};
+  db::TupleDesc td(types, names);
+
+  const char *name = "heapfile";
+  std::remove(name);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td, db::PageLayout::PAX));
+  auto &file = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+  EXPECT_EQ(file.getLayout(), db::PageLayout::PAX);
+  constexpr size_t capacity = ROW_CAPACITY / 2 * 2;
+  for (int i = 0; i < capacity; ++i) {
+    file.insertTuple({{i, "Hello", 3.14}});
+  }
+  std::vector<db::Tuple> tuples;
+  for (int i = capacity; i < capacity * 3; ++i) {
+    tuples.push_back({{i, "Hello", 3.14}});
+  }
+  file.bulkInsert(tuples);
+  EXPECT_EQ(file.getNumPages(), 3);
+  auto it = file.begin();
+  for (int i = 0; i < capacity * 3; i += 2) {
+    it.page = i / capacity;
+    it.slot = i % capacity;
+    file.deleteTuple(it);
+  }
+
+  // The file reads like a row file through the iterators and the scan
+  int i = 1;
+  for (const auto &t : file) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+    EXPECT_EQ(std::get<std::string>(t.get_field(1)), "Hello");
+    i += 2;
+  }
+  EXPECT_EQ(i, capacity * 3 + 1);
+  i = 1;
+  file.scan([&](const db::TupleView &t) {
+    EXPECT_EQ(t.get_int(0), i);
+    EXPECT_EQ(t.get_double(2), 3.14);
+    i += 2;
+  });
+  EXPECT_EQ(i, capacity * 3 + 1);
+
+  // An operator reads a column of each page and skips the free slots
+  size_t sum = 0;
+  file.scanPages([&](const db::HeapPage &page) {
+    std::span<const int> ids = page.column<int>(0);
+    for (size_t slot = 0; slot < ids.size(); slot++) {
+      if (!page.empty(slot)) {
+        sum += ids[slot];
+      }
+    }
+  });
+  EXPECT_EQ(sum, (capacity * 3 / 2) * (capacity * 3 / 2));
+
+  // Freed slots are refilled
+  file.insertTuple({{-1, "Hello", 3.14}});
+  EXPECT_EQ(std::get<int>(file.getTuple(file.begin()).get_field(0)), -1);
+  EXPECT_EQ(file.getNumPages(), 3);
+
+  // The layout is recorded with the file, and kept when the file is compressed
+  file.setCompression(true);
+  db::getDatabase().remove(name).reset();
+  EXPECT_THROW(db::HeapFile(name, td), std::runtime_error);
+  db::getDatabase().add(std::make_unique<db::HeapFile>(name, td, db::PageLayout::PAX));
+  auto &reopened = dynamic_cast<db::HeapFile &>(db::getDatabase().get(name));
+  EXPECT_EQ(std::get<int>(reopened.getTuple(reopened.begin()).get_field(0)), -1);
+
+  db::TupleDesc varchar({db::type_t::INT, db::type_t::VARCHAR}, {"id", "name"});
+  EXPECT_THROW(db::HeapFile("heapfile_varchar", varchar, db::PageLayout::PAX), std::logic_error);
+  std::remove("heapfile_varchar");
+  std::remove("heapfile_varchar.fsm");
+}
+
+TEST(HeapFileTest, PageSizes) {
+  std::vector<db::type_t> types{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE};
+  std::vector<std::string> names{"id", "name", "price"};
+  db::TupleDesc td(types, names);
+  EXPECT_THROW(db::HeapFile("heapfile", td, db::PageLayout::ROW, db::MIN_PAGE_SIZE * 3), std::logic_error);
+
+  // Files of every page size share the pool, and each stores its pages at its own size
+  std::vector<size_t> sizes;
+  for (size_t size = db::MIN_PAGE_SIZE; size <= db::MAX_PAGE_SIZE; size *= 2) {
+    sizes.push_back(size);
+  }
+  auto name_of = [](size_t size) { return "heapfile_" + std::to_string(size); };
+  for (size_t size : sizes) {
+    std::remove(name_of(size).c_str());
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name_of(size), td, db::PageLayout::ROW, size));
+  }
+  constexpr int count = 1000;
+  for (int i = 0; i < count; ++i) {
+    for (size_t size : sizes) {
+      db::getDatabase().get(name_of(size)).insertTuple({{i, "Hello", 3.14}});
+    }
+  }
+  db::getDatabase().getBufferPool().flushAll();
+  for (size_t size : sizes) {
+    auto &file = db::getDatabase().get(name_of(size));
+    size_t capacity = size * 8 / (td.length() * 8 + 1);
+    EXPECT_EQ(file.getPageSize(), size);
+    EXPECT_EQ(file.getNumPages(), (count + capacity - 1) / capacity);
+    EXPECT_EQ(file.getStoredSize(), file.getNumPages() * size);
+  }
+
+  // A file opened again keeps the page size it was created with
+  for (size_t size : sizes) {
+    db::getDatabase().remove(name_of(size)).reset();
+    db::getDatabase().add(std::make_unique<db::HeapFile>(name_of(size), td));
+    auto &file = db::getDatabase().get(name_of(size));
+    EXPECT_EQ(file.getPageSize(), size);
+    int i = 0;
+    file.scan([&](const db::TupleView &t) {
+      EXPECT_EQ(t.get_int(0), i);
+      i++;
+    });
+    EXPECT_EQ(i, count);
+    db::getDatabase().remove(name_of(size)).reset();
+    std::remove(name_of(size).c_str());
+    std::remove((name_of(size) + ".fsm").c_str());
+  }
+}
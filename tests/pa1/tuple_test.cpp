@@ -1,3 +1,4 @@
+#include <db/Schema.hpp>
 #include <db/Tuple.hpp>
 #include <gtest/gtest.h>
 
@@ -105,3 +106,92 @@ TEST(TupleTest, MergeConflict) {
 
   EXPECT_ANY_THROW(db::TupleDesc::merge(td1, td2));  // Non-unique names
 }
+
+TEST(TupleTest, Varchar) {
+  std::vector<db::type_t> types{db::type_t::INT, db::type_t::VARCHAR, db::type_t::DOUBLE, db::type_t::VARCHAR};
+  std::vector<std::string> names{"id", "name", "price", "note"};
+  db::TupleDesc td(types, names);
+
+  // The fixed-size fields come first, the bytes of the strings follow them
+  EXPECT_FALSE(td.fixed());
+  EXPECT_EQ(td.offset_of(2), db::INT_SIZE + db::VARCHAR_SIZE);
+  EXPECT_EQ(td.length(), db::INT_SIZE + 2 * db::VARCHAR_SIZE + db::DOUBLE_SIZE);
+  std::string long_note(200, 'x');
+  db::Tuple t({7, "Hello", 3.14, long_note});
+  EXPECT_TRUE(td.compatible(t));
+  EXPECT_FALSE(td.compatible(db::Tuple({7, 1, 3.14, ""})));
+  EXPECT_FALSE(td.compatible(db::Tuple({7, std::string(70000, 'x'), 3.14, ""})));
+  ASSERT_EQ(td.length(t), td.length() + 5 + long_note.size());
+
+  std::vector<uint8_t> data(td.length(t));
+  td.serialize(data.data(), t);
+  db::Tuple copy = td.deserialize(data.data());
+  EXPECT_EQ(std::get<int>(copy.get_field(0)), 7);
+  EXPECT_EQ(std::get<std::string>(copy.get_field(1)), "Hello");
+  EXPECT_EQ(std::get<double>(copy.get_field(2)), 3.14);
+  EXPECT_EQ(std::get<std::string>(copy.get_field(3)), long_note);
+}
+
+TEST(TupleTest, View) {
+  std::vector<db::type_t> types{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE, db::type_t::VARCHAR};
+  std::vector<std::string> names{"id", "name", "price", "note"};
+  db::TupleDesc td(types, names);
+  db::Tuple t({7, "Hello", 3.14, "a longer note"});
+  std::vector<uint8_t> data(td.length(t));
+  td.serialize(data.data(), t);
+
+  // The fields are read from the bytes, and strings point into them
+  db::TupleView view(td, data.data());
+  EXPECT_EQ(view.size(), 4);
+  EXPECT_EQ(view.get_int(0), 7);
+  EXPECT_EQ(view.get_string(1), "Hello");
+  EXPECT_EQ(view.get_double(2), 3.14);
+  EXPECT_EQ(view.get_string(3), "a longer note");
+  EXPECT_EQ(view.get_string(3).data(), reinterpret_cast<const char *>(data.data() + td.length()));
+  EXPECT_EQ(view.field_type(3), db::type_t::VARCHAR);
+  EXPECT_EQ(view.get_field(1), db::field_t{"Hello"});
+  EXPECT_THROW(view.get_int(1), std::logic_error);
+  EXPECT_THROW(view.get_string(0), std::logic_error);
+  EXPECT_ANY_THROW(view.get_int(4));
+
+  db::Tuple copy = view.materialize();
+  for (size_t i = 0; i < t.size(); i++) {
+    EXPECT_EQ(copy.get_field(i), t.get_field(i));
+  }
+}
+
+TEST(TupleTest, Schema) {
+  using Item = db::Schema<db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE, db::type_t::VARCHAR>;
+  static_assert(Item::size() == 4);
+  static_assert(Item::offset_of(2) == db::INT_SIZE + db::CHAR_SIZE);
+  static_assert(Item::length() == db::INT_SIZE + db::CHAR_SIZE + db::DOUBLE_SIZE + db::VARCHAR_SIZE);
+  static_assert(!Item::fixed());
+  static_assert(db::Schema<db::type_t::INT, db::type_t::DOUBLE>::fixed());
+  db::TupleDesc td = Item::desc({"id", "name", "price", "note"});
+  EXPECT_EQ(td.length(), Item::length());
+  for (size_t i = 0; i < Item::size(); i++) {
+    EXPECT_EQ(td.offset_of(i), Item::offset_of(i));
+  }
+
+  // The records are the same as those of the TupleDesc, either way
+  db::Tuple t({7, "Hello", 3.14, "a note"});
+  ASSERT_EQ(Item::length(t), td.length(t));
+  std::vector<uint8_t> fixed(td.length(t), 0xff);
+  std::vector<uint8_t> dynamic(td.length(t), 0xff);
+  Item::serialize(fixed.data(), t);
+  td.serialize(dynamic.data(), t);
+  EXPECT_EQ(fixed, dynamic);
+  EXPECT_EQ(Item::get<0>(fixed.data()), 7);
+  EXPECT_EQ(Item::get<1>(fixed.data()), "Hello");
+  EXPECT_EQ(Item::get<2>(fixed.data()), 3.14);
+  EXPECT_EQ(Item::get<3>(fixed.data()), "a note");
+  db::Tuple copy = Item::deserialize(dynamic.data());
+  for (size_t i = 0; i < t.size(); i++) {
+    EXPECT_EQ(copy.get_field(i), t.get_field(i));
+  }
+
+  // A CHAR is cut to its size, and read back without a terminating zero
+  std::string long_name(db::CHAR_SIZE + 10, 'x');
+  td.serialize(dynamic.data(), {{7, long_name, 3.14, ""}});
+  EXPECT_EQ(std::get<std::string>(td.deserialize(dynamic.data()).get_field(1)), long_name.substr(0, db::CHAR_SIZE));
+}
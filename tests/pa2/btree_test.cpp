@@ -51,3 +51,49 @@ TEST(BTreeTest, Random) {
   }
   EXPECT_EQ(i, 1000000);
 }
+
+TEST(BTreeTest, ReadAhead) {
+  const char *name = "test.db";
+  std::remove(name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+  auto &file = db::getDatabase().get(name);
+  constexpr int size = 100000;
+  for (int i = 0; i < size; i++) {
+    int k = i % 2 ? size - i : i;
+    db::Tuple t{{k, "apple", 1.0}};
+    file.insertTuple(t);
+  }
+  db::BufferPool &bufferPool = db::getDatabase().getBufferPool();
+  bufferPool.setReadAhead(16);
+  bufferPool.resetStats();
+  int i = 0;
+  for (const auto &t : file) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+    i++;
+  }
+  EXPECT_EQ(i, size);
+  bufferPool.setReadAhead(0);
+  EXPECT_GT(bufferPool.getPrefetches(), 0);
+}
+
+TEST(BTreeTest, Varchar) {
+  const char *name = "test.db";
+  std::remove(name);
+  db::TupleDesc td({db::type_t::INT, db::type_t::VARCHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::getDatabase().add(std::make_unique<db::BTreeFile>(name, td, 0));
+  auto &file = db::getDatabase().get(name);
+  auto label = [](int i) { return std::to_string(i) + std::string(i % 200, '.'); };
+  constexpr int count = 100000;
+  for (int i = 0; i < count; i++) {
+    int id = static_cast<int>((i * 7919LL) % count);
+    file.insertTuple({{id, label(id), 1.0}});
+  }
+  int i = 0;
+  for (const auto &t : file) {
+    EXPECT_EQ(std::get<int>(t.get_field(0)), i);
+    EXPECT_EQ(std::get<std::string>(t.get_field(1)), label(i));
+    i++;
+  }
+  EXPECT_EQ(i, count);
+}
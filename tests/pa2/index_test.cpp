@@ -1,12 +1,28 @@
 #include <db/IndexPage.hpp>
 #include <gtest/gtest.h>
 
+// The keys of an index page of each size: one more key and child fit before the split, and the children are aligned
+static int capacityOf(size_t page_size) {
+  switch (page_size) {
+  case 4096:
+    return 340;
+  case 8192:
+    return 680;
+  case 16384:
+    return 1364;
+  case 32768:
+    return 2728;
+  default:
+    return 5460;
+  }
+}
+
 TEST(IndexTest, InsertFirst) {
   db::Page page{};
   db::IndexPage index{page};
   int capacity = index.capacity;
   EXPECT_EQ(sizeof(size_t), 8);
-  EXPECT_EQ(capacity, 340);
+  EXPECT_EQ(capacity, capacityOf(db::DEFAULT_PAGE_SIZE));
 
   for (int i = 1; i < capacity; i++) {
     EXPECT_FALSE(index.insert(i * 2, 1000 + i));
@@ -22,7 +38,7 @@ TEST(IndexTest, InsertLast) {
   db::Page page{};
   db::IndexPage index{page};
   int capacity = index.capacity;
-  EXPECT_EQ(capacity, 340);
+  EXPECT_EQ(capacity, capacityOf(db::DEFAULT_PAGE_SIZE));
 
   for (int i = 1; i < capacity; i++) {
     EXPECT_FALSE(index.insert(i * 2, 1000 + i));
@@ -38,7 +54,7 @@ TEST(IndexTest, InsertMiddle) {
   db::Page page{};
   db::IndexPage index{page};
   int capacity = index.capacity;
-  EXPECT_EQ(capacity, 340);
+  EXPECT_EQ(capacity, capacityOf(db::DEFAULT_PAGE_SIZE));
 
   std::vector<int> ids;
   for (int i = 1; i < capacity; i++) {
@@ -58,7 +74,7 @@ TEST(IndexTest, Split) {
   db::Page page{};
   db::IndexPage index{page};
   int capacity = index.capacity;
-  EXPECT_EQ(capacity, 340);
+  EXPECT_EQ(capacity, capacityOf(db::DEFAULT_PAGE_SIZE));
 
   for (int i = 0; i < capacity - 1; i++) {
     db::Tuple t{{i * 2, "apple", 1.0}};
@@ -78,3 +94,17 @@ TEST(IndexTest, Split) {
     EXPECT_EQ(new_index.keys[i], (i + 1 + index.header->size) * 2);
   }
 }
+
+TEST(IndexTest, Layout) {
+  // The keys and the children of a full page (and of the key inserted before the split) fit in a page of each size
+  for (size_t size = db::MIN_PAGE_SIZE; size <= db::MAX_PAGE_SIZE; size *= 2) {
+    db::Page page{};
+    db::IndexPage index{page, size};
+    EXPECT_EQ(index.capacity, capacityOf(size));
+    auto *end = reinterpret_cast<uint8_t *>(index.children + index.capacity + 1);
+    EXPECT_LE(end, page.data() + size);
+    EXPECT_LE(reinterpret_cast<uint8_t *>(index.keys + index.capacity + 1),
+              reinterpret_cast<uint8_t *>(index.children));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(index.children) % alignof(size_t), 0);
+  }
+}
@@ -1,12 +1,17 @@
 #include <db/LeafPage.hpp>
+#include <algorithm>
 #include <gtest/gtest.h>
 
+// The tuples of a leaf of the size of new files, for an INT, a CHAR and a DOUBLE: 53 in a page of 4 KB
+constexpr int LEAF_CAPACITY = (db::DEFAULT_PAGE_SIZE - sizeof(db::LeafPageHeader)) / (db::INT_SIZE + db::CHAR_SIZE +
+                                                                                       db::DOUBLE_SIZE);
+
 TEST(LeafTest, InsertFirst) {
   db::Page page{};
   db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
   db::LeafPage leaf{page, td, 0};
   int capacity = leaf.capacity;
-  EXPECT_EQ(capacity, 53);
+  EXPECT_EQ(capacity, LEAF_CAPACITY);
   std::vector<int> ids;
   ids.push_back(0);
   for (int i = 1; i < capacity; i++) {
@@ -28,7 +33,7 @@ TEST(LeafTest, InsertLast) {
   db::TupleDesc td({db::type_t::CHAR, db::type_t::INT, db::type_t::DOUBLE}, {"name", "id", "price"});
   db::LeafPage leaf{page, td, 1};
   int capacity = leaf.capacity;
-  EXPECT_EQ(capacity, 53);
+  EXPECT_EQ(capacity, LEAF_CAPACITY);
   std::vector<int> ids;
   for (int i = 1; i < capacity; i++) {
     ids.push_back(i * 2);
@@ -50,7 +55,7 @@ TEST(LeafTest, InsertMiddle) {
   db::TupleDesc td({db::type_t::CHAR, db::type_t::DOUBLE, db::type_t::INT}, {"name", "price", "id"});
   db::LeafPage leaf{page, td, 2};
   int capacity = leaf.capacity;
-  EXPECT_EQ(capacity, 53);
+  EXPECT_EQ(capacity, LEAF_CAPACITY);
   std::vector<int> ids;
   for (int i = 1; i < capacity; i++) {
     ids.push_back(i * 2);
@@ -73,7 +78,7 @@ TEST(LeafTest, Update) {
   db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
   db::LeafPage leaf{page, td, 0};
   int capacity = leaf.capacity;
-  EXPECT_EQ(capacity, 53);
+  EXPECT_EQ(capacity, LEAF_CAPACITY);
   std::vector<int> ids;
   for (int i = 1; i < capacity; i++) {
     ids.push_back(i * 2);
@@ -109,7 +114,7 @@ TEST(LeafTest, Split) {
   const size_t rand_leaf = rand();
   leaf.header->next_leaf = rand_leaf;
   int capacity = leaf.capacity;
-  EXPECT_EQ(capacity, 53);
+  EXPECT_EQ(capacity, LEAF_CAPACITY);
   for (int i = 0; i < capacity - 1; i++) {
     db::Tuple t{{i * 2, "apple", 1.0}};
     EXPECT_FALSE(leaf.insertTuple(t));
@@ -131,3 +136,65 @@ TEST(LeafTest, Split) {
     EXPECT_EQ(t.get_field(0), db::field_t{(leaf.header->size + i) * 2});
   }
 }
+
+TEST(LeafTest, Varchar) {
+  db::Page page{};
+  db::Page new_page{};
+  db::TupleDesc td({db::type_t::VARCHAR, db::type_t::INT}, {"name", "id"});
+  db::LeafPage leaf{page, td, 1};
+  auto label = [](int i) { return std::string(i % 50, 'a' + i % 26); };
+
+  // Keys come in any order, a key that exists is replaced, and the leaf fills up by size
+  std::vector<int> ids;
+  for (int i = 0;; i++) {
+    int id = (i * 37) % 10007;
+    ids.push_back(id);
+    if (leaf.insertTuple({{label(id), id}})) {
+      break;
+    }
+    if (i == 10) {
+      EXPECT_FALSE(leaf.insertTuple({{std::string("replaced"), 0}}));
+    }
+  }
+  EXPECT_GT(ids.size(), db::DEFAULT_PAGE_SIZE / (db::CHAR_SIZE + db::INT_SIZE));
+  std::string largest(db::maxLeafRecordSize() - td.length(), 'x');
+  EXPECT_ANY_THROW(leaf.insertTuple({{largest + "x", 0}}));
+  std::sort(ids.begin(), ids.end());
+  ASSERT_EQ(leaf.header->size, ids.size());
+  for (size_t slot = 0; slot < ids.size(); slot++) {
+    db::Tuple t = leaf.getTuple(slot);
+    EXPECT_EQ(std::get<int>(t.get_field(1)), ids[slot]);
+    EXPECT_EQ(std::get<std::string>(t.get_field(0)), ids[slot] == 0 ? "replaced" : label(ids[slot]));
+  }
+
+  // Both halves of a split have room for a record of the largest size
+  db::LeafPage new_leaf{new_page, td, 1};
+  int key = leaf.split(new_leaf);
+  EXPECT_EQ(leaf.header->size + new_leaf.header->size, ids.size());
+  EXPECT_EQ(key, ids[leaf.header->size]);
+  leaf.insertTuple({{largest, -1}});
+  new_leaf.insertTuple({{largest, 10007}});
+  EXPECT_EQ(std::get<std::string>(leaf.getTuple(0).get_field(0)), largest);
+  EXPECT_EQ(std::get<std::string>(new_leaf.getTuple(new_leaf.header->size - 1).get_field(0)), largest);
+  EXPECT_EQ(std::get<int>(leaf.getTuple(1).get_field(1)), ids[0]);
+  EXPECT_EQ(std::get<std::string>(new_leaf.getTuple(0).get_field(0)), label(key));
+}
+
+TEST(LeafTest, PageSizes) {
+  db::TupleDesc td({db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE}, {"id", "name", "price"});
+  db::TupleDesc varchar({db::type_t::VARCHAR, db::type_t::INT}, {"name", "id"});
+  // A leaf fills the page size of its file, and the largest record grows with it
+  for (size_t size = db::MIN_PAGE_SIZE; size <= db::MAX_PAGE_SIZE; size *= 2) {
+    db::Page page{};
+    db::LeafPage leaf{page, td, 0, size};
+    EXPECT_EQ(leaf.capacity, (size - sizeof(db::LeafPageHeader)) / td.length());
+    EXPECT_EQ(leaf.data + leaf.capacity * td.length(), page.data() + size);
+    db::Page varchar_page{};
+    db::LeafPage varchar_leaf{varchar_page, varchar, 1, size};
+    std::string largest(db::maxLeafRecordSize(size) - varchar.length(), 'x');
+    EXPECT_FALSE(varchar_leaf.insertTuple({{largest, 1}}));
+    EXPECT_ANY_THROW(varchar_leaf.insertTuple({{largest + "x", 2}}));
+    EXPECT_EQ(std::get<std::string>(varchar_leaf.getTuple(0).get_field(0)), largest);
+  }
+  EXPECT_EQ(db::maxLeafRecordSize(db::MIN_PAGE_SIZE), 1016);
+}
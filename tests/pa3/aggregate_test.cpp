@@ -1,3 +1,4 @@
+#include <db/ColumnFile.hpp>
 #include <db/Database.hpp>
 #include <db/HeapFile.hpp>
 #include <db/Query.hpp>
@@ -270,3 +271,45 @@ TEST(AggregateTest, Grouped) {
   ++it;
   EXPECT_EQ(it, out.end());
 }
+
+TEST(AggregateTest, ColumnFile) {
+  std::vector<db::type_t> types1{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE, db::type_t::CHAR};
+  std::vector<std::string> names1{"id", "name", "price", "note"};
+  db::TupleDesc td1(types1, names1);
+
+  std::vector<db::type_t> types2{db::type_t::CHAR, db::type_t::INT};
+  std::vector<std::string> names2{"name", "result"};
+  db::TupleDesc td2(types2, names2);
+
+  const char *in_name = "columnfile.in";
+  const char *out_name = "heapfile.out";
+  std::remove(in_name);
+  std::remove(out_name);
+  db::getDatabase().add(
+      std::make_unique<db::ColumnFile>(in_name, td1,
+                                       std::vector<db::ColumnEncoding>{
+                                           db::ColumnEncoding::PLAIN, db::ColumnEncoding::RUN_LENGTH,
+                                           db::ColumnEncoding::PLAIN, db::ColumnEncoding::PLAIN}));
+  db::getDatabase().add(std::make_unique<db::HeapFile>(out_name, td2));
+  auto &in = dynamic_cast<db::ColumnFile &>(db::getDatabase().get(in_name));
+  auto &out = db::getDatabase().get(out_name);
+
+  int sums[2] = {0, 0};
+  for (int i = 0; i < 1000; ++i) {
+    in.insertTuple({{i, i < 600 ? "low" : "high", 3.14, "note"}});
+    sums[i >= 600] += i;
+  }
+
+  in.resetMetrics();
+  db::aggregate(in, out, {"name", db::AggregateOp::SUM, "id"});
+  // Only the pages of the group and the aggregated field are read
+  db::IoMetrics metrics = in.getMetrics();
+  EXPECT_EQ(metrics.hits + metrics.misses, in.getColumnPages(0) + in.getColumnPages(1));
+
+  int groups = 0;
+  for (const auto &t : out) {
+    EXPECT_EQ(t.get_field(1), db::field_t(sums[std::get<std::string>(t.get_field(0)) == "high"]));
+    ++groups;
+  }
+  EXPECT_EQ(groups, 2);
+}
@@ -1,3 +1,4 @@
+#include <db/ColumnFile.hpp>
 #include <db/Database.hpp>
 #include <db/HeapFile.hpp>
 #include <db/Query.hpp>
@@ -85,3 +86,40 @@ TEST(FilterTest, None) {
 
   EXPECT_EQ(out.begin(), out.end());
 }
+
+TEST(FilterTest, ColumnFile) {
+  std::vector<db::type_t> types{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE};
+  std::vector<std::string> names{"id", "name", "price"};
+  db::TupleDesc td(types, names);
+
+  const char *in_name = "columnfile.in";
+  const char *out_name = "heapfile.out";
+  std::remove(in_name);
+  std::remove(out_name);
+  db::getDatabase().add(
+      std::make_unique<db::ColumnFile>(in_name, td, std::vector<db::ColumnEncoding>{}, db::MIN_PAGE_SIZE));
+  db::getDatabase().add(std::make_unique<db::HeapFile>(out_name, td));
+  auto &in = db::getDatabase().get(in_name);
+  auto &out = db::getDatabase().get(out_name);
+  for (int i = 0; i < 3000; ++i) {
+    in.insertTuple({{i, "Hello", i * 0.5}});
+  }
+
+  in.resetMetrics();
+  db::FilterPredicate pred1{"id", db::PredicateOp::GE, 100};
+  db::FilterPredicate pred2{"id", db::PredicateOp::LT, 200};
+  db::filter(in, out, {pred1, pred2});
+
+  int i = 100;
+  for (const auto &t : out) {
+    EXPECT_EQ(get<int>(t.get_field(0)), i);
+    EXPECT_EQ(get<std::string>(t.get_field(1)), "Hello");
+    EXPECT_EQ(get<double>(t.get_field(2)), i * 0.5);
+    ++i;
+  }
+  EXPECT_EQ(i, 200);
+  // The 3 pages of ids, then the pages of 4 KB that hold the rows: 1 of ids, 3 of names and 1 of prices
+  db::IoMetrics metrics = in.getMetrics();
+  EXPECT_EQ(metrics.hits + metrics.misses, 8);
+  EXPECT_EQ(in.getNumPages(), 57);
+}
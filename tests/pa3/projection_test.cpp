@@ -1,3 +1,4 @@
+#include <db/ColumnFile.hpp>
 #include <db/Database.hpp>
 #include <db/HeapFile.hpp>
 #include <db/Query.hpp>
@@ -191,3 +192,43 @@ TEST(ProjectionTest, Duplicate) {
   EXPECT_EQ(it2, out.end());
   EXPECT_EQ(count, capacity * 3);
 }
+
+TEST(ProjectionTest, ColumnFile) {
+  std::vector<db::type_t> types1{db::type_t::INT, db::type_t::CHAR, db::type_t::DOUBLE};
+  std::vector<std::string> names1{"id", "name", "price"};
+  db::TupleDesc td1(types1, names1);
+
+  std::vector<db::type_t> types2{db::type_t::DOUBLE, db::type_t::INT};
+  std::vector<std::string> names2{"price", "id"};
+  db::TupleDesc td2(types2, names2);
+
+  const char *in_name = "columnfile.in";
+  const char *out_name = "heapfile.out";
+
+  std::remove(in_name);
+  std::remove(out_name);
+  db::getDatabase().add(std::make_unique<db::ColumnFile>(in_name, td1));
+  db::getDatabase().add(std::make_unique<db::HeapFile>(out_name, td2));
+  auto &in = dynamic_cast<db::ColumnFile &>(db::getDatabase().get(in_name));
+  auto &out = db::getDatabase().get(out_name);
+
+  constexpr size_t capacity = 53;
+  for (int i = 0; i < capacity * 3; ++i) {
+    in.insertTuple({{i, "Hello", 3.14}});
+  }
+
+  in.resetMetrics();
+  db::projection(in, out, names2);
+  // Only the pages of the columns that are kept are read
+  db::IoMetrics metrics = in.getMetrics();
+  EXPECT_EQ(metrics.hits + metrics.misses, in.getColumnPages(0) + in.getColumnPages(2));
+  EXPECT_LT(in.getColumnPages(0) + in.getColumnPages(2), in.getNumPages());
+
+  int count = 0;
+  for (const auto &t : out) {
+    EXPECT_EQ(t.get_field(0), db::field_t(3.14));
+    EXPECT_EQ(t.get_field(1), db::field_t(count));
+    ++count;
+  }
+  EXPECT_EQ(count, capacity * 3);
+}